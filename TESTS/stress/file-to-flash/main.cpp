@@ -31,12 +31,19 @@
 
 #include "mbed.h"
 
+#ifndef __STDC_FORMAT_MACROS
+#define __STDC_FORMAT_MACROS
+#endif
+
+#include <inttypes.h>
+
 #include "utest/utest.h"
 #include "unity/unity.h"
 #include "greentea-client/test_env.h"
 
 using namespace utest::v1;
 
+#include "mbed_stress_test_compare.h"
 #include "mbed_stress_test_file.h"
 #include "mbed_stress_test_flash.h"
 
@@ -54,6 +61,24 @@ my_buffer_t buffer1 = { 0 };
 Queue<my_buffer_t, 2> mpool;
 Queue<my_buffer_t, 2> queue;
 
+/* read through one open file session, or reopen the file for every buffer */
+static bool file_session = true;
+
+/* when the flash area gets erased */
+typedef enum {
+    ERASE_ALL,      /* everything before the first write */
+    ERASE_LAZY,     /* each sector as the write cursor reaches it */
+    ERASE_AHEAD,    /* the next buffer's sectors while file_thread fills it */
+} erase_mode_t;
+
+static const char* erase_mode_name(erase_mode_t erase)
+{
+    return (erase == ERASE_ALL) ? "all" : ((erase == ERASE_LAZY) ? "lazy" : "ahead");
+}
+
+/* time spent in file reads by file_thread */
+static Timer file_timer;
+
 void setup(void)
 {
     printf("setup file\r\n");
@@ -64,6 +89,15 @@ void setup(void)
 
 void file_thread(void)
 {
+    mbed_stress_test_file_t session;
+
+    if (file_session)
+    {
+        file_timer.start();
+        mbed_stress_test_file_open(&session, "mbed-stress-test.txt", "r", 0);
+        file_timer.stop();
+    }
+
     size_t index = 0;
     while (index < sizeof(story))
     {
@@ -76,13 +110,22 @@ void file_thread(void)
             TEST_ASSERT_NOT_NULL_MESSAGE(buffer, "failed to get buffer");
             TEST_ASSERT_NOT_NULL_MESSAGE(buffer->ptr, "failed to get buffer");
 
-            size_t read = mbed_stress_test_read_file("mbed-stress-test.txt", index, buffer->ptr, buffer->size_max);
+            file_timer.start();
+
+            size_t read;
+            if (file_session)
+            {
+                read = mbed_stress_test_file_read(&session, buffer->ptr, buffer->size_max);
+            }
+            else
+            {
+                read = mbed_stress_test_read_file("mbed-stress-test.txt", index, buffer->ptr, buffer->size_max);
+            }
+
+            file_timer.stop();
             buffer->size = read;
 
-            TEST_ASSERT_EQUAL_STRING_LEN_MESSAGE(buffer->ptr,
-                                                 &story[index],
-                                                 buffer->size,
-                                                 "character mismatch");
+            mbed_stress_test_assert_equal(&story[index], buffer->ptr, buffer->size, index, "character mismatch");
 
             index += buffer->size;
             printf("download: %u\r\n", index);
@@ -96,11 +139,21 @@ void file_thread(void)
         }
     }
     TEST_ASSERT_EQUAL_UINT_MESSAGE(index, sizeof(story), "wrong length");
+
+    if (file_session)
+    {
+        file_timer.start();
+        mbed_stress_test_file_close(&session);
+        file_timer.stop();
+    }
 }
 
-static void test_buffer(size_t size)
+static void test_buffer(size_t size, bool session, erase_mode_t erase)
 {
-    printf("\r\nTest buffer: %u\r\n", size);
+    printf("\r\nTest buffer: %" PRIu32 " %s erase %s\r\n", (uint32_t) size, session ? "session" : "reopen", erase_mode_name(erase));
+
+    file_session = session;
+    file_timer.reset();
 
     /*************************************************************************/
     buffer0.size_max = size;
@@ -131,7 +184,20 @@ static void test_buffer(size_t size)
 
     printf("write to flash\r\n");
 
-    mbed_stress_test_erase_flash();
+    Timer write_timer;
+    write_timer.start();
+
+    uint32_t first_write_us = 0;
+    mbed_stress_test_flash_writer_t writer;
+
+    if (erase == ERASE_ALL)
+    {
+        mbed_stress_test_erase_flash();
+    }
+    else
+    {
+        mbed_stress_test_flash_writer_open(&writer, MBED_CONF_APP_ESTIMATED_APPLICATION_SIZE);
+    }
 
     size_t index = 0;
     while (index < sizeof(story))
@@ -141,11 +207,28 @@ static void test_buffer(size_t size)
         {
             my_buffer_t* buffer = (my_buffer_t*) event.value.p;
 
-            mbed_stress_test_write_flash(MBED_CONF_APP_ESTIMATED_APPLICATION_SIZE + index, buffer->ptr, buffer->size);
+            if (erase == ERASE_ALL)
+            {
+                mbed_stress_test_write_flash(MBED_CONF_APP_ESTIMATED_APPLICATION_SIZE + index, buffer->ptr, buffer->size);
+            }
+            else
+            {
+                mbed_stress_test_flash_writer_write(&writer, buffer->ptr, buffer->size);
+            }
+
+            if (index == 0)
+            {
+                first_write_us = write_timer.elapsed_time().count();
+            }
 
             index += buffer->size;
 
             mpool.put(buffer);
+
+            if ((erase == ERASE_AHEAD) && (index < sizeof(story)))
+            {
+                mbed_stress_test_flash_writer_erase_ahead(&writer, size);
+            }
         }
         else
         {
@@ -156,11 +239,33 @@ static void test_buffer(size_t size)
         }
     }
 
+    write_timer.stop();
+
     /*************************************************************************/
     printf("\r\nwrite complete - read back\r\n");
 
     mbed_stress_test_compare_flash(MBED_CONF_APP_ESTIMATED_APPLICATION_SIZE, story, sizeof(story));
 
+    /*************************************************************************/
+    uint32_t file_us = file_timer.elapsed_time().count();
+    uint32_t kibps = (file_us > 0) ? (uint32_t) ((uint64_t) sizeof(story) * 1000000 / 1024 / file_us) : 0;
+
+    printf("file read %s: %" PRIu32 " bytes in %" PRIu32 " us, %" PRIu32 " KiB/s\r\n",
+           session ? "session" : "reopen", (uint32_t) sizeof(story), file_us, kibps);
+
+    uint32_t total_ms = std::chrono::duration_cast<std::chrono::milliseconds>(write_timer.elapsed_time()).count();
+
+    printf("flash erase %s: first write after %" PRIu32 " us, all written after %" PRIu32 " ms\r\n",
+           erase_mode_name(erase), first_write_us, total_ms);
+
+    char key[32];
+    snprintf(key, sizeof(key), "file_%s_%" PRIu32 "k_kibps", session ? "session" : "reopen", (uint32_t) (size / 1024));
+    greentea_send_kv(key, (int) kibps);
+    snprintf(key, sizeof(key), "flash_%s_%" PRIu32 "k_first_us", erase_mode_name(erase), (uint32_t) (size / 1024));
+    greentea_send_kv(key, (int) first_write_us);
+    snprintf(key, sizeof(key), "flash_%s_%" PRIu32 "k_total_ms", erase_mode_name(erase), (uint32_t) (size / 1024));
+    greentea_send_kv(key, (int) total_ms);
+
     /*************************************************************************/
     mpool.get();
     mpool.get();
@@ -177,42 +282,70 @@ static control_t test_setup(const size_t call_count)
 
 static control_t test_buffer_1k(const size_t call_count)
 {
-    test_buffer(1*1024);
+    test_buffer(1*1024, true, ERASE_AHEAD);
 
     return CaseNext;
 }
 
 static control_t test_buffer_2k(const size_t call_count)
 {
-    test_buffer(2*1024);
+    test_buffer(2*1024, true, ERASE_AHEAD);
 
     return CaseNext;
 }
 
 static control_t test_buffer_4k(const size_t call_count)
 {
-    test_buffer(4*1024);
+    test_buffer(4*1024, true, ERASE_AHEAD);
 
     return CaseNext;
 }
 
 static control_t test_buffer_8k(const size_t call_count)
 {
-    test_buffer(8*1024);
+    test_buffer(8*1024, true, ERASE_AHEAD);
 
     return CaseNext;
 }
 
 static control_t test_buffer_16k(const size_t call_count)
 {
-    test_buffer(16*1024);
+    test_buffer(16*1024, true, ERASE_AHEAD);
 
     return CaseNext;
 }
 
 static control_t test_buffer_32k(const size_t call_count)
 {
-    test_buffer(32*1024);
+    test_buffer(32*1024, true, ERASE_AHEAD);
+
+    return CaseNext;
+}
+
+static control_t test_reopen_1k(const size_t call_count)
+{
+    test_buffer(1*1024, false, ERASE_AHEAD);
+
+    return CaseNext;
+}
+
+static control_t test_reopen_8k(const size_t call_count)
+{
+    test_buffer(8*1024, false, ERASE_AHEAD);
+
+    return CaseNext;
+}
+
+static control_t test_erase_all_4k(const size_t call_count)
+{
+    test_buffer(4*1024, true, ERASE_ALL);
+
+    return CaseNext;
+}
+
+static control_t test_erase_lazy_4k(const size_t call_count)
+{
+    test_buffer(4*1024, true, ERASE_LAZY);
 
     return CaseNext;
 }
@@ -223,6 +356,10 @@ Case cases[] = {
     Case("Buffer  2k", test_buffer_2k),
     Case("Buffer  4k", test_buffer_4k),
     Case("Buffer  8k", test_buffer_8k),
+    Case("Reopen  1k", test_reopen_1k),
+    Case("Reopen  8k", test_reopen_8k),
+    Case("Erase all  4k", test_erase_all_4k),
+    Case("Erase lazy  4k", test_erase_lazy_4k),
 //    Case("Buffer 16k", test_buffer_16k),
 //    Case("Buffer 32k", test_buffer_32k),
 };
@@ -27,6 +27,12 @@
 
 #include "mbed.h"
 
+#ifndef __STDC_FORMAT_MACROS
+#define __STDC_FORMAT_MACROS
+#endif
+
+#include <inttypes.h>
+
 #include "utest/utest.h"
 #include "unity/unity.h"
 #include "greentea-client/test_env.h"
@@ -35,6 +41,9 @@
 
 #include MBED_CONF_APP_PROTAGONIST_FILE
 
+#define GENERATED_SEED 1
+#define GENERATED_LENGTH (1024*1024)
+
 using namespace utest::v1;
 
 static control_t format_storage(const size_t call_count)
@@ -44,138 +53,295 @@ static control_t format_storage(const size_t call_count)
     return CaseNext;
 }
 
+/* block sizes 1 << 0 to 1 << 16, throughput of each case that ran, 0 if it didn't */
+#define SWEEP_SIZES 17
+
+static uint32_t sweep_write_kibps[SWEEP_SIZES];
+static uint32_t sweep_read_kibps[SWEEP_SIZES];
+
+static uint32_t story_kibps(uint32_t us)
+{
+    return (us > 0) ? (uint32_t) ((uint64_t) sizeof(story) * 1000000 / 1024 / us) : 0;
+}
+
+static uint32_t sweep_report(const char* direction, size_t block_size, uint32_t us)
+{
+    uint32_t calls = (sizeof(story) + block_size - 1) / block_size;
+    uint32_t kibps = story_kibps(us);
+    uint32_t call_ns = (uint32_t) ((uint64_t) us * 1000 / calls);
+
+    printf("%-7s %6" PRIu32 ": %8" PRIu32 " KiB/s %8" PRIu32 " ns per call\r\n", direction, (uint32_t) block_size, kibps, call_ns);
+
+    char key[40];
+    snprintf(key, sizeof(key), "fs_%s_%" PRIu32 "_kibps", direction, (uint32_t) block_size);
+    greentea_send_kv(key, (int) kibps);
+    snprintf(key, sizeof(key), "fs_%s_%" PRIu32 "_call_ns", direction, (uint32_t) block_size);
+    greentea_send_kv(key, (int) call_ns);
+
+    return kibps;
+}
+
+static void test_buffer(size_t block_size)
+{
+    Timer timer;
+
+    timer.start();
+    mbed_stress_test_write_file("mbed-stress-test.txt", 0, story, sizeof(story), block_size);
+    timer.stop();
+    uint32_t write_us = timer.elapsed_time().count();
+
+    timer.reset();
+    timer.start();
+    mbed_stress_test_compare_file("mbed-stress-test.txt", 0, story, sizeof(story), block_size);
+    timer.stop();
+    uint32_t read_us = timer.elapsed_time().count();
+
+    size_t index = 0;
+    while ((index < SWEEP_SIZES - 1) && ((size_t) 1 << index) < block_size) {
+        index++;
+    }
+
+    sweep_write_kibps[index] = sweep_report("write", block_size, write_us);
+    sweep_read_kibps[index] = sweep_report("compare", block_size, read_us);
+}
+
+/* smallest block size reaching 90% of the best throughput in the sweep */
+static void sweep_knee(const char* direction, const uint32_t kibps[SWEEP_SIZES])
+{
+    uint32_t peak = 0;
+
+    for (size_t index = 0; index < SWEEP_SIZES; index++) {
+        if (kibps[index] > peak) {
+            peak = kibps[index];
+        }
+    }
+    TEST_ASSERT_MESSAGE(peak > 0, "no block sizes measured");
+
+    for (size_t index = 0; index < SWEEP_SIZES; index++) {
+        if ((uint64_t) kibps[index] * 10 >= (uint64_t) peak * 9) {
+            uint32_t block_size = 1 << index;
+
+            printf("%-7s peak %" PRIu32 " KiB/s, 90%% reached at %" PRIu32 " bytes (%" PRIu32 " KiB/s)\r\n",
+                   direction, peak, block_size, kibps[index]);
+
+            char key[40];
+            snprintf(key, sizeof(key), "fs_%s_peak_kibps", direction);
+            greentea_send_kv(key, (int) peak);
+            snprintf(key, sizeof(key), "fs_%s_knee_bytes", direction);
+            greentea_send_kv(key, (int) block_size);
+            break;
+        }
+    }
+}
+
+static control_t test_knee(const size_t call_count)
+{
+    sweep_knee("write", sweep_write_kibps);
+    sweep_knee("compare", sweep_read_kibps);
+
+    return CaseNext;
+}
+
 static control_t test_buffer_1(const size_t call_count)
 {
-    mbed_stress_test_write_file("mbed-stress-test.txt", 0, story, sizeof(story), 1);
-    mbed_stress_test_compare_file("mbed-stress-test.txt", 0, story, sizeof(story), 1);
+    test_buffer(1);
 
     return CaseNext;
 }
 
 static control_t test_buffer_2(const size_t call_count)
 {
-    mbed_stress_test_write_file("mbed-stress-test.txt", 0, story, sizeof(story), 2);
-    mbed_stress_test_compare_file("mbed-stress-test.txt", 0, story, sizeof(story), 2);
+    test_buffer(2);
 
     return CaseNext;
 }
 
 static control_t test_buffer_4(const size_t call_count)
 {
-    mbed_stress_test_write_file("mbed-stress-test.txt", 0, story, sizeof(story), 4);
-    mbed_stress_test_compare_file("mbed-stress-test.txt", 0, story, sizeof(story), 4);
+    test_buffer(4);
 
     return CaseNext;
 }
 
 static control_t test_buffer_8(const size_t call_count)
 {
-    mbed_stress_test_write_file("mbed-stress-test.txt", 0, story, sizeof(story), 8);
-    mbed_stress_test_compare_file("mbed-stress-test.txt", 0, story, sizeof(story), 8);
+    test_buffer(8);
 
     return CaseNext;
 }
 
 static control_t test_buffer_16(const size_t call_count)
 {
-    mbed_stress_test_write_file("mbed-stress-test.txt", 0, story, sizeof(story), 16);
-    mbed_stress_test_compare_file("mbed-stress-test.txt", 0, story, sizeof(story), 16);
+    test_buffer(16);
 
     return CaseNext;
 }
 
 static control_t test_buffer_32(const size_t call_count)
 {
-    mbed_stress_test_write_file("mbed-stress-test.txt", 0, story, sizeof(story), 32);
-    mbed_stress_test_compare_file("mbed-stress-test.txt", 0, story, sizeof(story), 32);
+    test_buffer(32);
 
     return CaseNext;
 }
 
 static control_t test_buffer_64(const size_t call_count)
 {
-    mbed_stress_test_write_file("mbed-stress-test.txt", 0, story, sizeof(story), 64);
-    mbed_stress_test_compare_file("mbed-stress-test.txt", 0, story, sizeof(story), 64);
+    test_buffer(64);
 
     return CaseNext;
 }
 
 static control_t test_buffer_128(const size_t call_count)
 {
-    mbed_stress_test_write_file("mbed-stress-test.txt", 0, story, sizeof(story), 128);
-    mbed_stress_test_compare_file("mbed-stress-test.txt", 0, story, sizeof(story), 128);
+    test_buffer(128);
 
     return CaseNext;
 }
 
 static control_t test_buffer_256(const size_t call_count)
 {
-    mbed_stress_test_write_file("mbed-stress-test.txt", 0, story, sizeof(story), 256);
-    mbed_stress_test_compare_file("mbed-stress-test.txt", 0, story, sizeof(story), 256);
+    test_buffer(256);
 
     return CaseNext;
 }
 
 static control_t test_buffer_512(const size_t call_count)
 {
-    mbed_stress_test_write_file("mbed-stress-test.txt", 0, story, sizeof(story), 512);
-    mbed_stress_test_compare_file("mbed-stress-test.txt", 0, story, sizeof(story), 512);
+    test_buffer(512);
 
     return CaseNext;
 }
 
 static control_t test_buffer_1k(const size_t call_count)
 {
-    mbed_stress_test_write_file("mbed-stress-test.txt", 0, story, sizeof(story), 1024);
-    mbed_stress_test_compare_file("mbed-stress-test.txt", 0, story, sizeof(story), 1024);
+    test_buffer(1024);
 
     return CaseNext;
 }
 
 static control_t test_buffer_2k(const size_t call_count)
 {
-    mbed_stress_test_write_file("mbed-stress-test.txt", 0, story, sizeof(story), 2*1024);
-    mbed_stress_test_compare_file("mbed-stress-test.txt", 0, story, sizeof(story), 2*1024);
+    test_buffer(2*1024);
 
     return CaseNext;
 }
 
 static control_t test_buffer_4k(const size_t call_count)
 {
-    mbed_stress_test_write_file("mbed-stress-test.txt", 0, story, sizeof(story), 4*1024);
-    mbed_stress_test_compare_file("mbed-stress-test.txt", 0, story, sizeof(story), 4*1024);
+    test_buffer(4*1024);
 
     return CaseNext;
 }
 
 static control_t test_buffer_8k(const size_t call_count)
 {
-    mbed_stress_test_write_file("mbed-stress-test.txt", 0, story, sizeof(story), 8*1024);
-    mbed_stress_test_compare_file("mbed-stress-test.txt", 0, story, sizeof(story), 8*1024);
+    test_buffer(8*1024);
 
     return CaseNext;
 }
 
 static control_t test_buffer_16k(const size_t call_count)
 {
-    mbed_stress_test_write_file("mbed-stress-test.txt", 0, story, sizeof(story), 16*1024);
-    mbed_stress_test_compare_file("mbed-stress-test.txt", 0, story, sizeof(story), 16*1024);
+    test_buffer(16*1024);
 
     return CaseNext;
 }
 
 static control_t test_buffer_32k(const size_t call_count)
 {
-    mbed_stress_test_write_file("mbed-stress-test.txt", 0, story, sizeof(story), 32*1024);
-    mbed_stress_test_compare_file("mbed-stress-test.txt", 0, story, sizeof(story), 32*1024);
+    test_buffer(32*1024);
 
     return CaseNext;
 }
 
 static control_t test_buffer_64k(const size_t call_count)
 {
-    mbed_stress_test_write_file("mbed-stress-test.txt", 0, story, sizeof(story), 64*1024);
-    mbed_stress_test_compare_file("mbed-stress-test.txt", 0, story, sizeof(story), 64*1024);
+    test_buffer(64*1024);
+
+    return CaseNext;
+}
+
+/* larger than any story, and never repeating */
+static control_t test_generated_4k(const size_t call_count)
+{
+    mbed_stress_test_write_file_generated("mbed-stress-test.bin", GENERATED_SEED, GENERATED_LENGTH, 4*1024);
+    mbed_stress_test_compare_file_generated("mbed-stress-test.bin", GENERATED_SEED, GENERATED_LENGTH, 4*1024);
+
+    return CaseNext;
+}
+
+/* the same story sweep through stdio, stdio with its own buffer size, POSIX and File */
+typedef struct {
+    const char* name;
+    mbed_stress_test_file_io_t io;
+    size_t vbuf_size;
+} io_config_t;
+
+static const io_config_t io_configs[] = {
+    { "stdio",    MBED_STRESS_TEST_FILE_STDIO, 0 },
+    { "stdio512", MBED_STRESS_TEST_FILE_STDIO, 512 },
+    { "stdio4k",  MBED_STRESS_TEST_FILE_STDIO, 4*1024 },
+    { "posix",    MBED_STRESS_TEST_FILE_POSIX, 0 },
+    { "file",     MBED_STRESS_TEST_FILE_API,   0 },
+};
+
+#define IO_CONFIGS (sizeof(io_configs) / sizeof(io_configs[0]))
+
+static const size_t io_block_sizes[] = { 16, 128, 512, 1024, 4*1024, 16*1024 };
+
+#define IO_BLOCK_SIZES (sizeof(io_block_sizes) / sizeof(io_block_sizes[0]))
+
+static void io_table(const char* direction, uint32_t kibps[IO_BLOCK_SIZES][IO_CONFIGS])
+{
+    printf("\r\n%s KiB/s\r\n%8s", direction, "block");
+    for (size_t config = 0; config < IO_CONFIGS; config++) {
+        printf(" %10s", io_configs[config].name);
+    }
+    printf("\r\n");
+
+    for (size_t block = 0; block < IO_BLOCK_SIZES; block++) {
+        printf("%8" PRIu32, (uint32_t) io_block_sizes[block]);
+        for (size_t config = 0; config < IO_CONFIGS; config++) {
+            printf(" %10" PRIu32, kibps[block][config]);
+        }
+        printf("\r\n");
+    }
+
+    for (size_t block = 0; block < IO_BLOCK_SIZES; block++) {
+        for (size_t config = 0; config < IO_CONFIGS; config++) {
+            char key[40];
+            snprintf(key, sizeof(key), "fs_%s_%" PRIu32 "_%s_kibps",
+                     io_configs[config].name, (uint32_t) io_block_sizes[block], direction);
+            greentea_send_kv(key, (int) kibps[block][config]);
+        }
+    }
+}
+
+static control_t test_io_modes(const size_t call_count)
+{
+    static uint32_t write_kibps[IO_BLOCK_SIZES][IO_CONFIGS];
+    static uint32_t read_kibps[IO_BLOCK_SIZES][IO_CONFIGS];
+
+    for (size_t block = 0; block < IO_BLOCK_SIZES; block++) {
+        for (size_t config = 0; config < IO_CONFIGS; config++) {
+            const io_config_t* io = &io_configs[config];
+            Timer timer;
+
+            timer.start();
+            mbed_stress_test_write_file_io("mbed-stress-test.txt", 0, story, sizeof(story), io_block_sizes[block], io->io, io->vbuf_size);
+            timer.stop();
+            write_kibps[block][config] = story_kibps(timer.elapsed_time().count());
+
+            timer.reset();
+            timer.start();
+            mbed_stress_test_compare_file_io("mbed-stress-test.txt", 0, story, sizeof(story), io_block_sizes[block], io->io, io->vbuf_size);
+            timer.stop();
+            read_kibps[block][config] = story_kibps(timer.elapsed_time().count());
+        }
+    }
+
+    io_table("write", write_kibps);
+    io_table("read", read_kibps);
 
     return CaseNext;
 }
@@ -204,6 +370,9 @@ Case cases[] = {
     Case("story  8k", test_buffer_8k),
 //    Case("story 16k", test_buffer_16k),
 //    Case("story 32k", test_buffer_32k),
+    Case("story knee", test_knee),
+    Case("generated  4k", test_generated_4k),
+    Case("I/O modes", test_io_modes),
 };
 
 Specification specification(greentea_setup, cases);
@@ -0,0 +1,86 @@
+/*
+ * mbed Microcontroller Library
+ * Copyright (c) 2006-2016 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file main.cpp Flash endurance cycling.
+ *
+ * Erases, programs and verifies a window of internal flash sectors over
+ * and over. Erase counts per sector are kept in the last sector of flash,
+ * so repeated runs keep wearing the same sectors and the timing reports
+ * trace throughput against erase count.
+ */
+
+#if !DEVICE_FLASH
+#error [NOT_SUPPORTED] Flash API not supported for this target.
+#endif
+
+#include "mbed.h"
+
+#include "utest/utest.h"
+#include "unity/unity.h"
+#include "greentea-client/test_env.h"
+
+using namespace utest::v1;
+
+#include "mbed_stress_test_flash.h"
+
+#ifndef MBED_CONF_APP_FLASH_ENDURANCE_CYCLES
+#define MBED_CONF_APP_FLASH_ENDURANCE_CYCLES 100
+#endif
+
+#ifndef MBED_CONF_APP_FLASH_ENDURANCE_SECTORS
+#define MBED_CONF_APP_FLASH_ENDURANCE_SECTORS 4
+#endif
+
+#ifndef MBED_CONF_APP_FLASH_ENDURANCE_REPORT_EVERY
+#define MBED_CONF_APP_FLASH_ENDURANCE_REPORT_EVERY 10
+#endif
+
+#ifndef MBED_CONF_APP_FLASH_ENDURANCE_RESET
+#define MBED_CONF_APP_FLASH_ENDURANCE_RESET 0
+#endif
+
+void endurance_test(void)
+{
+    mbed_stress_test_flash_timing_reset();
+
+    uint32_t failures = mbed_stress_test_flash_endurance(MBED_CONF_APP_ESTIMATED_APPLICATION_SIZE,
+                                                         MBED_CONF_APP_FLASH_ENDURANCE_SECTORS,
+                                                         MBED_CONF_APP_FLASH_ENDURANCE_CYCLES,
+                                                         MBED_CONF_APP_FLASH_ENDURANCE_REPORT_EVERY,
+                                                         MBED_CONF_APP_FLASH_ENDURANCE_RESET);
+
+    mbed_stress_test_flash_timing_report();
+
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, failures, "sectors failed verification");
+}
+
+Case cases[] = {
+    Case("Flash endurance", endurance_test),
+};
+
+utest::v1::status_t greentea_setup(const size_t number_of_cases)
+{
+    GREENTEA_SETUP(10*60, "default_auto");
+    return greentea_test_setup_handler(number_of_cases);
+}
+
+Specification specification(greentea_setup, cases, greentea_test_teardown_handler);
+
+int main()
+{
+    return !Harness::run(specification);
+}
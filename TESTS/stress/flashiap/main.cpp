@@ -1,123 +1,345 @@
-/*
- * mbed Microcontroller Library
- * Copyright (c) 2006-2016 ARM Limited
- *
- * Licensed under the Apache License, Version 2.0 (the "License");
- * you may not use this file except in compliance with the License.
- * You may obtain a copy of the License at
- *
- *     http://www.apache.org/licenses/LICENSE-2.0
- *
- * Unless required by applicable law or agreed to in writing, software
- * distributed under the License is distributed on an "AS IS" BASIS,
- * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
- * See the License for the specific language governing permissions and
- * limitations under the License.
- */
-
-/** @file fopen.cpp Test cases to POSIX file fopen() interface.
- *
- * Please consult the documentation under the test-case functions for
- * a description of the individual test case.
- */
-
-#if !DEVICE_FLASH
-#error [NOT_SUPPORTED] Flash API not supported for this target.
-#endif
-
-#include "mbed.h"
-
-#include "utest/utest.h"
-#include "unity/unity.h"
-#include "greentea-client/test_env.h"
-
-using namespace utest::v1;
-
-#include "mbed_stress_test_flash.h"
-
-#include MBED_CONF_APP_PROTAGONIST_FLASH
-
-void flash_test(void)
-{
-    FlashIAP flash;
-
-    int result = flash.init();
-    TEST_ASSERT_EQUAL_INT_MESSAGE(0, result, "failed to initialize FlashIAP");
-
-    uint32_t page_size = flash.get_page_size();
-    uint32_t flash_size = flash.get_flash_size();
-
-    mbed_stress_test_erase_flash();
-
-    printf("fill flash with multiple stories\r\n");
-
-    for (size_t offset = MBED_CONF_APP_ESTIMATED_APPLICATION_SIZE; offset < flash_size; )
-    {
-        printf("write new story\r\n");
-
-        size_t write_size = sizeof(story);
-
-        if (write_size > (flash_size - offset))
-        {
-            write_size = flash_size - offset;
-        }
-
-        /* round down to page size boundary */
-        write_size = (write_size / page_size) * page_size;
-
-        if (write_size > 0)
-        {
-            mbed_stress_test_write_flash(offset, story, write_size);
-            offset += write_size;
-        }
-        else
-        {
-            break;
-        }
-
-    }
-
-    printf("read stories\r\n");
-
-    for (size_t offset = MBED_CONF_APP_ESTIMATED_APPLICATION_SIZE; offset < flash_size; )
-    {
-        printf("read story\r\n");
-
-        size_t read_size = sizeof(story);
-
-        if (read_size > (flash_size - offset))
-        {
-            read_size = flash_size - offset;
-        }
-
-        /* round down to page size boundary */
-        read_size = (read_size / page_size) * page_size;
-
-        if (read_size > 0)
-        {
-            mbed_stress_test_compare_flash(offset, story, read_size);
-            offset += read_size;
-        }
-        else
-        {
-            break;
-        }
-    }
-}
-
-Case cases[] = {
-    Case("Flash test", flash_test),
-};
-
-utest::v1::status_t greentea_setup(const size_t number_of_cases)
-{
-    GREENTEA_SETUP(10*60, "default_auto");
-    return greentea_test_setup_handler(number_of_cases);
-}
-
-Specification specification(greentea_setup, cases, greentea_test_teardown_handler);
-
-int main()
-{
-    return !Harness::run(specification);
-}
+/*
+ * mbed Microcontroller Library
+ * Copyright (c) 2006-2016 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file fopen.cpp Test cases to POSIX file fopen() interface.
+ *
+ * Please consult the documentation under the test-case functions for
+ * a description of the individual test case.
+ */
+
+#if !DEVICE_FLASH
+#error [NOT_SUPPORTED] Flash API not supported for this target.
+#endif
+
+#include "mbed.h"
+
+#ifndef __STDC_FORMAT_MACROS
+#define __STDC_FORMAT_MACROS
+#endif
+
+#include <inttypes.h>
+
+#include "utest/utest.h"
+#include "unity/unity.h"
+#include "greentea-client/test_env.h"
+
+using namespace utest::v1;
+
+#include "mbed_stress_test_flash.h"
+
+#include MBED_CONF_APP_PROTAGONIST_FLASH
+
+#define GENERATED_SEED 1
+
+void flash_test(void)
+{
+    FlashIAP flash;
+
+    int result = flash.init();
+    TEST_ASSERT_EQUAL_INT_MESSAGE(0, result, "failed to initialize FlashIAP");
+
+    uint32_t page_size = flash.get_page_size();
+    uint32_t flash_size = mbed_stress_test_flash_usable_size();
+
+    mbed_stress_test_erase_flash();
+
+    printf("fill flash with multiple stories\r\n");
+
+    for (size_t offset = MBED_CONF_APP_ESTIMATED_APPLICATION_SIZE; offset < flash_size; )
+    {
+        printf("write new story\r\n");
+
+        size_t write_size = sizeof(story);
+
+        if (write_size > (flash_size - offset))
+        {
+            write_size = flash_size - offset;
+        }
+
+        /* round down to page size boundary */
+        write_size = (write_size / page_size) * page_size;
+
+        if (write_size > 0)
+        {
+            mbed_stress_test_write_flash(offset, story, write_size);
+            offset += write_size;
+        }
+        else
+        {
+            break;
+        }
+
+    }
+
+    printf("read stories\r\n");
+
+    for (size_t offset = MBED_CONF_APP_ESTIMATED_APPLICATION_SIZE; offset < flash_size; )
+    {
+        printf("read story\r\n");
+
+        size_t read_size = sizeof(story);
+
+        if (read_size > (flash_size - offset))
+        {
+            read_size = flash_size - offset;
+        }
+
+        /* round down to page size boundary */
+        read_size = (read_size / page_size) * page_size;
+
+        if (read_size > 0)
+        {
+            mbed_stress_test_compare_flash(offset, story, read_size);
+            offset += read_size;
+        }
+        else
+        {
+            break;
+        }
+    }
+}
+
+/* one non-repeating stream across the whole area, no reference copy in flash */
+void flash_generated_test(void)
+{
+    FlashIAP flash;
+
+    int result = flash.init();
+    TEST_ASSERT_EQUAL_INT_MESSAGE(0, result, "failed to initialize FlashIAP");
+
+    uint32_t page_size = flash.get_page_size();
+    uint32_t flash_size = mbed_stress_test_flash_usable_size();
+
+    mbed_stress_test_erase_flash();
+
+    size_t offset = MBED_CONF_APP_ESTIMATED_APPLICATION_SIZE;
+    size_t length = ((flash_size - offset) / page_size) * page_size;
+
+    printf("fill flash with generated data\r\n");
+    mbed_stress_test_write_flash_generated(offset, GENERATED_SEED, length);
+
+    printf("read generated data\r\n");
+    mbed_stress_test_compare_flash_generated(offset, GENERATED_SEED, length);
+}
+
+/* program the story once page by page and once batched, and compare the rate */
+static uint32_t flash_rate(const char* name, uint32_t batch_size)
+{
+    FlashIAP flash;
+
+    int result = flash.init();
+    TEST_ASSERT_EQUAL_INT_MESSAGE(0, result, "failed to initialize FlashIAP");
+
+    uint32_t page_size = flash.get_page_size();
+    uint32_t pages = (sizeof(story) + page_size - 1) / page_size;
+
+    mbed_stress_test_erase_flash();
+
+    Timer timer;
+    timer.start();
+    mbed_stress_test_write_flash_batch(MBED_CONF_APP_ESTIMATED_APPLICATION_SIZE, story, sizeof(story), batch_size);
+    timer.stop();
+
+    mbed_stress_test_compare_flash(MBED_CONF_APP_ESTIMATED_APPLICATION_SIZE, story, sizeof(story));
+
+    uint32_t us = timer.elapsed_time().count();
+    uint32_t pages_per_s = (us > 0) ? (uint32_t) ((uint64_t) pages * 1000000 / us) : 0;
+
+    printf("%s: %" PRIu32 " pages of %" PRIu32 " bytes in %" PRIu32 " us, %" PRIu32 " pages/s\r\n",
+           name, pages, page_size, us, pages_per_s);
+
+    char key[40];
+    snprintf(key, sizeof(key), "flash_%s_pages_per_s", name);
+    greentea_send_kv(key, (int) pages_per_s);
+
+    return pages_per_s;
+}
+
+void flash_rate_test(void)
+{
+    FlashIAP flash;
+
+    int result = flash.init();
+    TEST_ASSERT_EQUAL_INT_MESSAGE(0, result, "failed to initialize FlashIAP");
+
+    flash_rate("paged", flash.get_page_size());
+    flash_rate("batched", 0);
+}
+
+/* story from an odd source address with an odd length, so it all goes
+ * through the staging buffer and the last page is padded
+ */
+void flash_unaligned_test(void)
+{
+    mbed_stress_test_erase_flash();
+
+    size_t offset = MBED_CONF_APP_ESTIMATED_APPLICATION_SIZE;
+    size_t length = sizeof(story) - 5;
+
+    mbed_stress_test_write_flash(offset, &story[1], length);
+    mbed_stress_test_compare_flash(offset, &story[1], length);
+}
+
+/* batch sizes under a page round up to one page per program call */
+void flash_small_batch_test(void)
+{
+    FlashIAP flash;
+
+    int result = flash.init();
+    TEST_ASSERT_EQUAL_INT_MESSAGE(0, result, "failed to initialize FlashIAP");
+
+    uint32_t page_size = flash.get_page_size();
+    uint32_t batch_sizes[] = { 1, page_size - 1, page_size + 1 };
+
+    for (size_t index = 0; index < sizeof(batch_sizes) / sizeof(batch_sizes[0]); index++)
+    {
+        if (batch_sizes[index] == 0)
+        {
+            continue;
+        }
+
+        printf("batch size: %" PRIu32 "\r\n", batch_sizes[index]);
+
+        mbed_stress_test_erase_flash();
+
+        /* whole pages from the caller's buffer, then an odd source through the staging buffer */
+        size_t offset = MBED_CONF_APP_ESTIMATED_APPLICATION_SIZE;
+
+        mbed_stress_test_write_flash_batch(offset, story, sizeof(story), batch_sizes[index]);
+        mbed_stress_test_compare_flash(offset, story, sizeof(story));
+
+        offset += ((sizeof(story) + page_size - 1) / page_size) * page_size;
+        size_t length = sizeof(story) - 5;
+
+        mbed_stress_test_write_flash_batch(offset, &story[1], length, batch_sizes[index]);
+        mbed_stress_test_compare_flash(offset, &story[1], length);
+    }
+}
+
+static void flash_verify_rate(const char* name, mbed_stress_test_flash_verify_t mode)
+{
+    Timer timer;
+    timer.start();
+    mbed_stress_test_compare_flash_mode(MBED_CONF_APP_ESTIMATED_APPLICATION_SIZE, story, sizeof(story), mode);
+    timer.stop();
+
+    uint32_t us = timer.elapsed_time().count();
+    uint32_t kibps = (us > 0) ? (uint32_t) ((uint64_t) sizeof(story) * 1000000 / 1024 / us) : 0;
+
+    printf("verify %s: %" PRIu32 " bytes in %" PRIu32 " us, %" PRIu32 " KiB/s\r\n", name, (uint32_t) sizeof(story), us, kibps);
+
+    char key[40];
+    snprintf(key, sizeof(key), "flash_verify_%s_kibps", name);
+    greentea_send_kv(key, (int) kibps);
+}
+
+/* the story checked in place and through FlashIAP::read */
+void flash_verify_test(void)
+{
+    mbed_stress_test_erase_flash();
+    mbed_stress_test_write_flash(MBED_CONF_APP_ESTIMATED_APPLICATION_SIZE, story, sizeof(story));
+
+    if (MBED_CONF_APP_FLASH_MEMORY_MAPPED)
+    {
+        flash_verify_rate("mapped", MBED_STRESS_TEST_FLASH_VERIFY_MAPPED);
+    }
+    flash_verify_rate("read", MBED_STRESS_TEST_FLASH_VERIFY_READ);
+}
+
+static void flash_update(const char* name, const unsigned char* data, size_t length, mbed_stress_test_flash_update_t* update)
+{
+    printf("%s\r\n", name);
+
+    mbed_stress_test_write_flash_differential(MBED_CONF_APP_ESTIMATED_APPLICATION_SIZE, data, length, update);
+    mbed_stress_test_compare_flash(MBED_CONF_APP_ESTIMATED_APPLICATION_SIZE, data, length);
+
+    char key[40];
+    snprintf(key, sizeof(key), "flash_%s_skipped", name);
+    greentea_send_kv(key, (int) update->skipped);
+    snprintf(key, sizeof(key), "flash_%s_erases", name);
+    greentea_send_kv(key, (int) update->erases);
+    snprintf(key, sizeof(key), "flash_%s_us", name);
+    greentea_send_kv(key, (int) update->us);
+}
+
+/* the same story twice: the second pass should find nothing to do */
+void flash_differential_test(void)
+{
+    mbed_stress_test_flash_update_t update;
+
+    mbed_stress_test_erase_flash();
+
+    flash_update("blank", story, sizeof(story), &update);
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, update.erases, "erased blank sectors");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, update.skipped, "skipped blank sectors");
+
+    flash_update("same", story, sizeof(story), &update);
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, update.erases, "erased unchanged sectors");
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(update.sectors, update.skipped, "rewrote unchanged sectors");
+
+    /* shifted by one byte, every sector differs */
+    flash_update("shifted", &story[1], sizeof(story) - 1, &update);
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(update.sectors, update.erases, "sectors not erased");
+}
+
+/* every sector erased and filled once, as a per-board latency baseline */
+void flash_timing_test(void)
+{
+    FlashIAP flash;
+
+    int result = flash.init();
+    TEST_ASSERT_EQUAL_INT_MESSAGE(0, result, "failed to initialize FlashIAP");
+
+    uint32_t page_size = flash.get_page_size();
+    uint32_t flash_size = mbed_stress_test_flash_usable_size();
+
+    size_t offset = MBED_CONF_APP_ESTIMATED_APPLICATION_SIZE;
+    size_t length = ((flash_size - offset) / page_size) * page_size;
+
+    mbed_stress_test_flash_timing_reset();
+
+    mbed_stress_test_erase_flash();
+    mbed_stress_test_write_flash_generated(offset, GENERATED_SEED, length);
+
+    mbed_stress_test_flash_timing_report();
+
+    mbed_stress_test_compare_flash_generated(offset, GENERATED_SEED, length);
+}
+
+Case cases[] = {
+    Case("Flash test", flash_test),
+    Case("Flash generated", flash_generated_test),
+    Case("Flash program rate", flash_rate_test),
+    Case("Flash unaligned", flash_unaligned_test),
+    Case("Flash small batch", flash_small_batch_test),
+    Case("Flash differential", flash_differential_test),
+    Case("Flash verify rate", flash_verify_test),
+    Case("Flash timing", flash_timing_test),
+};
+
+utest::v1::status_t greentea_setup(const size_t number_of_cases)
+{
+    GREENTEA_SETUP(10*60, "default_auto");
+    return greentea_test_setup_handler(number_of_cases);
+}
+
+Specification specification(greentea_setup, cases, greentea_test_teardown_handler);
+
+int main()
+{
+    return !Harness::run(specification);
+}
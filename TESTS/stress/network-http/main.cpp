@@ -28,33 +28,44 @@
 #endif
 
 #include "mbed.h"
+#include <inttypes.h>
 
 #include "utest/utest.h"
 #include "unity/unity.h"
 #include "greentea-client/test_env.h"
 
-#include <string>
+#include "mbed_stress_test_compare.h"
+#include "mbed_stress_test_http.h"
+#include "mbed_stress_test_network.h"
+#include "mbed_stress_test_verify.h"
 
 using namespace utest::v1;
 
 #include MBED_CONF_APP_PROTAGONIST_DOWNLOAD
-#include "certificate_aws_s3.h"
 
-static volatile bool event_fired = false;
+/* too large for flash, verified by digest as they stream in */
+#include "elizabeth_digest.h"
+#include "bogdan_digest.h"
 
 NetworkInterface* interface = NULL;
 
 #define MAX_RETRIES 3
+#define SOCKET_TIMEOUT_MS 30000
+#define PHASE_RUNS 10
 
 const char part1[] = "GET /firmware/";
 const char filename[] = MBED_CONF_APP_PROTAGONIST_DOWNLOAD;
-const char part2[] = "txt HTTP/1.1\nHost: lootbox.s3.dualstack.us-west-2.amazonaws.com\n\n";
+const char part2[] = "txt HTTP/1.1\nHost: " MBED_CONF_APP_DOWNLOAD_HOST "\n\n";
 
-static void socket_event(void)
+/* compare body bytes against the story as they arrive */
+static void compare_story(void* context, size_t offset, const char* data, size_t length)
 {
-    event_fired = true;
+    TEST_ASSERT_MESSAGE(offset + length <= sizeof(story), "received too many bytes");
+    mbed_stress_test_assert_equal(&story[offset], data, length, offset, "character mismatch");
 }
 
+static mbed_stress_test_phase_stats_t phase_stats;
+
 void download(size_t size)
 {
     int result = -1;
@@ -66,13 +77,19 @@ void download(size_t size)
     result = tcpsocket->open(interface);
     TEST_ASSERT_EQUAL_INT_MESSAGE(0, result, "failed to open socket");
 
+    /* phases start with the name lookup */
+    mbed_stress_test_phase_timing_t timing;
+    mbed_stress_test_phase_start(&timing);
+
     for (int tries = 0; tries < MAX_RETRIES; tries++) {
         SocketAddress address;
 
-        NetworkInterface::get_default_instance()->gethostbyname("lootbox.s3.dualstack.us-west-2.amazonaws.com", &address);
-        address.set_port(80);
+        mbed_stress_test_gethostbyname(interface, MBED_CONF_APP_DOWNLOAD_HOST, &address);
+        address.set_port(MBED_CONF_APP_DOWNLOAD_HTTP_PORT);
+        mbed_stress_test_phase_mark(&timing, MBED_STRESS_TEST_PHASE_DNS);
 
         result = tcpsocket->connect(address);
+        mbed_stress_test_phase_mark(&timing, MBED_STRESS_TEST_PHASE_CONNECT);
         if (result == NSAPI_ERROR_OK) {
             break;
         }
@@ -83,7 +100,8 @@ void download(size_t size)
     tcpsocket->set_blocking(false);
     printf("non-blocking mode set\r\n");
 
-    tcpsocket->sigio(socket_event);
+    mbed_stress_test_socket_event_t event;
+    mbed_stress_test_socket_event_attach(&event, tcpsocket);
     printf("registered callback function\r\n");
 
 
@@ -109,17 +127,17 @@ void download(size_t size)
     char* receive_buffer = new char[size];
     TEST_ASSERT_NOT_NULL_MESSAGE(receive_buffer, "failed to allocate receive buffer");
 
-    size_t expected_bytes = sizeof(story);
-    size_t received_bytes = 0;
-    uint32_t body_index = 0;
+    mbed_stress_test_http_t http;
+    mbed_stress_test_http_init(&http, compare_story, NULL);
 
+    bool received_any = false;
 
-    /* loop until all expected bytes have been received */
-    while (received_bytes < expected_bytes)
+    /* loop until the whole response has been parsed */
+    while (!mbed_stress_test_http_done(&http))
     {
         /* wait for async event */
-        while(!event_fired);
-        event_fired = false;
+        bool event_fired = mbed_stress_test_socket_event_wait(&event, SOCKET_TIMEOUT_MS);
+        TEST_ASSERT_TRUE_MESSAGE(event_fired, "timeout waiting for socket");
 
         /* loop until all data has been read from socket */
         do
@@ -129,43 +147,34 @@ void download(size_t size)
 
 //            printf("result: %d\r\n", result);
 
-            if (result > 0)
+            if (result == 0)
             {
-                /* skip HTTP header */
-                if (body_index == 0)
-                {
-                    std::string header(receive_buffer, result);
-                    body_index = header.find("\r\n\r\n");
-                    TEST_ASSERT_MESSAGE(body_index != std::string::npos, "failed to find body");
-
-                    /* remove header before comparison */
-                    memmove(receive_buffer, &receive_buffer[body_index + 4], result - body_index - 4);
-
-                    TEST_ASSERT_EQUAL_STRING_LEN_MESSAGE(story,
-                                                         receive_buffer,
-                                                         result - body_index - 4,
-                                                         "character mismatch");
-
-                    received_bytes += (result - body_index - 4);
-                }
-                else
-                {
-                    TEST_ASSERT_EQUAL_STRING_LEN_MESSAGE(&story[received_bytes],
-                                                         receive_buffer,
-                                                         result,
-                                                         "character mismatch");
-
-                    received_bytes += result;
+                mbed_stress_test_http_finish(&http);
+            }
+            else if (result > 0)
+            {
+                if (!received_any) {
+                    mbed_stress_test_phase_mark(&timing, MBED_STRESS_TEST_PHASE_FIRST_BYTE);
+                    received_any = true;
                 }
 
-//                receive_buffer[result] = '\0';
-//                printf("%s", receive_buffer);
-                printf("received_bytes: %u\r\n", received_bytes);
+                mbed_stress_test_http_parse(&http, receive_buffer, result);
+                printf("received_bytes: %" PRIu32 "\r\n", http.body_received);
             }
+
+            TEST_ASSERT_FALSE_MESSAGE(mbed_stress_test_http_failed(&http), "malformed HTTP response");
         }
-        while ((result > 0) && (received_bytes < expected_bytes));
+        while ((result > 0) && !mbed_stress_test_http_done(&http));
     }
 
+    TEST_ASSERT_EQUAL_INT_MESSAGE(200, http.status, "unexpected HTTP status");
+    TEST_ASSERT_EQUAL_INT_MESSAGE(sizeof(story), http.body_received, "received incorrect number of bytes");
+
+    mbed_stress_test_phase_mark(&timing, MBED_STRESS_TEST_PHASE_TRANSFER);
+    mbed_stress_test_phase_stats_add(&phase_stats, &timing);
+
+    mbed_stress_test_socket_event_detach(&event, tcpsocket);
+
     delete request;
     delete tcpsocket;
     delete[] receive_buffer;
@@ -173,6 +182,60 @@ void download(size_t size)
     printf("done\r\n");
 }
 
+/* collect body bytes, however small the pieces */
+typedef struct {
+    char data[32];
+    size_t length;
+} parsed_body_t;
+
+static void append_body(void* context, size_t offset, const char* data, size_t length)
+{
+    parsed_body_t* body = (parsed_body_t*) context;
+
+    TEST_ASSERT_EQUAL_UINT_MESSAGE(body->length, offset, "body offset out of order");
+    TEST_ASSERT_MESSAGE(offset + length <= sizeof(body->data), "body too long");
+
+    memcpy(&body->data[offset], data, length);
+    body->length += length;
+}
+
+/* a chunked response fed one byte at a time, so every header line, chunk
+ * size and chunk is split across segments
+ */
+static control_t parse_byte_by_byte(const size_t call_count)
+{
+    const char response[] =
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Type: text/plain\r\n"
+        "Transfer-Encoding: chunked\r\n"
+        "\r\n"
+        "5\r\nHello\r\n"
+        "8;name=value\r\n, chunks\r\n"
+        "0\r\n"
+        "Trailer: ignored\r\n"
+        "\r\n";
+
+    parsed_body_t body = { { 0 }, 0 };
+    mbed_stress_test_http_t http;
+    mbed_stress_test_http_init(&http, append_body, &body);
+
+    for (size_t index = 0; index < sizeof(response) - 1; index++) {
+        size_t consumed = mbed_stress_test_http_parse(&http, &response[index], 1);
+
+        TEST_ASSERT_EQUAL_UINT_MESSAGE(1, consumed, "byte not consumed");
+        TEST_ASSERT_FALSE_MESSAGE(mbed_stress_test_http_failed(&http), "malformed HTTP response");
+    }
+
+    TEST_ASSERT_TRUE_MESSAGE(mbed_stress_test_http_done(&http), "response not complete");
+    TEST_ASSERT_EQUAL_INT_MESSAGE(200, http.status, "unexpected HTTP status");
+    TEST_ASSERT_TRUE_MESSAGE(http.chunked, "chunked encoding not detected");
+    TEST_ASSERT_EQUAL_UINT_MESSAGE(13, http.body_received, "wrong body length");
+    TEST_ASSERT_EQUAL_UINT_MESSAGE(13, body.length, "wrong body length");
+    TEST_ASSERT_EQUAL_STRING_LEN_MESSAGE("Hello, chunks", body.data, 13, "wrong body");
+
+    return CaseNext;
+}
+
 static control_t setup_network(const size_t call_count)
 {
     interface = NetworkInterface::get_default_instance();
@@ -242,6 +305,58 @@ static control_t download_32k(const size_t call_count)
     return CaseNext;
 }
 
+static control_t download_phases(const size_t call_count)
+{
+    mbed_stress_test_phase_stats_init(&phase_stats);
+
+    for (uint32_t run = 0; run < PHASE_RUNS; run++) {
+        download(4*1024);
+    }
+
+    mbed_stress_test_phase_stats_report(&phase_stats);
+
+    return CaseNext;
+}
+
+static void download_verified(const mbed_stress_test_digest_t* digest, mbed_stress_test_verify_mode_t mode)
+{
+    mbed_stress_test_verify_t verify;
+    mbed_stress_test_verify_init(&verify, mode);
+
+    Timer timer;
+    timer.start();
+
+    size_t received_bytes = mbed_stress_test_download_stream(interface, digest->name, false, mbed_stress_test_verify_body, &verify);
+
+    timer.stop();
+
+    mbed_stress_test_verify_finish(&verify, digest);
+
+    printf("%s: %" PRIu32 " bytes verified by %s in %" PRIu32 " ms\r\n", digest->name,
+           (uint32_t) received_bytes, mbed_stress_test_verify_mode_name(mode), (uint32_t) std::chrono::duration_cast<std::chrono::milliseconds>(timer.elapsed_time()).count());
+}
+
+static control_t download_elizabeth_sha256(const size_t call_count)
+{
+    download_verified(&elizabeth_digest, MBED_STRESS_TEST_VERIFY_SHA256);
+
+    return CaseNext;
+}
+
+static control_t download_bogdan_sha256(const size_t call_count)
+{
+    download_verified(&bogdan_digest, MBED_STRESS_TEST_VERIFY_SHA256);
+
+    return CaseNext;
+}
+
+static control_t download_bogdan_crc32(const size_t call_count)
+{
+    download_verified(&bogdan_digest, MBED_STRESS_TEST_VERIFY_CRC32);
+
+    return CaseNext;
+}
+
 utest::v1::status_t greentea_setup(const size_t number_of_cases)
 {
     GREENTEA_SETUP(10*60, "default_auto");
@@ -249,11 +364,16 @@ utest::v1::status_t greentea_setup(const size_t number_of_cases)
 }
 
 Case cases[] = {
+    Case("Parse byte by byte", parse_byte_by_byte),
     Case("Setup network", setup_network),
     Case("Download  1k", download_1k),
     Case("Download  2k", download_2k),
     Case("Download  4k", download_4k),
     Case("Download  8k", download_8k),
+    Case("Download  4k phases", download_phases),
+    Case("Download elizabeth SHA-256", download_elizabeth_sha256),
+    Case("Download bogdan SHA-256", download_bogdan_sha256),
+    Case("Download bogdan CRC-32", download_bogdan_crc32),
 //    Case("Download 16k", download_16k),
 //    Case("Download 32k", download_32k),
 };
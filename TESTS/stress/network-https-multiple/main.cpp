@@ -32,13 +32,16 @@
 #endif
 
 #include "mbed.h"
+#include <inttypes.h>
 
 #include "utest/utest.h"
 #include "unity/unity.h"
 #include "greentea-client/test_env.h"
 #include "mbed_trace.h"
 
-#include <string>
+#include "mbed_stress_test_compare.h"
+#include "mbed_stress_test_http.h"
+#include "mbed_stress_test_network.h"
 
 using namespace utest::v1;
 
@@ -55,45 +58,24 @@ using namespace utest::v1;
 #endif
 
 #include MBED_CONF_APP_PROTAGONIST_DOWNLOAD
-#include "certificate_aws_s3.h"
-
-#warning workaroud in place for missing thread safety in mbedtls_hardware_poll
-Mutex tlsbug;
+#include MBED_CONF_APP_DOWNLOAD_CA_CERTIFICATE
 
 static uint32_t shared_thread_counter = 0;
-static volatile bool event_fired[5] = { false, false, false, false, false };
 
 NetworkInterface* interface = NULL;
 
 #define MAX_RETRIES 3
+#define SOCKET_TIMEOUT_MS 30000
 
 const char part1[] = "GET /firmware/";
 const char filename[] = MBED_CONF_APP_PROTAGONIST_DOWNLOAD;
-const char part2[] = "txt HTTP/1.1\nHost: lootbox.s3.dualstack.us-west-2.amazonaws.com\n\n";
-
-static void socket_event_0(void)
-{
-    event_fired[0] = true;
-}
-
-static void socket_event_1(void)
-{
-    event_fired[1] = true;
-}
-
-static void socket_event_2(void)
-{
-    event_fired[2] = true;
-}
-
-static void socket_event_3(void)
-{
-    event_fired[3] = true;
-}
+const char part2[] = "txt HTTP/1.1\nHost: " MBED_CONF_APP_DOWNLOAD_HOST "\n\n";
 
-static void socket_event_4(void)
+/* compare body bytes against the story as they arrive */
+static void compare_story(void* context, size_t offset, const char* data, size_t length)
 {
-    event_fired[4] = true;
+    TEST_ASSERT_MESSAGE(offset + length <= sizeof(story), "received too many bytes");
+    mbed_stress_test_assert_equal(&story[offset], data, length, offset, "character mismatch");
 }
 
 void download(void)
@@ -103,53 +85,18 @@ void download(void)
 
     uint32_t thread_id = core_util_atomic_incr_u32(&shared_thread_counter, 1) - 1;
 
-    /* setup TLS socket */
-    TLSSocket* socket = new TLSSocket();
-    TEST_ASSERT_NOT_NULL_MESSAGE(socket, "failed to instantiate socket");
-
-    result = socket->open(interface);
-    TEST_ASSERT_EQUAL_INT_MESSAGE(0, result, "failed to open socket");
-
-    result = socket->set_root_ca_cert(SSL_CA_PEM);
-    TEST_ASSERT_EQUAL_INT_MESSAGE(0, result, "failed to set root CA");
-
-    for (int tries = 0; tries < MAX_RETRIES; tries++) {
-
-        SocketAddress address;
+    /* setup TLS socket, handshakes of all threads overlap */
+    TCPSocket* transport = new TCPSocket();
+    TEST_ASSERT_NOT_NULL_MESSAGE(transport, "failed to instantiate socket");
 
-        NetworkInterface::get_default_instance()->gethostbyname("lootbox.s3.dualstack.us-west-2.amazonaws.com", &address);
-        address.set_port(443);
-
-        tlsbug.lock();
-        result = socket->connect(address);
-        TEST_ASSERT_MESSAGE(result != NSAPI_ERROR_NO_SOCKET, "out of sockets");
-        tlsbug.unlock();
-
-        if (result == NSAPI_ERROR_OK) {
-            break;
-        }
-
-        printf("%lu: connection failed: %d. retry %d of %d\r\n", thread_id, result, tries, MAX_RETRIES);
-        ThisThread::sleep_for(1s);
-    }
-    TEST_ASSERT_EQUAL_INT_MESSAGE(0, result, "failed to connect");
+    TLSSocketWrapper* socket = mbed_stress_test_tls_connect(interface, transport);
+    printf("%lu: connected\r\n", thread_id);
 
     socket->set_blocking(false);
     printf("%lu: non-blocking mode set\r\n", thread_id);
 
-    if (thread_id == 0) {
-        socket->sigio(socket_event_0);
-    } else if (thread_id == 1) {
-        socket->sigio(socket_event_1);
-    } else if (thread_id == 2) {
-        socket->sigio(socket_event_2);
-    } else if (thread_id == 3) {
-        socket->sigio(socket_event_3);
-    } else if (thread_id == 4) {
-        socket->sigio(socket_event_4);
-    } else {
-        TEST_ASSERT_MESSAGE(0, "wrong thread id");
-    }
+    mbed_stress_test_socket_event_t event;
+    mbed_stress_test_socket_event_attach(&event, socket);
     printf("%lu: registered callback function\r\n", thread_id);
 
     /* setup request */
@@ -172,19 +119,15 @@ void download(void)
     char* receive_buffer = new char[size];
     TEST_ASSERT_NOT_NULL_MESSAGE(receive_buffer, "failed to allocate receive buffer");
 
-    size_t expected_bytes = sizeof(story);
-    size_t received_bytes = 0;
-    uint32_t body_index = 0;
+    mbed_stress_test_http_t http;
+    mbed_stress_test_http_init(&http, compare_story, NULL);
 
-    /* loop until all expected bytes have been received */
-    while (received_bytes < expected_bytes) {
+    /* loop until the whole response has been parsed */
+    while (!mbed_stress_test_http_done(&http)) {
 
         /* wait for async event */
-        while(!event_fired[thread_id]) {
-
-            ThisThread::yield();
-        }
-        event_fired[thread_id] = false;
+        bool event_fired = mbed_stress_test_socket_event_wait(&event, SOCKET_TIMEOUT_MS);
+        TEST_ASSERT_TRUE_MESSAGE(event_fired, "timeout waiting for socket");
 
         /* loop until all data has been read from socket */
         do {
@@ -193,41 +136,16 @@ void download(void)
 
 //            printf("result: %d\r\n", result);
 
-            if (result > 0) {
-
-                /* skip HTTP header */
-                if (body_index == 0) {
-
-                    std::string header(receive_buffer, result);
-                    body_index = header.find("\r\n\r\n");
-                    TEST_ASSERT_MESSAGE(body_index != std::string::npos, "failed to find body");
-
-                    /* remove header before comparison */
-                    memmove(receive_buffer, &receive_buffer[body_index + 4], result - body_index - 4);
-
-                    TEST_ASSERT_EQUAL_STRING_LEN_MESSAGE(story,
-                                                         receive_buffer,
-                                                         result - body_index - 4,
-                                                         "character mismatch");
-
-                    received_bytes += (result - body_index - 4);
-
-                } else {
-
-                    TEST_ASSERT_EQUAL_STRING_LEN_MESSAGE(&story[received_bytes],
-                                                         receive_buffer,
-                                                         result,
-                                                         "character mismatch");
-
-                    received_bytes += result;
-                }
-
-//                receive_buffer[result] = '\0';
-//                printf("%s\r\n", receive_buffer);
-                printf("%lu: received_bytes: %u\r\n", thread_id, received_bytes);
+            if (result == 0) {
+                mbed_stress_test_http_finish(&http);
+            } else if (result > 0) {
+                mbed_stress_test_http_parse(&http, receive_buffer, result);
+                printf("%lu: received_bytes: %lu\r\n", thread_id, http.body_received);
             }
+
+            TEST_ASSERT_FALSE_MESSAGE(mbed_stress_test_http_failed(&http), "malformed HTTP response");
         }
-        while ((result > 0) && (received_bytes < expected_bytes));
+        while ((result > 0) && !mbed_stress_test_http_done(&http));
 
         if (result == MBEDTLS_ERR_SSL_WANT_WRITE) {
 
@@ -236,8 +154,16 @@ void download(void)
         }
     }
 
+    if (mbed_stress_test_http_done(&http)) {
+        TEST_ASSERT_EQUAL_INT_MESSAGE(200, http.status, "unexpected HTTP status");
+        TEST_ASSERT_EQUAL_INT_MESSAGE(sizeof(story), http.body_received, "received incorrect number of bytes");
+    }
+
+    mbed_stress_test_socket_event_detach(&event, socket);
+
     delete request;
     delete socket;
+    delete transport;
     delete[] receive_buffer;
 
     printf("%lu: done\r\n", thread_id);
@@ -385,6 +311,111 @@ static control_t download_5(const size_t call_count)
     return CaseNext;
 }
 
+static control_t download_multiplexed(const size_t call_count)
+{
+    /* remove .h from header file name */
+    char name[sizeof(filename)];
+    memcpy(name, filename, sizeof(filename));
+    name[sizeof(filename) - 3] = '\0';
+
+    /* every count up to the limit, stopping where the stack runs out of sockets */
+    for (uint32_t connections = 1; connections <= MBED_STRESS_TEST_MULTIPLEXER_TLS_CONNECTIONS_MAX; connections++) {
+        if (!mbed_stress_test_multiplexer_download(interface, name, connections, true, compare_story, NULL)) {
+            break;
+        }
+    }
+
+    return CaseNext;
+}
+
+static void download_2_threads(void)
+{
+    download_2(0);
+}
+
+#define CONNECT_CONTEXTS_MAX 5
+
+static Timer connect_timer;
+static uint32_t connect_done_us[CONNECT_CONTEXTS_MAX];
+
+static void connect_only(void)
+{
+    uint32_t thread_id = core_util_atomic_incr_u32(&shared_thread_counter, 1) - 1;
+
+    TCPSocket* transport = new TCPSocket();
+    TEST_ASSERT_NOT_NULL_MESSAGE(transport, "failed to instantiate socket");
+
+    TLSSocketWrapper* socket = mbed_stress_test_tls_connect(interface, transport);
+    connect_done_us[thread_id] = connect_timer.elapsed_time().count();
+
+    delete socket;
+    delete transport;
+}
+
+static control_t connect_concurrent(const size_t call_count)
+{
+    for (uint32_t contexts = 1; contexts <= CONNECT_CONTEXTS_MAX; contexts++) {
+        /* no more TLS contexts at once than the target is configured for */
+        if (contexts > MBED_CONF_APP_DOWNLOAD_TLS_CONNECTIONS_MAX) {
+            printf("contexts: %" PRIu32 " skipped, over download-tls-connections-max\r\n", contexts);
+            continue;
+        }
+
+        Thread* threads[CONNECT_CONTEXTS_MAX];
+
+        shared_thread_counter = 0;
+        connect_timer.reset();
+        connect_timer.start();
+
+        for (uint32_t index = 0; index < contexts; index++) {
+            threads[index] = new Thread(osPriorityNormal, THREAD_STACK_SIZE);
+            TEST_ASSERT_NOT_NULL_MESSAGE(threads[index], "failed to allocate thread");
+
+            threads[index]->start(connect_only);
+        }
+
+        uint32_t all_connected_us = 0;
+
+        for (uint32_t index = 0; index < contexts; index++) {
+            threads[index]->join();
+            delete threads[index];
+
+            if (connect_done_us[index] > all_connected_us) {
+                all_connected_us = connect_done_us[index];
+            }
+        }
+
+        connect_timer.stop();
+
+        printf("contexts: %" PRIu32 " time to all connected: %" PRIu32 " us\r\n", contexts, all_connected_us);
+    }
+
+    return CaseNext;
+}
+
+static control_t compare_ca_chains(const size_t call_count)
+{
+    uint32_t connections = MBED_STRESS_TEST_TLS_CA_CONNECTIONS_MAX;
+
+    /* no more TLS contexts at once than the target is configured for */
+    if (connections > MBED_CONF_APP_DOWNLOAD_TLS_CONNECTIONS_MAX) {
+        connections = MBED_CONF_APP_DOWNLOAD_TLS_CONNECTIONS_MAX;
+    }
+
+    mbed_stress_test_tls_ca_benchmark(interface, connections);
+
+    return CaseNext;
+}
+
+static control_t compare_wait_modes(const size_t call_count)
+{
+    const mbed_stress_test_wait_mode_t modes[] = { MBED_STRESS_TEST_WAIT_YIELD, MBED_STRESS_TEST_WAIT_EVENT };
+
+    mbed_stress_test_compare_wait_modes(download_2_threads, 2 * sizeof(story), modes, sizeof(modes) / sizeof(modes[0]));
+
+    return CaseNext;
+}
+
 utest::v1::status_t greentea_setup(const size_t number_of_cases)
 {
     GREENTEA_SETUP(10*60, "default_auto");
@@ -395,6 +426,10 @@ Case cases[] = {
     Case("Setup network", setup_network),
     Case("Download 1 thread",  download_1),
     Case("Download 2 threads", download_2),
+    Case("Compare wait modes", compare_wait_modes),
+    Case("Download multiplexed", download_multiplexed),
+    Case("Compare root CA chains", compare_ca_chains),
+    Case("Connect 1-5 contexts", connect_concurrent),
 //    Case("Download 3 threads", download_3),
 //    Case("Download 4 threads", download_4),
 //    Case("Download 5 threads", download_5),
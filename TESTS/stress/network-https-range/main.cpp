@@ -28,11 +28,14 @@
 #endif
 
 #include "mbed.h"
+#include <inttypes.h>
 
 #include "utest/utest.h"
 #include "unity/unity.h"
 #include "greentea-client/test_env.h"
 
+#include "mbed_stress_test_compare.h"
+#include "mbed_stress_test_generator.h"
 #include "mbed_stress_test_network.h"
 
 using namespace utest::v1;
@@ -42,9 +45,15 @@ using namespace utest::v1;
 NetworkInterface* interface = NULL;
 
 #define MAX_RETRIES 3
+#define PIPELINE_WINDOW (32 * 1024)
+#define GENERATED_SEED 1
+#define GENERATED_STREAM_LENGTH (4 * 1024 * 1024)
+#define GENERATED_LENGTH (1024 * 1024 * 1024)
 
 char filename[] = MBED_CONF_APP_PROTAGONIST_DOWNLOAD;
 
+static mbed_stress_test_phase_stats_t phase_stats;
+
 void download(size_t size)
 {
     /* remove .h from header file name */
@@ -64,12 +73,13 @@ void download(size_t size)
             actual_bytes = size;
         }
 
-        size_t received_bytes = mbed_stress_test_download(interface, filename, offset, buffer, actual_bytes, true);
+        mbed_stress_test_phase_timing_t timing;
+
+        size_t received_bytes = mbed_stress_test_download_timed(interface, filename, offset, buffer, actual_bytes, true, &timing);
         TEST_ASSERT_EQUAL_INT_MESSAGE(actual_bytes, received_bytes, "received incorrect number of bytes");
-        TEST_ASSERT_EQUAL_STRING_LEN_MESSAGE(&story[offset],
-                                             buffer,
-                                             actual_bytes,
-                                             "character mismatch");
+        mbed_stress_test_assert_equal(&story[offset], buffer, actual_bytes, offset, "character mismatch");
+
+        mbed_stress_test_phase_stats_add(&phase_stats, &timing);
 
         offset += received_bytes;
     }
@@ -77,6 +87,78 @@ void download(size_t size)
     delete buffer;
 }
 
+void download_keep_alive(size_t size)
+{
+    /* remove .h from header file name */
+    size_t filename_size = sizeof(filename);
+    filename[filename_size - 3] = '\0';
+
+    char* buffer = new char[size];
+
+    mbed_stress_test_connection_t connection;
+    mbed_stress_test_connection_open(&connection, interface, true);
+
+    size_t offset = 0;
+
+    while (offset < sizeof(story))
+    {
+        size_t actual_bytes = sizeof(story) - offset;
+
+        if (actual_bytes > size)
+        {
+            actual_bytes = size;
+        }
+
+        size_t received_bytes = mbed_stress_test_connection_download(&connection, filename, offset, buffer, actual_bytes);
+        TEST_ASSERT_EQUAL_INT_MESSAGE(actual_bytes, received_bytes, "received incorrect number of bytes");
+        mbed_stress_test_assert_equal(&story[offset], buffer, actual_bytes, offset, "character mismatch");
+
+        offset += received_bytes;
+    }
+
+    mbed_stress_test_connection_report(&connection);
+    mbed_stress_test_connection_close(&connection);
+
+    delete[] buffer;
+}
+
+void download_pipelined(size_t size, uint32_t depth)
+{
+    /* remove .h from header file name */
+    size_t filename_size = sizeof(filename);
+    filename[filename_size - 3] = '\0';
+
+    /* requests stay in flight within one window */
+    char* buffer = new char[PIPELINE_WINDOW];
+
+    mbed_stress_test_connection_t connection;
+    mbed_stress_test_connection_open(&connection, interface, true);
+
+    size_t offset = 0;
+
+    while (offset < sizeof(story))
+    {
+        size_t actual_bytes = sizeof(story) - offset;
+
+        if (actual_bytes > PIPELINE_WINDOW)
+        {
+            actual_bytes = PIPELINE_WINDOW;
+        }
+
+        size_t received_bytes = mbed_stress_test_connection_download_pipelined(&connection, filename, offset, buffer, actual_bytes, size, depth);
+        TEST_ASSERT_EQUAL_INT_MESSAGE(actual_bytes, received_bytes, "received incorrect number of bytes");
+        mbed_stress_test_assert_equal(&story[offset], buffer, actual_bytes, offset, "character mismatch");
+
+        offset += received_bytes;
+    }
+
+    printf("pipeline depth: %" PRIu32 "\r\n", depth);
+    mbed_stress_test_connection_report(&connection);
+    mbed_stress_test_connection_close(&connection);
+
+    delete[] buffer;
+}
+
 static control_t setup_network(const size_t call_count)
 {
     interface = NetworkInterface::get_default_instance();
@@ -146,6 +228,176 @@ static control_t download_32k(const size_t call_count)
     return CaseNext;
 }
 
+/* every range is a connection of its own, timed phase by phase */
+static control_t download_8k_phases(const size_t call_count)
+{
+    mbed_stress_test_phase_stats_init(&phase_stats);
+
+    download(8*1024);
+
+    mbed_stress_test_phase_stats_report(&phase_stats);
+
+    return CaseNext;
+}
+
+/* the same ranges with every lookup sent to the network, then cached */
+static control_t download_8k_dns_cache(const size_t call_count)
+{
+    uint32_t dns_median_us[2];
+
+    for (uint32_t cached = 0; cached < 2; cached++) {
+        mbed_stress_test_dns_cache_enabled = cached;
+        mbed_stress_test_dns_cache_clear();
+        mbed_stress_test_phase_stats_init(&phase_stats);
+
+        download(8*1024);
+
+        mbed_stress_test_dns_stats_t dns;
+        mbed_stress_test_dns_cache_stats(&dns);
+
+        dns_median_us[cached] = mbed_stress_test_phase_stats_percentile(&phase_stats, MBED_STRESS_TEST_PHASE_DNS, 50);
+
+        printf("dns cache: %s hits: %" PRIu32 " misses: %" PRIu32 " lookup median: %" PRIu32 " us\r\n",
+               cached ? "on" : "off", dns.hits, dns.misses, dns_median_us[cached]);
+
+        if (cached) {
+            TEST_ASSERT_EQUAL_INT_MESSAGE(1, dns.misses, "cached lookups went to the network");
+        }
+    }
+
+    mbed_stress_test_dns_cache_enabled = true;
+
+    int32_t saving_us = (int32_t) dns_median_us[0] - (int32_t) dns_median_us[1];
+
+    printf("dns cache saving per chunk: %" PRId32 " us\r\n", saving_us);
+    greentea_send_kv("dns_cache_saving_us", (int) saving_us);
+
+    return CaseNext;
+}
+
+#if MBED_CONF_APP_DOWNLOAD_GENERATED
+/* a stream no image could hold a copy of, checked as it arrives */
+static control_t download_generated(const size_t call_count)
+{
+    char name[MBED_STRESS_TEST_GENERATED_NAME_SIZE];
+    uint32_t seed = GENERATED_SEED;
+
+    mbed_stress_test_generated_name(name, sizeof(name), seed, GENERATED_STREAM_LENGTH);
+
+    size_t received_bytes = mbed_stress_test_download_stream(interface, name, true, mbed_stress_test_generated_body, &seed);
+    TEST_ASSERT_EQUAL_INT_MESSAGE(GENERATED_STREAM_LENGTH, received_bytes, "received incorrect number of bytes");
+
+    /* any range of a gigabyte stream is computed on its own, at both ends */
+    const size_t offsets[] = { 0, GENERATED_LENGTH / 2 + 3, GENERATED_LENGTH - 8*1024 };
+    char* buffer = new char[8*1024];
+
+    mbed_stress_test_generated_name(name, sizeof(name), seed, GENERATED_LENGTH);
+
+    for (size_t index = 0; index < sizeof(offsets) / sizeof(offsets[0]); index++) {
+        received_bytes = mbed_stress_test_download(interface, name, offsets[index], buffer, 8*1024, true);
+        TEST_ASSERT_EQUAL_INT_MESSAGE(8*1024, received_bytes, "received incorrect number of bytes");
+
+        mbed_stress_test_generated_body(&seed, offsets[index], buffer, received_bytes);
+    }
+
+    delete[] buffer;
+
+    return CaseNext;
+}
+#endif
+
+static control_t download_1k_keep_alive(const size_t call_count)
+{
+    download_keep_alive(1024);
+
+    return CaseNext;
+}
+
+static control_t download_8k_keep_alive(const size_t call_count)
+{
+    download_keep_alive(8*1024);
+
+    return CaseNext;
+}
+
+static control_t download_8k_resumed(const size_t call_count)
+{
+    mbed_stress_test_tls_session_t session;
+    mbed_stress_test_tls_session_init(&session, true);
+
+    /* every range request is a new connection, all but the first resume */
+    mbed_stress_test_tls_session = &session;
+    download(8*1024);
+    mbed_stress_test_tls_session = NULL;
+
+    printf("handshakes full: %" PRIu32 " resumed: %" PRIu32 "\r\n", session.full, session.resumed);
+
+    mbed_stress_test_tls_session_free(&session);
+
+    return CaseNext;
+}
+
+static control_t tls_handshakes(const size_t call_count)
+{
+    mbed_stress_test_tls_benchmark(interface, 10);
+
+    return CaseNext;
+}
+
+static uint32_t segment_bytes = 0;
+
+/* segments arrive out of order, from several threads */
+static void compare_segment(void* context, size_t offset, const char* data, size_t length)
+{
+    TEST_ASSERT_MESSAGE(offset + length <= sizeof(story), "segment out of bounds");
+    mbed_stress_test_assert_equal(&story[offset], data, length, offset, "character mismatch");
+
+    core_util_atomic_incr_u32(&segment_bytes, length);
+}
+
+static control_t download_segmented(const size_t call_count)
+{
+    /* remove .h from header file name */
+    size_t filename_size = sizeof(filename);
+    filename[filename_size - 3] = '\0';
+
+    /* no more sockets at once than the target is configured for */
+    for (uint32_t connections = 1; (connections <= MBED_STRESS_TEST_SEGMENTED_CONNECTIONS_MAX) && (connections <= MBED_CONF_APP_DOWNLOAD_TLS_CONNECTIONS_MAX); connections *= 2) {
+        segment_bytes = 0;
+
+        uint32_t elapsed_ms = mbed_stress_test_segmented_download(interface, filename, sizeof(story), connections, true,
+                                                                  4*1024, compare_segment, NULL);
+        TEST_ASSERT_EQUAL_INT_MESSAGE(sizeof(story), segment_bytes, "received incorrect number of bytes");
+
+        printf("connections: %" PRIu32 " time: %" PRIu32 " ms\r\n", connections, elapsed_ms);
+    }
+
+    return CaseNext;
+}
+
+static control_t download_1k_pipelined(const size_t call_count)
+{
+    for (uint32_t depth = 1; depth <= MBED_STRESS_TEST_PIPELINE_DEPTH_MAX; depth *= 2) {
+        download_pipelined(1024, depth);
+    }
+
+    return CaseNext;
+}
+
+static void download_32k_run(void)
+{
+    download(32*1024);
+}
+
+static control_t compare_wait_modes(const size_t call_count)
+{
+    const mbed_stress_test_wait_mode_t modes[] = { MBED_STRESS_TEST_WAIT_SLEEP, MBED_STRESS_TEST_WAIT_EVENT };
+
+    mbed_stress_test_compare_wait_modes(download_32k_run, sizeof(story), modes, sizeof(modes) / sizeof(modes[0]));
+
+    return CaseNext;
+}
+
 utest::v1::status_t greentea_setup(const size_t number_of_cases)
 {
     GREENTEA_SETUP(10*60, "default_auto");
@@ -158,8 +410,20 @@ Case cases[] = {
 //    Case("Download  2k", download_2k),
 //    Case("Download  4k", download_4k),
     Case("Download  8k", download_8k),
+    Case("Download  8k phases", download_8k_phases),
+    Case("Download  8k DNS cache", download_8k_dns_cache),
+#if MBED_CONF_APP_DOWNLOAD_GENERATED
+    Case("Download generated", download_generated),
+#endif
 //    Case("Download 16k", download_16k),
 //    Case("Download 32k", download_32k),
+    Case("Compare wait modes", compare_wait_modes),
+    Case("Download  1k keep-alive", download_1k_keep_alive),
+    Case("Download  8k keep-alive", download_8k_keep_alive),
+    Case("Download  1k pipelined", download_1k_pipelined),
+    Case("Download segmented", download_segmented),
+    Case("Download  8k resumed", download_8k_resumed),
+    Case("TLS handshakes", tls_handshakes),
 };
 
 Specification specification(greentea_setup, cases);
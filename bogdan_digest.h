@@ -0,0 +1,22 @@
+/*
+    Length and digests of bogdan.txt, for the tests that verify a download
+    as it streams in instead of comparing it against the data in flash.
+
+    Regenerate after changing bogdan.txt:
+        sha256sum bogdan.txt
+        python3 -c "import zlib; print(hex(zlib.crc32(open('bogdan.txt', 'rb').read())))"
+*/
+
+#include "mbed_stress_test_verify.h"
+
+const mbed_stress_test_digest_t bogdan_digest = {
+    "bogdan",
+    867175,
+    {
+        0x27, 0x11, 0xEC, 0x11, 0x1E, 0x71, 0xE5, 0xD4,
+        0xA9, 0xB8, 0x52, 0xD1, 0x86, 0x2C, 0x1A, 0x57,
+        0x59, 0x22, 0x03, 0xEE, 0x1B, 0x19, 0xF2, 0x3C,
+        0xEC, 0xFA, 0x5E, 0x73, 0x81, 0x54, 0x48, 0x7F
+    },
+    0x47373175
+};
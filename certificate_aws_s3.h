@@ -30,4 +30,102 @@ const char SSL_CA_PEM[] =
     "upcHi9nzBhDFKdT3uhaQqNBU4UtJx5g=\n"
     "-----END CERTIFICATE-----\n";
 
+/* the same chain in DER, parsed once into the shared chain of mbed_stress_test_tls_ca_chain() */
+const unsigned char SSL_CA_DER[] = {
+    0x30, 0x82, 0x04, 0x63, 0x30, 0x82, 0x03, 0x4b, 0xa0, 0x03, 0x02, 0x01,
+    0x02, 0x02, 0x10, 0x01, 0x82, 0xf8, 0x09, 0x8e, 0xa2, 0xe6, 0x26, 0xb9,
+    0x1a, 0x3b, 0x27, 0x84, 0x1f, 0xb9, 0xaf, 0x30, 0x0d, 0x06, 0x09, 0x2a,
+    0x86, 0x48, 0x86, 0xf7, 0x0d, 0x01, 0x01, 0x0b, 0x05, 0x00, 0x30, 0x5a,
+    0x31, 0x0b, 0x30, 0x09, 0x06, 0x03, 0x55, 0x04, 0x06, 0x13, 0x02, 0x49,
+    0x45, 0x31, 0x12, 0x30, 0x10, 0x06, 0x03, 0x55, 0x04, 0x0a, 0x13, 0x09,
+    0x42, 0x61, 0x6c, 0x74, 0x69, 0x6d, 0x6f, 0x72, 0x65, 0x31, 0x13, 0x30,
+    0x11, 0x06, 0x03, 0x55, 0x04, 0x0b, 0x13, 0x0a, 0x43, 0x79, 0x62, 0x65,
+    0x72, 0x54, 0x72, 0x75, 0x73, 0x74, 0x31, 0x22, 0x30, 0x20, 0x06, 0x03,
+    0x55, 0x04, 0x03, 0x13, 0x19, 0x42, 0x61, 0x6c, 0x74, 0x69, 0x6d, 0x6f,
+    0x72, 0x65, 0x20, 0x43, 0x79, 0x62, 0x65, 0x72, 0x54, 0x72, 0x75, 0x73,
+    0x74, 0x20, 0x52, 0x6f, 0x6f, 0x74, 0x30, 0x1e, 0x17, 0x0d, 0x31, 0x35,
+    0x31, 0x32, 0x30, 0x38, 0x31, 0x32, 0x30, 0x35, 0x30, 0x37, 0x5a, 0x17,
+    0x0d, 0x32, 0x35, 0x30, 0x35, 0x31, 0x30, 0x31, 0x32, 0x30, 0x30, 0x30,
+    0x30, 0x5a, 0x30, 0x64, 0x31, 0x0b, 0x30, 0x09, 0x06, 0x03, 0x55, 0x04,
+    0x06, 0x13, 0x02, 0x55, 0x53, 0x31, 0x15, 0x30, 0x13, 0x06, 0x03, 0x55,
+    0x04, 0x0a, 0x13, 0x0c, 0x44, 0x69, 0x67, 0x69, 0x43, 0x65, 0x72, 0x74,
+    0x20, 0x49, 0x6e, 0x63, 0x31, 0x19, 0x30, 0x17, 0x06, 0x03, 0x55, 0x04,
+    0x0b, 0x13, 0x10, 0x77, 0x77, 0x77, 0x2e, 0x64, 0x69, 0x67, 0x69, 0x63,
+    0x65, 0x72, 0x74, 0x2e, 0x63, 0x6f, 0x6d, 0x31, 0x23, 0x30, 0x21, 0x06,
+    0x03, 0x55, 0x04, 0x03, 0x13, 0x1a, 0x44, 0x69, 0x67, 0x69, 0x43, 0x65,
+    0x72, 0x74, 0x20, 0x42, 0x61, 0x6c, 0x74, 0x69, 0x6d, 0x6f, 0x72, 0x65,
+    0x20, 0x43, 0x41, 0x2d, 0x32, 0x20, 0x47, 0x32, 0x30, 0x82, 0x01, 0x22,
+    0x30, 0x0d, 0x06, 0x09, 0x2a, 0x86, 0x48, 0x86, 0xf7, 0x0d, 0x01, 0x01,
+    0x01, 0x05, 0x00, 0x03, 0x82, 0x01, 0x0f, 0x00, 0x30, 0x82, 0x01, 0x0a,
+    0x02, 0x82, 0x01, 0x01, 0x00, 0xbb, 0xe7, 0x00, 0xfe, 0x00, 0x01, 0x73,
+    0xef, 0x9b, 0x88, 0xf0, 0x5c, 0x08, 0x75, 0xf0, 0x5c, 0x70, 0x73, 0x1f,
+    0xff, 0xb5, 0x7a, 0x1f, 0x8d, 0x08, 0x23, 0xfd, 0xc7, 0xc1, 0x13, 0x3f,
+    0xb1, 0x21, 0x06, 0xbd, 0x4d, 0xcc, 0xdb, 0x2d, 0xb8, 0x87, 0x19, 0x31,
+    0xde, 0xda, 0x6b, 0x0d, 0xc1, 0x5d, 0xd2, 0x51, 0xd5, 0xb0, 0x5e, 0x72,
+    0xd4, 0xf0, 0x66, 0xd4, 0x84, 0xf2, 0x91, 0x18, 0x41, 0xb5, 0x09, 0x26,
+    0xb2, 0x03, 0x96, 0x04, 0x69, 0x95, 0x53, 0xfa, 0x07, 0x4f, 0x3e, 0xbe,
+    0x86, 0x3a, 0x43, 0x2b, 0xb2, 0x59, 0xb5, 0xab, 0xd1, 0xba, 0xf4, 0x59,
+    0x40, 0x72, 0x5a, 0x67, 0xb6, 0xcd, 0xe6, 0x55, 0xfc, 0x09, 0x2b, 0xa4,
+    0x98, 0xb2, 0xbf, 0xcc, 0xa9, 0x1f, 0xd4, 0xbf, 0x87, 0x8f, 0x82, 0x25,
+    0xfd, 0x45, 0x80, 0xa9, 0xec, 0x9d, 0x8c, 0xf9, 0x74, 0x90, 0xcf, 0x1c,
+    0xf8, 0x65, 0x50, 0xaf, 0xcd, 0xf8, 0x45, 0xab, 0xc8, 0x2f, 0x8d, 0x8e,
+    0x36, 0x1d, 0xde, 0xea, 0x89, 0xcd, 0xb2, 0x52, 0xd9, 0xe5, 0x09, 0xcd,
+    0x36, 0x71, 0x2b, 0xda, 0xc6, 0xd0, 0x9b, 0xc6, 0xf6, 0xa4, 0x5b, 0x5b,
+    0x39, 0xb6, 0x1f, 0x00, 0x1f, 0x19, 0xa4, 0xfb, 0xd3, 0xbe, 0x0c, 0xe6,
+    0xfb, 0x8f, 0xdd, 0x0e, 0x80, 0xe6, 0xa4, 0xe7, 0x5a, 0xc4, 0xc0, 0x2f,
+    0x72, 0xee, 0x91, 0xf3, 0x83, 0x67, 0xc9, 0xcd, 0xca, 0xce, 0x4a, 0xb0,
+    0x20, 0x81, 0xfd, 0xe4, 0x72, 0xaf, 0x09, 0x18, 0xe7, 0x4f, 0x42, 0xec,
+    0x4d, 0x27, 0x42, 0x4d, 0x07, 0xa0, 0xdd, 0xd5, 0x0d, 0x75, 0xf7, 0x36,
+    0x60, 0xcc, 0x26, 0x54, 0x98, 0xa1, 0x88, 0x37, 0xf0, 0x83, 0xf7, 0xad,
+    0x29, 0x59, 0x20, 0xcf, 0xbb, 0x25, 0xe1, 0xd5, 0x9e, 0xe6, 0xf3, 0xae,
+    0xc1, 0x01, 0xeb, 0xb5, 0x06, 0x89, 0xe2, 0x0a, 0x8f, 0x02, 0x03, 0x01,
+    0x00, 0x01, 0xa3, 0x82, 0x01, 0x19, 0x30, 0x82, 0x01, 0x15, 0x30, 0x1d,
+    0x06, 0x03, 0x55, 0x1d, 0x0e, 0x04, 0x16, 0x04, 0x14, 0xc0, 0x12, 0xb2,
+    0x28, 0x74, 0x68, 0x46, 0x67, 0xe9, 0x70, 0x25, 0x74, 0x1a, 0x00, 0x45,
+    0x5b, 0x06, 0x7d, 0x5c, 0x44, 0x30, 0x1f, 0x06, 0x03, 0x55, 0x1d, 0x23,
+    0x04, 0x18, 0x30, 0x16, 0x80, 0x14, 0xe5, 0x9d, 0x59, 0x30, 0x82, 0x47,
+    0x58, 0xcc, 0xac, 0xfa, 0x08, 0x54, 0x36, 0x86, 0x7b, 0x3a, 0xb5, 0x04,
+    0x4d, 0xf0, 0x30, 0x12, 0x06, 0x03, 0x55, 0x1d, 0x13, 0x01, 0x01, 0xff,
+    0x04, 0x08, 0x30, 0x06, 0x01, 0x01, 0xff, 0x02, 0x01, 0x00, 0x30, 0x0e,
+    0x06, 0x03, 0x55, 0x1d, 0x0f, 0x01, 0x01, 0xff, 0x04, 0x04, 0x03, 0x02,
+    0x01, 0x86, 0x30, 0x34, 0x06, 0x08, 0x2b, 0x06, 0x01, 0x05, 0x05, 0x07,
+    0x01, 0x01, 0x04, 0x28, 0x30, 0x26, 0x30, 0x24, 0x06, 0x08, 0x2b, 0x06,
+    0x01, 0x05, 0x05, 0x07, 0x30, 0x01, 0x86, 0x18, 0x68, 0x74, 0x74, 0x70,
+    0x3a, 0x2f, 0x2f, 0x6f, 0x63, 0x73, 0x70, 0x2e, 0x64, 0x69, 0x67, 0x69,
+    0x63, 0x65, 0x72, 0x74, 0x2e, 0x63, 0x6f, 0x6d, 0x30, 0x3a, 0x06, 0x03,
+    0x55, 0x1d, 0x1f, 0x04, 0x33, 0x30, 0x31, 0x30, 0x2f, 0xa0, 0x2d, 0xa0,
+    0x2b, 0x86, 0x29, 0x68, 0x74, 0x74, 0x70, 0x3a, 0x2f, 0x2f, 0x63, 0x72,
+    0x6c, 0x33, 0x2e, 0x64, 0x69, 0x67, 0x69, 0x63, 0x65, 0x72, 0x74, 0x2e,
+    0x63, 0x6f, 0x6d, 0x2f, 0x4f, 0x6d, 0x6e, 0x69, 0x72, 0x6f, 0x6f, 0x74,
+    0x32, 0x30, 0x32, 0x35, 0x2e, 0x63, 0x72, 0x6c, 0x30, 0x3d, 0x06, 0x03,
+    0x55, 0x1d, 0x20, 0x04, 0x36, 0x30, 0x34, 0x30, 0x32, 0x06, 0x04, 0x55,
+    0x1d, 0x20, 0x00, 0x30, 0x2a, 0x30, 0x28, 0x06, 0x08, 0x2b, 0x06, 0x01,
+    0x05, 0x05, 0x07, 0x02, 0x01, 0x16, 0x1c, 0x68, 0x74, 0x74, 0x70, 0x73,
+    0x3a, 0x2f, 0x2f, 0x77, 0x77, 0x77, 0x2e, 0x64, 0x69, 0x67, 0x69, 0x63,
+    0x65, 0x72, 0x74, 0x2e, 0x63, 0x6f, 0x6d, 0x2f, 0x43, 0x50, 0x53, 0x30,
+    0x0d, 0x06, 0x09, 0x2a, 0x86, 0x48, 0x86, 0xf7, 0x0d, 0x01, 0x01, 0x0b,
+    0x05, 0x00, 0x03, 0x82, 0x01, 0x01, 0x00, 0x2f, 0xe2, 0x37, 0x66, 0xc3,
+    0x1a, 0xcf, 0x91, 0x55, 0xee, 0x29, 0x14, 0xfa, 0x50, 0x10, 0xbe, 0x99,
+    0x8d, 0xe2, 0x28, 0xf1, 0x74, 0x16, 0x07, 0x69, 0x3b, 0x44, 0x30, 0x3d,
+    0xf5, 0xb9, 0x49, 0xf5, 0x68, 0x36, 0xfe, 0xb7, 0x30, 0x8d, 0xa9, 0xe0,
+    0x07, 0x49, 0x42, 0x63, 0x46, 0x52, 0xb5, 0x69, 0xc6, 0x9b, 0x49, 0xf2,
+    0x1a, 0x0f, 0x57, 0xc6, 0xf6, 0xb7, 0xbe, 0xab, 0x75, 0x8d, 0x0d, 0xa2,
+    0xab, 0x33, 0xe4, 0x62, 0x85, 0x43, 0x54, 0xab, 0x63, 0x94, 0x0c, 0xa3,
+    0x53, 0xa0, 0xea, 0x1d, 0xe4, 0xa6, 0xa6, 0xac, 0x95, 0x0e, 0x65, 0x78,
+    0xec, 0x33, 0x8c, 0xbe, 0x94, 0x3e, 0xd8, 0x70, 0xab, 0xea, 0xc7, 0xe1,
+    0x78, 0xce, 0x33, 0x95, 0xbb, 0xfb, 0x2c, 0x58, 0xe0, 0x8a, 0x40, 0xa6,
+    0x6d, 0x41, 0xd8, 0xd8, 0xd9, 0xb3, 0xf9, 0x2f, 0x02, 0xc5, 0x1b, 0x70,
+    0x6b, 0xe2, 0x3a, 0x85, 0x7b, 0x1d, 0x18, 0xb0, 0xd1, 0x4b, 0x9a, 0xc1,
+    0x6f, 0x17, 0x10, 0x29, 0xe8, 0x0e, 0xc3, 0xe1, 0x54, 0x96, 0x54, 0xa5,
+    0x91, 0x95, 0x08, 0x20, 0x8d, 0x69, 0x2c, 0x9e, 0x2f, 0x3f, 0x50, 0xb4,
+    0x2e, 0xe5, 0x57, 0x1f, 0xaf, 0xa4, 0x73, 0xd2, 0xa1, 0x24, 0xbb, 0x0d,
+    0x90, 0xfe, 0x45, 0x13, 0x1d, 0xa7, 0xa1, 0x29, 0xd8, 0x66, 0x0b, 0xc3,
+    0xd1, 0x6c, 0xb3, 0x4f, 0xb4, 0x2b, 0x84, 0x4c, 0x47, 0x90, 0xec, 0x8b,
+    0xe2, 0x41, 0x89, 0x13, 0xb6, 0x07, 0x46, 0x77, 0x42, 0xfd, 0xbb, 0x1e,
+    0x17, 0xfa, 0xff, 0x25, 0x4b, 0x8e, 0x50, 0x57, 0xeb, 0x8e, 0xcc, 0x4e,
+    0x15, 0x3f, 0xb1, 0x25, 0xdd, 0x41, 0x0c, 0xa0, 0x9c, 0x62, 0x6d, 0x6f,
+    0xba, 0x97, 0x07, 0x8b, 0xd9, 0xf3, 0x06, 0x10, 0xc5, 0x29, 0xd4, 0xf7,
+    0xba, 0x16, 0x90, 0xa8, 0xd0, 0x54, 0xe1, 0x4b, 0x49, 0xc7, 0x98
+};
+
 #endif
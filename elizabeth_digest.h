@@ -0,0 +1,22 @@
+/*
+    Length and digests of elizabeth.txt, for the tests that verify a download
+    as it streams in instead of comparing it against the data in flash.
+
+    Regenerate after changing elizabeth.txt:
+        sha256sum elizabeth.txt
+        python3 -c "import zlib; print(hex(zlib.crc32(open('elizabeth.txt', 'rb').read())))"
+*/
+
+#include "mbed_stress_test_verify.h"
+
+const mbed_stress_test_digest_t elizabeth_digest = {
+    "elizabeth",
+    712796,
+    {
+        0x4F, 0xD5, 0xC3, 0xB6, 0x88, 0xAA, 0x26, 0x6D,
+        0x75, 0x9E, 0xD4, 0x44, 0xD3, 0xBA, 0x9E, 0xF4,
+        0xE0, 0x6B, 0x5B, 0x6B, 0x12, 0xD9, 0xF2, 0x7F,
+        0x41, 0x9D, 0xBE, 0x72, 0xA8, 0xE3, 0x5A, 0x68
+    },
+    0x19C1895E
+};
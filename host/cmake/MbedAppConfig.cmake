@@ -0,0 +1,76 @@
+# Turn the "config" section of mbed_app.json into MBED_CONF_APP_* macros, the
+# way mbed-cli does for a target: defaults first, then the "*" overrides, then
+# the overrides for the given target name.
+
+function(_mbed_app_config_value json out)
+    string(JSON type ERROR_VARIABLE error TYPE "${json}" ${ARGN})
+    if(error)
+        set(${out} "" PARENT_SCOPE)
+        return()
+    endif()
+
+    string(JSON value GET "${json}" ${ARGN})
+
+    if(type STREQUAL "BOOLEAN")
+        if(value)
+            set(value 1)
+        else()
+            set(value 0)
+        endif()
+    endif()
+
+    set(${out} "${value}" PARENT_SCOPE)
+endfunction()
+
+function(_mbed_app_config_macro name out)
+    string(TOUPPER "${name}" name)
+    string(REPLACE "-" "_" name "${name}")
+    set(${out} "MBED_CONF_APP_${name}" PARENT_SCOPE)
+endfunction()
+
+function(mbed_app_config file target out)
+    file(READ "${file}" json)
+
+    set(names "")
+
+    string(JSON count ERROR_VARIABLE error LENGTH "${json}" config)
+    if(NOT error AND count GREATER 0)
+        math(EXPR last "${count} - 1")
+        foreach(index RANGE ${last})
+            string(JSON name MEMBER "${json}" config ${index})
+            _mbed_app_config_value("${json}" value config ${name} value)
+            list(APPEND names ${name})
+            set(config_${name} "${value}")
+        endforeach()
+    endif()
+
+    foreach(section "*" ${target})
+        string(JSON count ERROR_VARIABLE error LENGTH "${json}" target_overrides ${section})
+        if(error OR count EQUAL 0)
+            continue()
+        endif()
+
+        math(EXPR last "${count} - 1")
+        foreach(index RANGE ${last})
+            string(JSON key MEMBER "${json}" target_overrides ${section} ${index})
+            if(key MATCHES "^app\\.(.+)$")
+                set(name ${CMAKE_MATCH_1})
+                _mbed_app_config_value("${json}" value target_overrides ${section} ${key})
+                list(APPEND names ${name})
+                set(config_${name} "${value}")
+            endif()
+        endforeach()
+    endforeach()
+
+    list(REMOVE_DUPLICATES names)
+
+    set(definitions "")
+    foreach(name ${names})
+        if(NOT "${config_${name}}" STREQUAL "")
+            _mbed_app_config_macro(${name} macro)
+            list(APPEND definitions "${macro}=${config_${name}}")
+        endif()
+    endforeach()
+
+    set(${out} "${definitions}" PARENT_SCOPE)
+endfunction()
@@ -0,0 +1,75 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2016 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MBED_HOST_FLASHIAP_H
+#define MBED_HOST_FLASHIAP_H
+
+#include <stdint.h>
+
+#define MBED_FLASH_INVALID_SIZE     0xFFFFFFFF
+
+namespace mbed {
+
+/** Host FlashIAP backed by a memory mapped file.
+ *
+ *  All FlashIAP instances share one emulated flash device. The geometry is
+ *  taken from the environment the first time any instance is initialized:
+ *
+ *  - MBED_HOST_FLASH_FILE:     backing file (default: flash.bin)
+ *  - MBED_HOST_FLASH_START:    start address (default: 0)
+ *  - MBED_HOST_FLASH_SIZE:     total size (default: 1M)
+ *  - MBED_HOST_FLASH_PAGE:     program unit (default: 8)
+ *  - MBED_HOST_FLASH_SECTORS:  sector layout as a comma separated list of
+ *                              count*size regions, e.g. "4*16K,1*64K,7*128K"
+ *                              (default: uniform 4K sectors)
+ *  - MBED_HOST_FLASH_ERASE_US: erase time per KiB in microseconds (default: 0)
+ *  - MBED_HOST_FLASH_PROGRAM_US: program time per KiB in microseconds (default: 0)
+ *  - MBED_HOST_FLASH_ENDURANCE: rated erase cycles per sector (default: 0,
+ *                              no wear). Erase and program times grow with
+ *                              each sector's erase count, and past the
+ *                              rating programming starts dropping bits.
+ *                              Erase counts are kept in <file>.wear.
+ *
+ *  Program and erase follow NOR flash rules: addresses and sizes must be
+ *  page or sector aligned, and programming can only clear bits.
+ */
+class FlashIAP {
+public:
+    FlashIAP();
+    ~FlashIAP();
+
+    int init();
+    int deinit();
+
+    int read(void* buffer, uint32_t addr, uint32_t size);
+    int program(const void* buffer, uint32_t addr, uint32_t size);
+    int erase(uint32_t addr, uint32_t size);
+
+    uint32_t get_sector_size(uint32_t addr) const;
+    uint32_t get_flash_start() const;
+    uint32_t get_flash_size() const;
+    uint32_t get_page_size() const;
+    uint8_t get_erase_value() const;
+
+    /** Where addr is mapped on the host, the way internal flash is mapped
+     *  at its own address on target. NULL before init or out of range.
+     */
+    const void* host_address(uint32_t addr) const;
+};
+
+} // namespace mbed
+
+#endif
@@ -0,0 +1,101 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2016 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MBED_HOST_TIMER_H
+#define MBED_HOST_TIMER_H
+
+#include "platform/mbed_toolchain.h"
+
+#include <stdint.h>
+
+#include <chrono>
+
+namespace mbed {
+
+/** Microsecond stopwatch with the mbed OS Timer interface. */
+class Timer {
+public:
+    Timer()
+        : _running(false),
+          _elapsed(0)
+    {
+    }
+
+    void start()
+    {
+        if (!_running) {
+            _start = std::chrono::steady_clock::now();
+            _running = true;
+        }
+    }
+
+    void stop()
+    {
+        if (_running) {
+            _elapsed += since_start();
+            _running = false;
+        }
+    }
+
+    void reset()
+    {
+        _elapsed = std::chrono::microseconds(0);
+        _start = std::chrono::steady_clock::now();
+    }
+
+    std::chrono::microseconds elapsed_time() const
+    {
+        return _running ? _elapsed + since_start() : _elapsed;
+    }
+
+    MBED_DEPRECATED_SINCE("mbed-os-6.0.0", "Use the Chrono-based elapsed_time method. If integer microseconds are needed, you can use `elapsed_time().count()`")
+    int read_us() const
+    {
+        return elapsed_time().count();
+    }
+
+    MBED_DEPRECATED_SINCE("mbed-os-6.0.0", "Use the Chrono-based elapsed_time method. If integer milliseconds are needed, you can use `duration_cast<milliseconds>(elapsed_time()).count()`")
+    int read_ms() const
+    {
+        return elapsed_time().count() / 1000;
+    }
+
+    MBED_DEPRECATED_SINCE("mbed-os-6.0.0", "Use the Chrono-based elapsed_time method. If integer microseconds are needed, you can use `elapsed_time().count()`")
+    uint64_t read_high_resolution_us() const
+    {
+        return elapsed_time().count();
+    }
+
+    MBED_DEPRECATED_SINCE("mbed-os-6.0.0", "Floating point operators should normally be avoided for code size. If really needed, you can use `duration<float>{elapsed_time()}.count()`")
+    float read() const
+    {
+        return elapsed_time().count() / 1000000.0f;
+    }
+
+private:
+    std::chrono::microseconds since_start() const
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - _start);
+    }
+
+    bool _running;
+    std::chrono::steady_clock::time_point _start;
+    std::chrono::microseconds _elapsed;
+};
+
+} // namespace mbed
+
+#endif
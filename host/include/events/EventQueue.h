@@ -0,0 +1,180 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2016 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MBED_HOST_EVENT_QUEUE_H
+#define MBED_HOST_EVENT_QUEUE_H
+
+#include "platform/Callback.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <utility>
+
+#define EVENTS_EVENT_SIZE   (4 * sizeof(void*) + 28)
+#define EVENTS_QUEUE_SIZE   (32 * EVENTS_EVENT_SIZE)
+
+namespace events {
+
+/** Host EventQueue, as mbed OS events::EventQueue.
+ *
+ *  Events run on whichever thread calls dispatch. The size bounds the
+ *  number of pending events like the memory pool does on target; a full
+ *  queue makes call return 0.
+ */
+class EventQueue {
+public:
+    EventQueue(unsigned size = EVENTS_QUEUE_SIZE, unsigned char* buffer = nullptr)
+        : _capacity(size / EVENTS_EVENT_SIZE),
+          _next_id(1),
+          _break(false)
+    {
+        (void) buffer;
+    }
+
+    template <typename F, typename... ArgTs>
+    int call(F f, ArgTs... args)
+    {
+        return post(std::chrono::milliseconds(0), bind(f, args...));
+    }
+
+    template <typename F, typename... ArgTs>
+    int call_in(int ms, F f, ArgTs... args)
+    {
+        return post(std::chrono::milliseconds(ms), bind(f, args...));
+    }
+
+    template <typename Rep, typename Period, typename F, typename... ArgTs>
+    int call_in(std::chrono::duration<Rep, Period> delay, F f, ArgTs... args)
+    {
+        return post(std::chrono::duration_cast<std::chrono::milliseconds>(delay), bind(f, args...));
+    }
+
+    bool cancel(int id)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        for (auto event = _events.begin(); event != _events.end(); ++event) {
+            if (event->second.first == id) {
+                _events.erase(event);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    /** Run events for ms milliseconds, forever if negative, or until break_dispatch. */
+    void dispatch(int ms = -1)
+    {
+        auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(ms < 0 ? 0 : ms);
+        std::unique_lock<std::mutex> lock(_mutex);
+
+        while (!_break) {
+            auto now = std::chrono::steady_clock::now();
+
+            if ((ms >= 0) && (now >= end) && (_events.empty() || (_events.begin()->first > now))) {
+                break;
+            }
+
+            if (!_events.empty() && (_events.begin()->first <= now)) {
+                std::function<void()> event = std::move(_events.begin()->second.second);
+                _events.erase(_events.begin());
+
+                lock.unlock();
+                event();
+                lock.lock();
+                continue;
+            }
+
+            auto wake = (ms >= 0) ? end : now + std::chrono::hours(24);
+            if (!_events.empty() && (_events.begin()->first < wake)) {
+                wake = _events.begin()->first;
+            }
+
+            _cond.wait_until(lock, wake);
+        }
+
+        _break = false;
+    }
+
+    void dispatch_forever()
+    {
+        dispatch(-1);
+    }
+
+    template <typename Rep, typename Period>
+    void dispatch_for(std::chrono::duration<Rep, Period> duration)
+    {
+        dispatch(std::chrono::duration_cast<std::chrono::milliseconds>(duration).count());
+    }
+
+    void dispatch_once()
+    {
+        dispatch(0);
+    }
+
+    void break_dispatch()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _break = true;
+        _cond.notify_all();
+    }
+
+private:
+    template <typename F, typename... ArgTs>
+    static std::function<void()> bind(F f, ArgTs... args)
+    {
+        return [f, args...]() { f(args...); };
+    }
+
+    template <typename T, typename R, typename... ArgTs>
+    static std::function<void()> bind(T* obj, R (T::*method)(ArgTs...))
+    {
+        return [obj, method]() { (obj->*method)(); };
+    }
+
+    int post(std::chrono::milliseconds delay, std::function<void()> event)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        if (_events.size() >= _capacity) {
+            return 0;
+        }
+
+        int id = _next_id++;
+        _events.emplace(std::chrono::steady_clock::now() + delay, std::make_pair(id, std::move(event)));
+        _cond.notify_all();
+
+        return id;
+    }
+
+    EventQueue(const EventQueue&) = delete;
+    EventQueue& operator=(const EventQueue&) = delete;
+
+    size_t _capacity;
+    int _next_id;
+    bool _break;
+    std::mutex _mutex;
+    std::condition_variable _cond;
+    std::multimap<std::chrono::steady_clock::time_point, std::pair<int, std::function<void()> > > _events;
+};
+
+} // namespace events
+
+#endif
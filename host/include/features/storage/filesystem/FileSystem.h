@@ -0,0 +1,65 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2016 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MBED_HOST_FILESYSTEM_H
+#define MBED_HOST_FILESYSTEM_H
+
+#include "storage/BlockDevice.h"
+
+#include <string>
+
+namespace mbed {
+
+/** Host file system.
+ *
+ *  A mounted file system named "name" makes paths starting with "/name/"
+ *  resolve to the host directory $MBED_HOST_FS_ROOT/name (default root:
+ *  "fs" in the working directory), the same way mbed OS retargets the
+ *  standard library to its mounted file systems. The block device is kept
+ *  for geometry and bookkeeping only; file data lives in host files.
+ */
+class FileSystem {
+public:
+    FileSystem(const char* name = nullptr);
+    virtual ~FileSystem();
+
+    static FileSystem* get_default_instance();
+
+    virtual int mount(BlockDevice* bd);
+    virtual int unmount();
+    virtual int reformat(BlockDevice* bd = nullptr);
+
+    virtual int remove(const char* path);
+
+    void set_as_default();
+
+    const char* getName() const;
+
+    /** Host directory backing this file system. */
+    const char* host_path() const;
+
+private:
+    FileSystem(const FileSystem&) = delete;
+    FileSystem& operator=(const FileSystem&) = delete;
+
+    std::string _name;
+    std::string _host_path;
+    BlockDevice* _bd;
+};
+
+} // namespace mbed
+
+#endif
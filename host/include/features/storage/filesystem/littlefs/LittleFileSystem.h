@@ -0,0 +1,49 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2016 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MBED_HOST_LITTLEFILESYSTEM_H
+#define MBED_HOST_LITTLEFILESYSTEM_H
+
+#include "features/storage/filesystem/FileSystem.h"
+
+namespace mbed {
+
+class LittleFileSystem : public FileSystem {
+public:
+    LittleFileSystem(const char* name = nullptr, BlockDevice* bd = nullptr,
+                     uint32_t read_size = 64, uint32_t prog_size = 64,
+                     uint32_t block_size = 512, uint32_t lookahead = 512)
+        : FileSystem(name)
+    {
+        (void) read_size;
+        (void) prog_size;
+        (void) block_size;
+        (void) lookahead;
+
+        if (bd) {
+            mount(bd);
+        }
+    }
+
+    virtual ~LittleFileSystem()
+    {
+        unmount();
+    }
+};
+
+} // namespace mbed
+
+#endif
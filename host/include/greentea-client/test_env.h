@@ -0,0 +1,32 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2016 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MBED_HOST_GREENTEA_TEST_ENV_H
+#define MBED_HOST_GREENTEA_TEST_ENV_H
+
+/** Host greentea client: key-value pairs are printed to stdout in the
+ *  {{key;value}} format, so logs can be parsed with the same tooling.
+ *  The timeout given to GREENTEA_SETUP is enforced with alarm().
+ */
+void GREENTEA_SETUP(const int timeout, const char* host_test_name);
+
+void greentea_send_kv(const char* key, const char* value);
+void greentea_send_kv(const char* key, const int value);
+void greentea_send_kv(const char* key, const int passes, const int failures);
+void greentea_send_kv(const char* key, const char* value, const int result);
+void greentea_send_kv(const char* key, const char* value, const int passes, const int failures);
+
+#endif
@@ -0,0 +1,63 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2016 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file mbed.h Host stand-in for the mbed OS umbrella header.
+ *
+ * Only the subset of the mbed OS API used by the stress tests is provided.
+ * Everything is backed by POSIX: threads by std::thread, FlashIAP by a
+ * memory mapped file, sockets by BSD sockets.
+ */
+
+#ifndef MBED_H
+#define MBED_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <chrono>
+
+#include "platform/Callback.h"
+#include "platform/mbed_atomic.h"
+#include "platform/mbed_stats.h"
+#include "platform/mbed_toolchain.h"
+
+#include "rtos/rtos.h"
+
+#include "events/mbed_events.h"
+
+#include "drivers/FlashIAP.h"
+#include "drivers/Timer.h"
+
+#include "storage/BlockDevice.h"
+#include "storage/HeapBlockDevice.h"
+#include "storage/FileBlockDevice.h"
+#include "storage/SlicingBlockDevice.h"
+
+#include "netsocket/nsapi_types.h"
+#include "netsocket/SocketAddress.h"
+#include "netsocket/NetworkInterface.h"
+#include "netsocket/Socket.h"
+#include "netsocket/TCPSocket.h"
+#include "netsocket/TLSSocketWrapper.h"
+#include "netsocket/TLSSocket.h"
+
+using namespace mbed;
+using namespace rtos;
+using namespace std::chrono_literals;
+
+#endif
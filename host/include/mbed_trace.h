@@ -0,0 +1,57 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2016 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MBED_HOST_TRACE_H
+#define MBED_HOST_TRACE_H
+
+#include <stdint.h>
+
+#define TRACE_ACTIVE_LEVEL_ALL      0x1F
+#define TRACE_ACTIVE_LEVEL_DEBUG    0x1F
+#define TRACE_ACTIVE_LEVEL_INFO     0x0F
+#define TRACE_ACTIVE_LEVEL_WARN     0x07
+#define TRACE_ACTIVE_LEVEL_ERROR    0x03
+#define TRACE_ACTIVE_LEVEL_NONE     0x00
+#define TRACE_MODE_COLOR            0x80
+#define TRACE_MODE_PLAIN            0x00
+
+#define TRACE_LEVEL_DEBUG           0x10
+#define TRACE_LEVEL_INFO            0x08
+#define TRACE_LEVEL_WARN            0x04
+#define TRACE_LEVEL_ERROR           0x02
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int mbed_trace_init(void);
+void mbed_trace_free(void);
+void mbed_trace_config_set(uint8_t config);
+void mbed_trace_mutex_wait_function_set(void (*mutex_wait_f)(void));
+void mbed_trace_mutex_release_function_set(void (*mutex_release_f)(void));
+void mbed_tracef(uint8_t dlevel, const char* grp, const char* fmt, ...);
+
+#ifdef __cplusplus
+}
+#endif
+
+/* TRACE_GROUP comes from the file using the macros, as with mbed-trace */
+#define tr_debug(...)   mbed_tracef(TRACE_LEVEL_DEBUG, TRACE_GROUP, __VA_ARGS__)
+#define tr_info(...)    mbed_tracef(TRACE_LEVEL_INFO,  TRACE_GROUP, __VA_ARGS__)
+#define tr_warn(...)    mbed_tracef(TRACE_LEVEL_WARN,  TRACE_GROUP, __VA_ARGS__)
+#define tr_error(...)   mbed_tracef(TRACE_LEVEL_ERROR, TRACE_GROUP, __VA_ARGS__)
+
+#endif
@@ -0,0 +1,72 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2016 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MBED_HOST_MBEDTLS_SSL_H
+#define MBED_HOST_MBEDTLS_SSL_H
+
+#include "mbedtls/x509_crt.h"
+
+#include <stdint.h>
+
+/* session tickets are built into the host OpenSSL */
+#define MBEDTLS_SSL_SESSION_TICKETS
+
+#define MBEDTLS_SSL_SESSION_TICKETS_DISABLED              0
+#define MBEDTLS_SSL_SESSION_TICKETS_ENABLED               1
+
+#define MBEDTLS_ERR_SSL_FEATURE_UNAVAILABLE               -0x7080
+#define MBEDTLS_ERR_SSL_BAD_INPUT_DATA                    -0x7100
+#define MBEDTLS_ERR_SSL_WANT_READ                         -0x6900
+#define MBEDTLS_ERR_SSL_WANT_WRITE                        -0x6880
+
+struct ssl_ctx_st;
+struct ssl_st;
+struct ssl_session_st;
+
+/** Mbed TLS session, backed by a reference counted OpenSSL SSL_SESSION. */
+typedef struct mbedtls_ssl_session {
+    struct ssl_session_st* session;
+} mbedtls_ssl_session;
+
+/** Mbed TLS configuration, backed by an OpenSSL SSL_CTX.
+ *
+ *  Only the verify callback is kept here. OpenSSL verifies the chain itself,
+ *  so the callback is called once per full handshake and never on a resumed
+ *  one, which matches when Mbed TLS calls it.
+ */
+typedef struct mbedtls_ssl_config {
+    struct ssl_ctx_st* ctx;
+    int (*f_vrfy)(void*, mbedtls_x509_crt*, int, uint32_t*);
+    void* p_vrfy;
+} mbedtls_ssl_config;
+
+/** Mbed TLS context, backed by an OpenSSL SSL once the handshake has started. */
+typedef struct mbedtls_ssl_context {
+    const mbedtls_ssl_config* conf;
+    struct ssl_st* ssl;
+} mbedtls_ssl_context;
+
+void mbedtls_ssl_session_init(mbedtls_ssl_session* session);
+void mbedtls_ssl_session_free(mbedtls_ssl_session* session);
+
+int mbedtls_ssl_get_session(const mbedtls_ssl_context* ssl, mbedtls_ssl_session* session);
+int mbedtls_ssl_set_session(mbedtls_ssl_context* ssl, const mbedtls_ssl_session* session);
+int mbedtls_ssl_session_reset(mbedtls_ssl_context* ssl);
+
+void mbedtls_ssl_conf_session_tickets(mbedtls_ssl_config* conf, int use_tickets);
+void mbedtls_ssl_conf_verify(mbedtls_ssl_config* conf, int (*f_vrfy)(void*, mbedtls_x509_crt*, int, uint32_t*), void* p_vrfy);
+
+#endif
@@ -0,0 +1,41 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2016 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MBED_HOST_MBEDTLS_X509_CRT_H
+#define MBED_HOST_MBEDTLS_X509_CRT_H
+
+#include <stddef.h>
+
+#define MBEDTLS_ERR_X509_ALLOC_FAILED                     -0x2880
+#define MBEDTLS_ERR_X509_INVALID_FORMAT                   -0x2180
+
+struct x509_store_st;
+
+/** Mbed TLS certificate chain, backed by an OpenSSL X509_STORE on the host.
+ *
+ *  Only what the stress tests use: parse DER certificates into a chain that
+ *  TLSSocket::set_ca_chain() can share between sockets.
+ */
+typedef struct mbedtls_x509_crt {
+    struct x509_store_st* store;
+    size_t count;
+} mbedtls_x509_crt;
+
+void mbedtls_x509_crt_init(mbedtls_x509_crt* crt);
+int mbedtls_x509_crt_parse_der(mbedtls_x509_crt* chain, const unsigned char* buf, size_t buflen);
+void mbedtls_x509_crt_free(mbedtls_x509_crt* crt);
+
+#endif
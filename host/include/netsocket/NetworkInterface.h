@@ -0,0 +1,49 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2016 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MBED_HOST_NETWORKINTERFACE_H
+#define MBED_HOST_NETWORKINTERFACE_H
+
+#include "netsocket/nsapi_types.h"
+#include "netsocket/SocketAddress.h"
+
+/** Host network interface. The host is assumed to be online already, so
+ *  connect() only reports the local address and DNS goes through getaddrinfo.
+ */
+class NetworkInterface {
+public:
+    static NetworkInterface* get_default_instance();
+
+    virtual ~NetworkInterface() {}
+
+    virtual nsapi_error_t connect();
+    virtual nsapi_error_t disconnect();
+
+    virtual nsapi_error_t get_ip_address(SocketAddress* address);
+    virtual const char* get_mac_address();
+
+    virtual nsapi_error_t gethostbyname(const char* host, SocketAddress* address,
+                                        nsapi_version_t version = NSAPI_UNSPEC,
+                                        const char* interface_name = nullptr);
+
+private:
+    char _mac_address[NSAPI_MAC_SIZE];
+};
+
+class EthernetInterface : public NetworkInterface {
+};
+
+#endif
@@ -0,0 +1,46 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2016 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MBED_HOST_SOCKET_H
+#define MBED_HOST_SOCKET_H
+
+#include "netsocket/nsapi_types.h"
+#include "netsocket/SocketAddress.h"
+#include "platform/Callback.h"
+
+/** Abstract socket, as mbed OS Socket. */
+class Socket {
+public:
+    virtual ~Socket() {}
+
+    virtual nsapi_error_t close() = 0;
+    virtual nsapi_error_t connect(const SocketAddress& address) = 0;
+
+    virtual nsapi_size_or_error_t send(const void* data, nsapi_size_t size) = 0;
+    virtual nsapi_size_or_error_t recv(void* data, nsapi_size_t size) = 0;
+
+    virtual void set_blocking(bool blocking) = 0;
+    virtual void set_timeout(int timeout) = 0;
+
+    /** Register a callback on state change of the socket.
+     *
+     *  On the host the callback is invoked from a single dispatcher thread,
+     *  much like the network stack thread on target.
+     */
+    virtual void sigio(mbed::Callback<void()> func) = 0;
+};
+
+#endif
@@ -0,0 +1,54 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2016 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MBED_HOST_SOCKETADDRESS_H
+#define MBED_HOST_SOCKETADDRESS_H
+
+#include "netsocket/nsapi_types.h"
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+/** IP address and port, stored as a host sockaddr. */
+class SocketAddress {
+public:
+    SocketAddress();
+    SocketAddress(const char* addr, uint16_t port = 0);
+
+    bool set_ip_address(const char* addr);
+    void set_port(uint16_t port);
+
+    const char* get_ip_address() const;
+    uint16_t get_port() const;
+    nsapi_version_t get_ip_version() const;
+
+    explicit operator bool() const;
+
+    /** Host only: sockaddr view of this address. */
+    const struct sockaddr* get_sockaddr(socklen_t* length) const;
+
+    /** Host only: initialise from a sockaddr, keeping the current port if it has none. */
+    void set_sockaddr(const struct sockaddr* address, socklen_t length);
+
+private:
+    struct sockaddr_storage _address;
+    mutable char _ip_text[64];
+};
+
+bool operator==(const SocketAddress& a, const SocketAddress& b);
+bool operator!=(const SocketAddress& a, const SocketAddress& b);
+
+#endif
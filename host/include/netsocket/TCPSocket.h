@@ -0,0 +1,66 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2016 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MBED_HOST_TCPSOCKET_H
+#define MBED_HOST_TCPSOCKET_H
+
+#include "netsocket/Socket.h"
+#include "netsocket/NetworkInterface.h"
+#include "rtos/Mutex.h"
+
+#include <stdint.h>
+
+/** TCP socket on a BSD socket descriptor. */
+class TCPSocket : public Socket {
+public:
+    TCPSocket();
+    virtual ~TCPSocket();
+
+    nsapi_error_t open(NetworkInterface* stack);
+
+    virtual nsapi_error_t close();
+    virtual nsapi_error_t connect(const SocketAddress& address);
+    nsapi_error_t connect(const char* host, uint16_t port);
+
+    virtual nsapi_size_or_error_t send(const void* data, nsapi_size_t size);
+    virtual nsapi_size_or_error_t recv(void* data, nsapi_size_t size);
+
+    virtual void set_blocking(bool blocking);
+    virtual void set_timeout(int timeout);
+    virtual void sigio(mbed::Callback<void()> func);
+
+    nsapi_error_t setsockopt(int level, int optname, const void* optval, unsigned optlen);
+
+    /** Host only: underlying file descriptor, -1 when not connected. */
+    int get_fd() const;
+
+private:
+    TCPSocket(const TCPSocket&) = delete;
+    TCPSocket& operator=(const TCPSocket&) = delete;
+
+    nsapi_error_t wait_ready(short events);
+    void release_descriptor();
+
+    NetworkInterface* _stack;
+    int _fd;
+    bool _connecting;
+    int _timeout;
+    uint64_t _sigio_id;
+    mbed::Callback<void()> _callback;
+    rtos::Mutex _lock;
+};
+
+#endif
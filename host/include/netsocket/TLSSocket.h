@@ -0,0 +1,35 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2016 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MBED_HOST_TLSSOCKET_H
+#define MBED_HOST_TLSSOCKET_H
+
+#include "netsocket/TCPSocket.h"
+#include "netsocket/TLSSocketWrapper.h"
+
+/** TLS over a TCPSocket of its own, as mbed OS TLSSocket. */
+class TLSSocket : public TLSSocketWrapper {
+public:
+    TLSSocket();
+    virtual ~TLSSocket();
+
+    nsapi_error_t open(NetworkInterface* stack);
+
+protected:
+    TCPSocket tcp_socket;
+};
+
+#endif
@@ -0,0 +1,91 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2016 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MBED_HOST_TLSSOCKETWRAPPER_H
+#define MBED_HOST_TLSSOCKETWRAPPER_H
+
+#include "netsocket/Socket.h"
+#include "mbedtls/ssl.h"
+#include "mbedtls/x509_crt.h"
+
+#include <stddef.h>
+#include <string>
+
+/** TLS over a transport socket, implemented with OpenSSL on the host.
+ *
+ *  As on target, a non-blocking connect() returns NSAPI_ERROR_IN_PROGRESS
+ *  once the handshake has started and NSAPI_ERROR_ALREADY while it is still
+ *  running. The transport must be a TCPSocket; the handshake and records go
+ *  through its send() and recv(), which are non-blocking once the handshake
+ *  starts. When the host build has no OpenSSL, connect() returns
+ *  NSAPI_ERROR_UNSUPPORTED.
+ */
+class TLSSocketWrapper : public Socket {
+public:
+    enum control_transport {
+        TRANSPORT_KEEP,
+        TRANSPORT_CONNECT_AND_CLOSE,
+        TRANSPORT_CONNECT,
+        TRANSPORT_CLOSE,
+    };
+
+    TLSSocketWrapper(Socket* transport, const char* hostname = NULL, control_transport control = TRANSPORT_CONNECT_AND_CLOSE);
+    virtual ~TLSSocketWrapper();
+
+    nsapi_error_t set_root_ca_cert(const void* root_ca, size_t len);
+    nsapi_error_t set_root_ca_cert(const char* root_ca_pem);
+
+    /* verify against crt, which stays owned by the caller and may be shared */
+    void set_ca_chain(mbedtls_x509_crt* crt);
+
+    void set_hostname(const char* hostname);
+
+    Socket* get_transport();
+
+    /* the context has its OpenSSL SSL once connect() has started the handshake */
+    mbedtls_ssl_context* get_ssl_context() const;
+    mbedtls_ssl_config* get_ssl_config() const;
+
+    virtual nsapi_error_t close();
+    virtual nsapi_error_t connect(const SocketAddress& address);
+
+    virtual nsapi_size_or_error_t send(const void* data, nsapi_size_t size);
+    virtual nsapi_size_or_error_t recv(void* data, nsapi_size_t size);
+
+    virtual void set_blocking(bool blocking);
+    virtual void set_timeout(int timeout);
+    virtual void sigio(mbed::Callback<void()> func);
+
+private:
+    TLSSocketWrapper(const TLSSocketWrapper&) = delete;
+    TLSSocketWrapper& operator=(const TLSSocketWrapper&) = delete;
+
+    nsapi_error_t close_transport();
+    int transport_fd();
+    nsapi_error_t wait_ready(int error, int timeout);
+    nsapi_error_t continue_handshake(bool first_call);
+
+    Socket* _transport;
+    bool _connect_transport;
+    bool _close_transport;
+    mutable mbedtls_ssl_config _ssl_conf;
+    mutable mbedtls_ssl_context _ssl_context;
+    bool _handshaking;
+    std::string _hostname;
+    int _timeout;
+};
+
+#endif
@@ -0,0 +1,110 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2016 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MBED_HOST_CALLBACK_H
+#define MBED_HOST_CALLBACK_H
+
+#include <cstddef>
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+namespace mbed {
+
+template <typename F>
+class Callback;
+
+/** Host Callback, a thin wrapper around std::function with the mbed
+ *  constructors for free functions, member functions and functors.
+ */
+template <typename R, typename... ArgTs>
+class Callback<R(ArgTs...)> {
+public:
+    Callback()
+    {
+    }
+
+    Callback(std::nullptr_t)
+    {
+    }
+
+    Callback(R (*func)(ArgTs...))
+    {
+        if (func) {
+            _func = func;
+        }
+    }
+
+    template <typename T, typename U>
+    Callback(R (*func)(T*, ArgTs...), U* arg)
+        : _func([func, arg](ArgTs... args) { return func(arg, args...); })
+    {
+    }
+
+    template <typename T, typename U>
+    Callback(U* obj, R (T::*method)(ArgTs...))
+        : _func([obj, method](ArgTs... args) { return (obj->*method)(args...); })
+    {
+    }
+
+    template <typename F,
+              typename = typename std::enable_if<!std::is_same<typename std::decay<F>::type, Callback>::value>::type,
+              typename = decltype(std::declval<F&>()(std::declval<ArgTs>()...))>
+    Callback(F f)
+        : _func(std::move(f))
+    {
+    }
+
+    R call(ArgTs... args) const
+    {
+        return _func(args...);
+    }
+
+    R operator()(ArgTs... args) const
+    {
+        return _func(args...);
+    }
+
+    explicit operator bool() const
+    {
+        return static_cast<bool>(_func);
+    }
+
+private:
+    std::function<R(ArgTs...)> _func;
+};
+
+template <typename R, typename... ArgTs>
+Callback<R(ArgTs...)> callback(R (*func)(ArgTs...))
+{
+    return Callback<R(ArgTs...)>(func);
+}
+
+template <typename T, typename U, typename R, typename... ArgTs>
+Callback<R(ArgTs...)> callback(R (*func)(T*, ArgTs...), U* arg)
+{
+    return Callback<R(ArgTs...)>(func, arg);
+}
+
+template <typename T, typename U, typename R, typename... ArgTs>
+Callback<R(ArgTs...)> callback(U* obj, R (T::*method)(ArgTs...))
+{
+    return Callback<R(ArgTs...)>(obj, method);
+}
+
+} // namespace mbed
+
+#endif
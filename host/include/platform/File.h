@@ -0,0 +1,56 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2016 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MBED_HOST_FILE_H
+#define MBED_HOST_FILE_H
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/types.h>
+
+namespace mbed {
+
+class FileSystem;
+
+/** Host File.
+ *
+ *  Opens path inside the host directory of fs with a plain file
+ *  descriptor, so reads and writes skip stdio buffering the way the mbed
+ *  File API skips newlib's FILE layer.
+ */
+class File {
+public:
+    File();
+    File(FileSystem* fs, const char* path, int flags = O_RDONLY);
+    virtual ~File();
+
+    virtual int open(FileSystem* fs, const char* path, int flags = O_RDONLY);
+    virtual int close();
+
+    virtual ssize_t read(void* buffer, size_t size);
+    virtual ssize_t write(const void* buffer, size_t size);
+    virtual off_t seek(off_t offset, int whence = SEEK_SET);
+
+private:
+    File(const File&) = delete;
+    File& operator=(const File&) = delete;
+
+    int _fd;
+};
+
+} // namespace mbed
+
+#endif
@@ -0,0 +1,48 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2016 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MBED_HOST_ATOMIC_H
+#define MBED_HOST_ATOMIC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+static inline uint32_t core_util_atomic_load_u32(const volatile uint32_t* value)
+{
+    return __atomic_load_n(value, __ATOMIC_SEQ_CST);
+}
+
+static inline void core_util_atomic_store_u32(volatile uint32_t* value, uint32_t desired)
+{
+    __atomic_store_n(value, desired, __ATOMIC_SEQ_CST);
+}
+
+static inline uint32_t core_util_atomic_incr_u32(volatile uint32_t* value, uint32_t delta)
+{
+    return __atomic_add_fetch(value, delta, __ATOMIC_SEQ_CST);
+}
+
+static inline uint32_t core_util_atomic_decr_u32(volatile uint32_t* value, uint32_t delta)
+{
+    return __atomic_sub_fetch(value, delta, __ATOMIC_SEQ_CST);
+}
+
+static inline bool core_util_atomic_cas_u32(volatile uint32_t* ptr, uint32_t* expected, uint32_t desired)
+{
+    return __atomic_compare_exchange_n(ptr, expected, desired, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+}
+
+#endif
@@ -0,0 +1,56 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2016 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MBED_HOST_STATS_H
+#define MBED_HOST_STATS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef uint64_t us_timestamp_t;
+
+/** CPU usage, as mbed OS with platform.cpu-stats-enabled.
+ *
+ *  On the host idle_time is the wall clock time the process did not spend
+ *  on a CPU, so spinning threads show up the way they do on target.
+ */
+typedef struct {
+    us_timestamp_t uptime;
+    us_timestamp_t idle_time;
+    us_timestamp_t sleep_time;
+    us_timestamp_t deep_sleep_time;
+} mbed_stats_cpu_t;
+
+void mbed_stats_cpu_get(mbed_stats_cpu_t* stats);
+
+/** Heap usage, as mbed OS with platform.heap-stats-enabled.
+ *
+ *  On the host only the allocations counted by the target sized heap show
+ *  up, see heap.cpp.
+ */
+typedef struct {
+    uint32_t current_size;
+    uint32_t max_size;
+    uint32_t total_size;
+    uint32_t reserved_size;
+    uint32_t alloc_cnt;
+    uint32_t alloc_fail_cnt;
+    uint32_t overhead_size;
+} mbed_stats_heap_t;
+
+void mbed_stats_heap_get(mbed_stats_heap_t* stats);
+
+#endif
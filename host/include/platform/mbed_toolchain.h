@@ -0,0 +1,27 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2016 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MBED_HOST_MBED_TOOLCHAIN_H
+#define MBED_HOST_MBED_TOOLCHAIN_H
+
+/* mark the shim APIs mbed OS deprecates, so the host build warns where the target build does */
+#ifndef MBED_DEPRECATED
+#define MBED_DEPRECATED(M) __attribute__((deprecated(M)))
+#endif
+
+#define MBED_DEPRECATED_SINCE(D, M) MBED_DEPRECATED(M " [since " D "]")
+
+#endif
@@ -0,0 +1,122 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2016 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MBED_HOST_EVENT_FLAGS_H
+#define MBED_HOST_EVENT_FLAGS_H
+
+#include "platform/mbed_toolchain.h"
+#include "rtos/mbed_rtos_types.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+namespace rtos {
+
+class EventFlags {
+public:
+    EventFlags(const char* name = nullptr)
+        : _flags(0)
+    {
+        (void) name;
+    }
+
+    uint32_t set(uint32_t flags)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _flags |= flags;
+        _cond.notify_all();
+        return _flags;
+    }
+
+    uint32_t clear(uint32_t flags = 0x7fffffff)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        uint32_t old = _flags;
+        _flags &= ~flags;
+        return old;
+    }
+
+    uint32_t get() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _flags;
+    }
+
+    uint32_t wait_all(uint32_t flags = 0)
+    {
+        return wait(flags, osWaitForever, true, true);
+    }
+
+    uint32_t wait_any(uint32_t flags = 0)
+    {
+        return wait(flags, osWaitForever, true, false);
+    }
+
+    MBED_DEPRECATED_SINCE("mbed-os-6.0.0", "Pass a chrono duration, not an integer millisecond count. For example use `5s` rather than `5000`.")
+    uint32_t wait_all(uint32_t flags, uint32_t millisec, bool clear = true)
+    {
+        return wait(flags, millisec, clear, true);
+    }
+
+    MBED_DEPRECATED_SINCE("mbed-os-6.0.0", "Pass a chrono duration, not an integer millisecond count. For example use `5s` rather than `5000`.")
+    uint32_t wait_any(uint32_t flags, uint32_t millisec, bool clear = true)
+    {
+        return wait(flags, millisec, clear, false);
+    }
+
+    template <typename Rep, typename Period>
+    uint32_t wait_all_for(uint32_t flags, std::chrono::duration<Rep, Period> rel_time, bool clear = true)
+    {
+        return wait(flags, std::chrono::duration_cast<std::chrono::milliseconds>(rel_time).count(), clear, true);
+    }
+
+    template <typename Rep, typename Period>
+    uint32_t wait_any_for(uint32_t flags, std::chrono::duration<Rep, Period> rel_time, bool clear = true)
+    {
+        return wait(flags, std::chrono::duration_cast<std::chrono::milliseconds>(rel_time).count(), clear, false);
+    }
+
+private:
+    uint32_t wait(uint32_t flags, uint32_t millisec, bool clear, bool all)
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+
+        auto ready = [&] {
+            return all ? ((_flags & flags) == flags) : ((_flags & flags) != 0);
+        };
+
+        if (millisec == osWaitForever) {
+            _cond.wait(lock, ready);
+        } else if (!_cond.wait_for(lock, std::chrono::milliseconds(millisec), ready)) {
+            return osFlagsErrorTimeout;
+        }
+
+        uint32_t result = _flags;
+        if (clear) {
+            _flags &= ~flags;
+        }
+        return result;
+    }
+
+    mutable std::mutex _mutex;
+    std::condition_variable _cond;
+    uint32_t _flags;
+};
+
+} // namespace rtos
+
+#endif
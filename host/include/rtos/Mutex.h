@@ -0,0 +1,62 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2016 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MBED_HOST_MUTEX_H
+#define MBED_HOST_MUTEX_H
+
+#include "rtos/mbed_rtos_types.h"
+
+#include <chrono>
+#include <mutex>
+
+namespace rtos {
+
+/** Recursive mutex, matching the mbed OS Mutex semantics. */
+class Mutex {
+public:
+    Mutex(const char* name = nullptr)
+    {
+        (void) name;
+    }
+
+    void lock()
+    {
+        _mutex.lock();
+    }
+
+    bool trylock()
+    {
+        return _mutex.try_lock();
+    }
+
+    template <typename Rep, typename Period>
+    bool trylock_for(std::chrono::duration<Rep, Period> rel_time)
+    {
+        return _mutex.try_lock_for(rel_time);
+    }
+
+    void unlock()
+    {
+        _mutex.unlock();
+    }
+
+private:
+    std::recursive_timed_mutex _mutex;
+};
+
+} // namespace rtos
+
+#endif
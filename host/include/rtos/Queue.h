@@ -0,0 +1,100 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2016 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MBED_HOST_QUEUE_H
+#define MBED_HOST_QUEUE_H
+
+#include "rtos/mbed_rtos_types.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+namespace rtos {
+
+/** Bounded queue of pointers with the mbed OS 5 style osEvent interface. */
+template <typename T, uint32_t queue_sz>
+class Queue {
+public:
+    bool empty() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _queue.empty();
+    }
+
+    bool full() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _queue.size() >= queue_sz;
+    }
+
+    uint32_t count() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _queue.size();
+    }
+
+    osStatus put(T* data, uint32_t millisec = 0, uint8_t prio = 0)
+    {
+        (void) prio;
+        std::unique_lock<std::mutex> lock(_mutex);
+
+        auto space = [this] { return _queue.size() < queue_sz; };
+
+        if (millisec == osWaitForever) {
+            _cond.wait(lock, space);
+        } else if (!_cond.wait_for(lock, std::chrono::milliseconds(millisec), space)) {
+            return (millisec == 0) ? osErrorResource : osErrorTimeout;
+        }
+
+        _queue.push_back(data);
+        _cond.notify_all();
+        return osOK;
+    }
+
+    osEvent get(uint32_t millisec = osWaitForever)
+    {
+        osEvent event;
+        event.value.p = nullptr;
+
+        std::unique_lock<std::mutex> lock(_mutex);
+
+        auto data = [this] { return !_queue.empty(); };
+
+        if (millisec == osWaitForever) {
+            _cond.wait(lock, data);
+        } else if (!_cond.wait_for(lock, std::chrono::milliseconds(millisec), data)) {
+            event.status = (millisec == 0) ? osOK : osEventTimeout;
+            return event;
+        }
+
+        event.status = osEventMessage;
+        event.value.p = _queue.front();
+        _queue.pop_front();
+        _cond.notify_all();
+        return event;
+    }
+
+private:
+    mutable std::mutex _mutex;
+    std::condition_variable _cond;
+    std::deque<T*> _queue;
+};
+
+} // namespace rtos
+
+#endif
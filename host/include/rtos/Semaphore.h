@@ -0,0 +1,89 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2016 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MBED_HOST_SEMAPHORE_H
+#define MBED_HOST_SEMAPHORE_H
+
+#include "rtos/mbed_rtos_types.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+namespace rtos {
+
+class Semaphore {
+public:
+    Semaphore(int32_t count = 0, uint16_t max_count = 0xFFFF)
+        : _count(count),
+          _max_count(max_count)
+    {
+    }
+
+    void acquire()
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _cond.wait(lock, [this] { return _count > 0; });
+        _count--;
+    }
+
+    bool try_acquire()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_count > 0) {
+            _count--;
+            return true;
+        }
+        return false;
+    }
+
+    bool try_acquire_for(uint32_t millisec)
+    {
+        return try_acquire_for(std::chrono::milliseconds(millisec));
+    }
+
+    template <typename Rep, typename Period>
+    bool try_acquire_for(std::chrono::duration<Rep, Period> rel_time)
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        if (!_cond.wait_for(lock, rel_time, [this] { return _count > 0; })) {
+            return false;
+        }
+        _count--;
+        return true;
+    }
+
+    osStatus release()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_count >= _max_count) {
+            return osErrorResource;
+        }
+        _count++;
+        _cond.notify_one();
+        return osOK;
+    }
+
+private:
+    std::mutex _mutex;
+    std::condition_variable _cond;
+    int32_t _count;
+    int32_t _max_count;
+};
+
+} // namespace rtos
+
+#endif
@@ -0,0 +1,71 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2016 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MBED_HOST_THIS_THREAD_H
+#define MBED_HOST_THIS_THREAD_H
+
+#include <stdint.h>
+
+#include <chrono>
+#include <thread>
+
+namespace rtos {
+namespace ThisThread {
+
+inline void sleep_for(uint32_t millisec)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(millisec));
+}
+
+template <typename Rep, typename Period>
+inline void sleep_for(std::chrono::duration<Rep, Period> rel_time)
+{
+    std::this_thread::sleep_for(rel_time);
+}
+
+inline void yield()
+{
+    std::this_thread::yield();
+}
+
+} // namespace ThisThread
+
+namespace Kernel {
+
+/** Monotonic millisecond clock, as rtos::Kernel::Clock on target. */
+struct Clock {
+    typedef std::chrono::milliseconds duration;
+    typedef duration::rep rep;
+    typedef duration::period period;
+    typedef std::chrono::time_point<Clock> time_point;
+    static const bool is_steady = true;
+
+    static time_point now()
+    {
+        return time_point(std::chrono::duration_cast<duration>(
+                              std::chrono::steady_clock::now().time_since_epoch()));
+    }
+};
+
+inline uint64_t get_ms_count()
+{
+    return Clock::now().time_since_epoch().count();
+}
+
+} // namespace Kernel
+} // namespace rtos
+
+#endif
@@ -0,0 +1,84 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2016 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MBED_HOST_THREAD_H
+#define MBED_HOST_THREAD_H
+
+#include "rtos/mbed_rtos_types.h"
+#include "platform/Callback.h"
+
+#include <atomic>
+#include <thread>
+
+namespace rtos {
+
+/** Host Thread backed by std::thread.
+ *
+ *  Priority and stack size are accepted for source compatibility and
+ *  recorded, but the host scheduler decides how threads are run.
+ */
+class Thread {
+public:
+    enum State {
+        Inactive,
+        Ready,
+        Running,
+        WaitingDelay,
+        WaitingJoin,
+        WaitingThreadFlag,
+        WaitingEventFlag,
+        WaitingMutex,
+        WaitingSemaphore,
+        WaitingMemoryPool,
+        WaitingMessageGet,
+        WaitingMessagePut,
+        WaitingInterval,
+        WaitingOr,
+        WaitingAnd,
+        WaitingMailbox,
+        Deleted = 0xFF
+    };
+
+    Thread(osPriority priority = osPriorityNormal,
+           uint32_t stack_size = OS_STACK_SIZE,
+           unsigned char* stack_mem = nullptr,
+           const char* name = nullptr);
+
+    ~Thread();
+
+    osStatus start(mbed::Callback<void()> task);
+
+    osStatus join();
+
+    State get_state() const;
+
+    uint32_t stack_size() const;
+
+    const char* get_name() const;
+
+private:
+    Thread(const Thread&) = delete;
+    Thread& operator=(const Thread&) = delete;
+
+    std::thread _thread;
+    std::atomic<int> _state;
+    uint32_t _stack_size;
+    const char* _name;
+};
+
+} // namespace rtos
+
+#endif
@@ -0,0 +1,63 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2016 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MBED_HOST_RTOS_TYPES_H
+#define MBED_HOST_RTOS_TYPES_H
+
+#include <stdint.h>
+
+typedef int32_t osStatus;
+
+enum {
+    osOK                = 0,
+    osEventSignal       = 0x08,
+    osEventMessage      = 0x10,
+    osEventMail         = 0x20,
+    osEventTimeout      = 0x40,
+    osError             = -1,
+    osErrorTimeout      = -2,
+    osErrorResource     = -3,
+    osErrorParameter    = -4,
+    osErrorNoMemory     = -5,
+    osErrorISR          = -6
+};
+
+typedef enum {
+    osPriorityNone          = 0,
+    osPriorityIdle          = 1,
+    osPriorityLow           = 8,
+    osPriorityBelowNormal   = 16,
+    osPriorityNormal        = 24,
+    osPriorityAboveNormal   = 32,
+    osPriorityHigh          = 40,
+    osPriorityRealtime      = 48
+} osPriority;
+
+typedef struct {
+    osStatus status;
+    union {
+        uint32_t v;
+        void* p;
+    } value;
+} osEvent;
+
+#define osWaitForever       0xFFFFFFFFU
+#define osFlagsError        0x80000000U
+#define osFlagsErrorTimeout 0xFFFFFFFEU
+
+#define OS_STACK_SIZE       4096
+
+#endif
@@ -0,0 +1,59 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2016 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MBED_HOST_HEAP_BLOCKDEVICE_H
+#define MBED_HOST_HEAP_BLOCKDEVICE_H
+
+#include "storage/BlockDevice.h"
+
+#include <vector>
+
+namespace mbed {
+
+/** RAM backed block device. Blocks are allocated on first program. */
+class HeapBlockDevice : public BlockDevice {
+public:
+    HeapBlockDevice(bd_size_t size, bd_size_t block = 512);
+    HeapBlockDevice(bd_size_t size, bd_size_t read, bd_size_t program, bd_size_t erase);
+    virtual ~HeapBlockDevice();
+
+    virtual int init();
+    virtual int deinit();
+
+    virtual int read(void* buffer, bd_addr_t addr, bd_size_t size);
+    virtual int program(const void* buffer, bd_addr_t addr, bd_size_t size);
+    virtual int erase(bd_addr_t addr, bd_size_t size);
+
+    virtual bd_size_t get_read_size() const;
+    virtual bd_size_t get_program_size() const;
+    virtual bd_size_t get_erase_size() const;
+    virtual bd_size_t get_erase_size(bd_addr_t addr) const;
+    virtual bd_size_t size() const;
+
+    virtual const char* get_type() const;
+
+private:
+    bd_size_t _read_size;
+    bd_size_t _program_size;
+    bd_size_t _erase_size;
+    bd_size_t _count;
+    std::vector<uint8_t*> _blocks;
+    uint32_t _init_ref_count;
+};
+
+} // namespace mbed
+
+#endif
@@ -0,0 +1,57 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2016 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MBED_HOST_SLICING_BLOCKDEVICE_H
+#define MBED_HOST_SLICING_BLOCKDEVICE_H
+
+#include "storage/BlockDevice.h"
+
+namespace mbed {
+
+/** Window onto a region of another block device. */
+class SlicingBlockDevice : public BlockDevice {
+public:
+    SlicingBlockDevice(BlockDevice* bd, bd_addr_t start, bd_addr_t end = 0);
+    virtual ~SlicingBlockDevice() {}
+
+    virtual int init();
+    virtual int deinit();
+    virtual int sync();
+
+    virtual int read(void* buffer, bd_addr_t addr, bd_size_t size);
+    virtual int program(const void* buffer, bd_addr_t addr, bd_size_t size);
+    virtual int erase(bd_addr_t addr, bd_size_t size);
+
+    virtual bd_size_t get_read_size() const;
+    virtual bd_size_t get_program_size() const;
+    virtual bd_size_t get_erase_size() const;
+    virtual bd_size_t get_erase_size(bd_addr_t addr) const;
+    virtual int get_erase_value() const;
+    virtual bd_size_t size() const;
+
+    virtual const char* get_type() const;
+
+private:
+    BlockDevice* _bd;
+    bool _start_from_end;
+    bd_size_t _start;
+    bool _stop_from_end;
+    bd_size_t _stop;
+};
+
+} // namespace mbed
+
+#endif
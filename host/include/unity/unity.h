@@ -0,0 +1,86 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2016 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MBED_HOST_UNITY_H
+#define MBED_HOST_UNITY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void UnityFail(const char* message, const char* file, int line);
+void UnityAssertEqualNumber(intmax_t expected, intmax_t actual, const char* message, const char* file, int line);
+void UnityAssertEqualUnsigned(uintmax_t expected, uintmax_t actual, const char* message, const char* file, int line);
+void UnityAssertEqualStringLen(const char* expected, const char* actual, uint32_t length,
+                               const char* message, const char* file, int line);
+
+#ifdef __cplusplus
+}
+#endif
+
+#define TEST_FAIL_MESSAGE(message) \
+    UnityFail((message), __FILE__, __LINE__)
+
+#define TEST_ASSERT_MESSAGE(condition, message) \
+    do { if (!(condition)) { UnityFail((message), __FILE__, __LINE__); } } while (0)
+
+#define TEST_ASSERT(condition) \
+    TEST_ASSERT_MESSAGE(condition, "expression evaluated to FALSE")
+
+#define TEST_ASSERT_TRUE_MESSAGE(condition, message)    TEST_ASSERT_MESSAGE(condition, message)
+#define TEST_ASSERT_FALSE_MESSAGE(condition, message)   TEST_ASSERT_MESSAGE(!(condition), message)
+
+#define TEST_ASSERT_NULL_MESSAGE(pointer, message) \
+    TEST_ASSERT_MESSAGE((pointer) == NULL, message)
+
+#define TEST_ASSERT_NOT_NULL_MESSAGE(pointer, message) \
+    TEST_ASSERT_MESSAGE((pointer) != NULL, message)
+
+#define TEST_ASSERT_EQUAL_MESSAGE(expected, actual, message) \
+    UnityAssertEqualNumber((intmax_t) (expected), (intmax_t) (actual), (message), __FILE__, __LINE__)
+
+#define TEST_ASSERT_EQUAL(expected, actual) \
+    TEST_ASSERT_EQUAL_MESSAGE(expected, actual, NULL)
+
+#define TEST_ASSERT_EQUAL_INT_MESSAGE(expected, actual, message) \
+    TEST_ASSERT_EQUAL_MESSAGE(expected, actual, message)
+
+#define TEST_ASSERT_EQUAL_INT(expected, actual) \
+    TEST_ASSERT_EQUAL_MESSAGE(expected, actual, NULL)
+
+#define TEST_ASSERT_EQUAL_UINT_MESSAGE(expected, actual, message) \
+    UnityAssertEqualUnsigned((uintmax_t) (expected), (uintmax_t) (actual), (message), __FILE__, __LINE__)
+
+#define TEST_ASSERT_EQUAL_UINT(expected, actual) \
+    TEST_ASSERT_EQUAL_UINT_MESSAGE(expected, actual, NULL)
+
+#define TEST_ASSERT_EQUAL_UINT32_MESSAGE(expected, actual, message) \
+    TEST_ASSERT_EQUAL_UINT_MESSAGE(expected, actual, message)
+
+#define TEST_ASSERT_NOT_EQUAL_MESSAGE(expected, actual, message) \
+    TEST_ASSERT_MESSAGE((expected) != (actual), message)
+
+#define TEST_ASSERT_NOT_EQUAL(expected, actual) \
+    TEST_ASSERT_NOT_EQUAL_MESSAGE(expected, actual, "expected values to differ")
+
+#define TEST_ASSERT_EQUAL_STRING_LEN_MESSAGE(expected, actual, length, message) \
+    UnityAssertEqualStringLen((const char*) (expected), (const char*) (actual), (uint32_t) (length), \
+                              (message), __FILE__, __LINE__)
+
+#endif
@@ -0,0 +1,115 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2016 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MBED_HOST_UTEST_H
+#define MBED_HOST_UTEST_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace utest {
+namespace v1 {
+
+enum status_t {
+    STATUS_CONTINUE = 0,
+    STATUS_IGNORE = 1,
+    STATUS_ABORT = 2,
+};
+
+enum repeat_t {
+    REPEAT_NONE = 0,
+    REPEAT_CASE_ONLY = 1,
+    REPEAT_ALL = 2,
+};
+
+struct failure_t {
+    int reason;
+    int location;
+};
+
+/** Control returned by case handlers: move on, or call the handler again. */
+struct control_t {
+    repeat_t repeat;
+    uint32_t timeout;
+};
+
+const control_t CaseNext = { REPEAT_NONE, 0 };
+const control_t CaseNoRepeat = { REPEAT_NONE, 0 };
+const control_t CaseRepeatAll = { REPEAT_ALL, 0 };
+const control_t CaseRepeatHandler = { REPEAT_CASE_ONLY, 0 };
+
+typedef void (*case_handler_t)(void);
+typedef control_t (*case_control_handler_t)(void);
+typedef control_t (*case_call_count_handler_t)(const size_t call_count);
+
+typedef status_t (*test_setup_handler_t)(const size_t number_of_cases);
+typedef void (*test_teardown_handler_t)(const size_t passed, const size_t failed, const failure_t failure);
+
+class Case {
+public:
+    Case(const char* description, const case_handler_t handler);
+    Case(const char* description, const case_control_handler_t handler);
+    Case(const char* description, const case_call_count_handler_t handler);
+
+    const char* get_description() const;
+
+    control_t run(const size_t call_count) const;
+
+private:
+    const char* _description;
+    case_handler_t _handler;
+    case_control_handler_t _control_handler;
+    case_call_count_handler_t _call_count_handler;
+};
+
+status_t greentea_test_setup_handler(const size_t number_of_cases);
+void greentea_test_teardown_handler(const size_t passed, const size_t failed, const failure_t failure);
+
+class Specification {
+public:
+    template <size_t N>
+    Specification(const test_setup_handler_t setup_handler, const Case (&cases)[N],
+                  const test_teardown_handler_t teardown_handler = greentea_test_teardown_handler)
+        : _setup_handler(setup_handler),
+          _teardown_handler(teardown_handler),
+          _cases(cases),
+          _length(N)
+    {
+    }
+
+private:
+    friend class Harness;
+
+    test_setup_handler_t _setup_handler;
+    test_teardown_handler_t _teardown_handler;
+    const Case* _cases;
+    size_t _length;
+};
+
+/** Runs a specification to completion on the calling thread.
+ *
+ *  A failed assertion reports the current case, prints the greentea end
+ *  marker and terminates the process with a non-zero exit code.
+ */
+class Harness {
+public:
+    static bool run(const Specification& specification);
+};
+
+} // namespace v1
+} // namespace utest
+
+#endif
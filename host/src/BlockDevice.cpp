@@ -0,0 +1,440 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2016 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "storage/BlockDevice.h"
+#include "storage/HeapBlockDevice.h"
+#include "storage/FileBlockDevice.h"
+#include "storage/SlicingBlockDevice.h"
+#include "host_config.h"
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <vector>
+
+namespace mbed {
+
+BlockDevice* BlockDevice::get_default_instance()
+{
+    static BlockDevice* default_bd = NULL;
+
+    if (!default_bd) {
+        bd_size_t size = host_config_size("MBED_HOST_BLOCKDEVICE_SIZE", 8 * 1024 * 1024);
+        std::string path = host_config_string("MBED_HOST_BLOCKDEVICE_FILE", "");
+
+        if (path.empty()) {
+            default_bd = new HeapBlockDevice(size, 512, 512, 4096);
+        } else {
+            default_bd = new FileBlockDevice(path.c_str(), size);
+        }
+    }
+
+    return default_bd;
+}
+
+/*****************************************************************************/
+/* HeapBlockDevice                                                           */
+/*****************************************************************************/
+
+HeapBlockDevice::HeapBlockDevice(bd_size_t size, bd_size_t block)
+    : _read_size(block),
+      _program_size(block),
+      _erase_size(block),
+      _count(size / block),
+      _init_ref_count(0)
+{
+}
+
+HeapBlockDevice::HeapBlockDevice(bd_size_t size, bd_size_t read, bd_size_t program, bd_size_t erase)
+    : _read_size(read),
+      _program_size(program),
+      _erase_size(erase),
+      _count(size / erase),
+      _init_ref_count(0)
+{
+}
+
+HeapBlockDevice::~HeapBlockDevice()
+{
+    for (uint8_t* block : _blocks) {
+        delete[] block;
+    }
+}
+
+int HeapBlockDevice::init()
+{
+    if (_init_ref_count++ == 0) {
+        _blocks.resize(_count, NULL);
+    }
+
+    return BD_ERROR_OK;
+}
+
+int HeapBlockDevice::deinit()
+{
+    if (_init_ref_count > 0) {
+        _init_ref_count--;
+    }
+
+    return BD_ERROR_OK;
+}
+
+int HeapBlockDevice::read(void* buffer, bd_addr_t addr, bd_size_t size)
+{
+    if (!_init_ref_count || !is_valid_read(addr, size)) {
+        return BD_ERROR_DEVICE_ERROR;
+    }
+
+    uint8_t* data = static_cast<uint8_t*>(buffer);
+
+    while (size > 0) {
+        bd_addr_t hi = addr / _erase_size;
+        bd_addr_t lo = addr % _erase_size;
+        bd_size_t chunk = (size < (_erase_size - lo)) ? size : (_erase_size - lo);
+
+        if (_blocks[hi]) {
+            memcpy(data, &_blocks[hi][lo], chunk);
+        } else {
+            memset(data, 0, chunk);
+        }
+
+        data += chunk;
+        addr += chunk;
+        size -= chunk;
+    }
+
+    return BD_ERROR_OK;
+}
+
+int HeapBlockDevice::program(const void* buffer, bd_addr_t addr, bd_size_t size)
+{
+    if (!_init_ref_count || !is_valid_program(addr, size)) {
+        return BD_ERROR_DEVICE_ERROR;
+    }
+
+    const uint8_t* data = static_cast<const uint8_t*>(buffer);
+
+    while (size > 0) {
+        bd_addr_t hi = addr / _erase_size;
+        bd_addr_t lo = addr % _erase_size;
+        bd_size_t chunk = (size < (_erase_size - lo)) ? size : (_erase_size - lo);
+
+        if (!_blocks[hi]) {
+            _blocks[hi] = new uint8_t[_erase_size]();
+        }
+
+        memcpy(&_blocks[hi][lo], data, chunk);
+
+        data += chunk;
+        addr += chunk;
+        size -= chunk;
+    }
+
+    return BD_ERROR_OK;
+}
+
+int HeapBlockDevice::erase(bd_addr_t addr, bd_size_t size)
+{
+    if (!_init_ref_count || !is_valid_erase(addr, size)) {
+        return BD_ERROR_DEVICE_ERROR;
+    }
+
+    return BD_ERROR_OK;
+}
+
+bd_size_t HeapBlockDevice::get_read_size() const
+{
+    return _read_size;
+}
+
+bd_size_t HeapBlockDevice::get_program_size() const
+{
+    return _program_size;
+}
+
+bd_size_t HeapBlockDevice::get_erase_size() const
+{
+    return _erase_size;
+}
+
+bd_size_t HeapBlockDevice::get_erase_size(bd_addr_t addr) const
+{
+    (void) addr;
+    return _erase_size;
+}
+
+bd_size_t HeapBlockDevice::size() const
+{
+    return _count * _erase_size;
+}
+
+const char* HeapBlockDevice::get_type() const
+{
+    return "HEAP";
+}
+
+/*****************************************************************************/
+/* FileBlockDevice                                                           */
+/*****************************************************************************/
+
+FileBlockDevice::FileBlockDevice(const char* path, bd_size_t size, bd_size_t read, bd_size_t program, bd_size_t erase)
+    : _path(path),
+      _size(size),
+      _read_size(read),
+      _program_size(program),
+      _erase_size(erase),
+      _fd(-1),
+      _init_ref_count(0)
+{
+}
+
+FileBlockDevice::~FileBlockDevice()
+{
+    if (_fd >= 0) {
+        close(_fd);
+    }
+}
+
+int FileBlockDevice::init()
+{
+    if (_init_ref_count++ > 0) {
+        return BD_ERROR_OK;
+    }
+
+    _fd = open(_path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (_fd < 0) {
+        _init_ref_count = 0;
+        return BD_ERROR_DEVICE_ERROR;
+    }
+
+    if (ftruncate(_fd, _size) != 0) {
+        close(_fd);
+        _fd = -1;
+        _init_ref_count = 0;
+        return BD_ERROR_DEVICE_ERROR;
+    }
+
+    return BD_ERROR_OK;
+}
+
+int FileBlockDevice::deinit()
+{
+    if ((_init_ref_count > 0) && (--_init_ref_count == 0)) {
+        close(_fd);
+        _fd = -1;
+    }
+
+    return BD_ERROR_OK;
+}
+
+int FileBlockDevice::sync()
+{
+    return (_fd >= 0 && fsync(_fd) == 0) ? BD_ERROR_OK : BD_ERROR_DEVICE_ERROR;
+}
+
+int FileBlockDevice::read(void* buffer, bd_addr_t addr, bd_size_t size)
+{
+    if ((_fd < 0) || !is_valid_read(addr, size)) {
+        return BD_ERROR_DEVICE_ERROR;
+    }
+
+    return (pread(_fd, buffer, size, addr) == (ssize_t) size) ? BD_ERROR_OK : BD_ERROR_DEVICE_ERROR;
+}
+
+int FileBlockDevice::program(const void* buffer, bd_addr_t addr, bd_size_t size)
+{
+    if ((_fd < 0) || !is_valid_program(addr, size)) {
+        return BD_ERROR_DEVICE_ERROR;
+    }
+
+    return (pwrite(_fd, buffer, size, addr) == (ssize_t) size) ? BD_ERROR_OK : BD_ERROR_DEVICE_ERROR;
+}
+
+int FileBlockDevice::erase(bd_addr_t addr, bd_size_t size)
+{
+    if ((_fd < 0) || !is_valid_erase(addr, size)) {
+        return BD_ERROR_DEVICE_ERROR;
+    }
+
+    std::vector<uint8_t> blank(_erase_size, 0xFF);
+
+    for (bd_size_t index = 0; index < size; index += _erase_size) {
+        if (pwrite(_fd, blank.data(), _erase_size, addr + index) != (ssize_t) _erase_size) {
+            return BD_ERROR_DEVICE_ERROR;
+        }
+    }
+
+    return BD_ERROR_OK;
+}
+
+bd_size_t FileBlockDevice::get_read_size() const
+{
+    return _read_size;
+}
+
+bd_size_t FileBlockDevice::get_program_size() const
+{
+    return _program_size;
+}
+
+bd_size_t FileBlockDevice::get_erase_size() const
+{
+    return _erase_size;
+}
+
+bd_size_t FileBlockDevice::get_erase_size(bd_addr_t addr) const
+{
+    (void) addr;
+    return _erase_size;
+}
+
+int FileBlockDevice::get_erase_value() const
+{
+    return 0xFF;
+}
+
+bd_size_t FileBlockDevice::size() const
+{
+    return _size;
+}
+
+const char* FileBlockDevice::get_type() const
+{
+    return "FILE";
+}
+
+/*****************************************************************************/
+/* SlicingBlockDevice                                                        */
+/*****************************************************************************/
+
+SlicingBlockDevice::SlicingBlockDevice(BlockDevice* bd, bd_addr_t start, bd_addr_t stop)
+    : _bd(bd),
+      _start_from_end(false),
+      _start(start),
+      _stop_from_end(false),
+      _stop(stop)
+{
+    /* same convention as mbed OS: negative or zero offsets count from the end */
+    if ((int64_t) _start < 0) {
+        _start_from_end = true;
+        _start = -_start;
+    }
+
+    if ((int64_t) _stop <= 0) {
+        _stop_from_end = true;
+        _stop = -_stop;
+    }
+}
+
+int SlicingBlockDevice::init()
+{
+    int result = _bd->init();
+    if (result) {
+        return result;
+    }
+
+    if (_start_from_end) {
+        _start = _bd->size() - _start;
+        _start_from_end = false;
+    }
+
+    if (_stop_from_end) {
+        _stop = _bd->size() - _stop;
+        _stop_from_end = false;
+    }
+
+    return BD_ERROR_OK;
+}
+
+int SlicingBlockDevice::deinit()
+{
+    return _bd->deinit();
+}
+
+int SlicingBlockDevice::sync()
+{
+    return _bd->sync();
+}
+
+int SlicingBlockDevice::read(void* buffer, bd_addr_t addr, bd_size_t size)
+{
+    if (!is_valid_read(addr, size)) {
+        return BD_ERROR_DEVICE_ERROR;
+    }
+
+    return _bd->read(buffer, addr + _start, size);
+}
+
+int SlicingBlockDevice::program(const void* buffer, bd_addr_t addr, bd_size_t size)
+{
+    if (!is_valid_program(addr, size)) {
+        return BD_ERROR_DEVICE_ERROR;
+    }
+
+    return _bd->program(buffer, addr + _start, size);
+}
+
+int SlicingBlockDevice::erase(bd_addr_t addr, bd_size_t size)
+{
+    if (!is_valid_erase(addr, size)) {
+        return BD_ERROR_DEVICE_ERROR;
+    }
+
+    return _bd->erase(addr + _start, size);
+}
+
+bd_size_t SlicingBlockDevice::get_read_size() const
+{
+    return _bd->get_read_size();
+}
+
+bd_size_t SlicingBlockDevice::get_program_size() const
+{
+    return _bd->get_program_size();
+}
+
+bd_size_t SlicingBlockDevice::get_erase_size() const
+{
+    return _bd->get_erase_size(_start);
+}
+
+bd_size_t SlicingBlockDevice::get_erase_size(bd_addr_t addr) const
+{
+    return _bd->get_erase_size(_start + addr);
+}
+
+int SlicingBlockDevice::get_erase_value() const
+{
+    return _bd->get_erase_value();
+}
+
+bd_size_t SlicingBlockDevice::size() const
+{
+    bd_addr_t start = _start_from_end ? _bd->size() - _start : _start;
+    bd_addr_t stop = _stop_from_end ? _bd->size() - _stop : _stop;
+
+    return stop - start;
+}
+
+const char* SlicingBlockDevice::get_type() const
+{
+    return _bd->get_type();
+}
+
+} // namespace mbed
@@ -0,0 +1,328 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2016 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "features/storage/filesystem/FileSystem.h"
+#include "platform/File.h"
+#include "host_config.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <ftw.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace {
+
+std::mutex mount_mutex;
+std::map<std::string, std::string> mount_table;
+mbed::FileSystem* default_filesystem = NULL;
+
+int make_directories(const std::string& path)
+{
+    for (size_t index = 1; index <= path.size(); index++) {
+        if ((index == path.size()) || (path[index] == '/')) {
+            std::string prefix = path.substr(0, index);
+
+            if ((mkdir(prefix.c_str(), 0755) != 0) && (errno != EEXIST)) {
+                return -errno;
+            }
+        }
+    }
+
+    return 0;
+}
+
+int remove_entry(const char* path, const struct stat* info, int flag, struct FTW* ftw)
+{
+    (void) info;
+    (void) flag;
+
+    /* keep the mount directory itself */
+    if (ftw->level == 0) {
+        return 0;
+    }
+
+    return ::remove(path);
+}
+
+/** Translate "/<mount>/<path>" into the host directory of that mount. */
+const char* host_translate(const char* path, std::string& storage)
+{
+    if (!path || (path[0] != '/')) {
+        return path;
+    }
+
+    const char* name = path + 1;
+    const char* end = strchr(name, '/');
+    size_t length = end ? (size_t) (end - name) : strlen(name);
+
+    std::lock_guard<std::mutex> lock(mount_mutex);
+
+    std::map<std::string, std::string>::const_iterator entry = mount_table.find(std::string(name, length));
+    if (entry == mount_table.end()) {
+        return path;
+    }
+
+    storage = entry->second + (end ? end : "");
+
+    return storage.c_str();
+}
+
+} // namespace
+
+/* The host executables are linked with --wrap for these symbols, which
+ * plays the role of the mbed OS retarget layer.
+ */
+extern "C" {
+
+FILE* __real_fopen(const char* path, const char* mode);
+FILE* __real_fopen64(const char* path, const char* mode);
+int __real_open(const char* path, int flags, ...);
+int __real_open64(const char* path, int flags, ...);
+int __real_remove(const char* path);
+int __real_unlink(const char* path);
+
+FILE* __wrap_fopen(const char* path, const char* mode)
+{
+    std::string storage;
+    return __real_fopen(host_translate(path, storage), mode);
+}
+
+FILE* __wrap_fopen64(const char* path, const char* mode)
+{
+    std::string storage;
+    return __real_fopen64(host_translate(path, storage), mode);
+}
+
+int __wrap_open(const char* path, int flags, ...)
+{
+    mode_t mode = 0;
+
+    if (flags & O_CREAT) {
+        va_list args;
+        va_start(args, flags);
+        mode = va_arg(args, mode_t);
+        va_end(args);
+    }
+
+    std::string storage;
+    return __real_open(host_translate(path, storage), flags, mode);
+}
+
+int __wrap_open64(const char* path, int flags, ...)
+{
+    mode_t mode = 0;
+
+    if (flags & O_CREAT) {
+        va_list args;
+        va_start(args, flags);
+        mode = va_arg(args, mode_t);
+        va_end(args);
+    }
+
+    std::string storage;
+    return __real_open64(host_translate(path, storage), flags, mode);
+}
+
+int __wrap_remove(const char* path)
+{
+    std::string storage;
+    return __real_remove(host_translate(path, storage));
+}
+
+int __wrap_unlink(const char* path)
+{
+    std::string storage;
+    return __real_unlink(host_translate(path, storage));
+}
+
+} // extern "C"
+
+namespace mbed {
+
+FileSystem::FileSystem(const char* name)
+    : _name(name ? name : ""),
+      _bd(NULL)
+{
+    _host_path = host_config_string("MBED_HOST_FS_ROOT", "fs") + "/" + _name;
+}
+
+FileSystem::~FileSystem()
+{
+    if (default_filesystem == this) {
+        default_filesystem = NULL;
+    }
+}
+
+FileSystem* FileSystem::get_default_instance()
+{
+    return default_filesystem;
+}
+
+int FileSystem::mount(BlockDevice* bd)
+{
+    if (!bd || _name.empty()) {
+        return -EINVAL;
+    }
+
+    int result = bd->init();
+    if (result) {
+        return -EIO;
+    }
+
+    result = make_directories(_host_path);
+    if (result) {
+        return result;
+    }
+
+    _bd = bd;
+
+    std::lock_guard<std::mutex> lock(mount_mutex);
+    mount_table[_name] = _host_path;
+
+    return 0;
+}
+
+int FileSystem::unmount()
+{
+    if (!_bd) {
+        return -EINVAL;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mount_mutex);
+        mount_table.erase(_name);
+    }
+
+    _bd->deinit();
+    _bd = NULL;
+
+    return 0;
+}
+
+int FileSystem::reformat(BlockDevice* bd)
+{
+    if (!bd) {
+        bd = _bd;
+    }
+
+    if (_bd) {
+        unmount();
+    }
+
+    if (nftw(_host_path.c_str(), remove_entry, 16, FTW_DEPTH | FTW_PHYS) != 0 && errno != ENOENT) {
+        return -errno;
+    }
+
+    return mount(bd);
+}
+
+int FileSystem::remove(const char* path)
+{
+    std::string host = _host_path + "/" + path;
+
+    return (::__real_remove(host.c_str()) == 0) ? 0 : -errno;
+}
+
+void FileSystem::set_as_default()
+{
+    default_filesystem = this;
+}
+
+const char* FileSystem::getName() const
+{
+    return _name.c_str();
+}
+
+const char* FileSystem::host_path() const
+{
+    return _host_path.c_str();
+}
+
+File::File()
+    : _fd(-1)
+{
+}
+
+File::File(FileSystem* fs, const char* path, int flags)
+    : _fd(-1)
+{
+    open(fs, path, flags);
+}
+
+File::~File()
+{
+    close();
+}
+
+int File::open(FileSystem* fs, const char* path, int flags)
+{
+    if (!fs || !path) {
+        return -EINVAL;
+    }
+
+    if (_fd >= 0) {
+        return -EEXIST;
+    }
+
+    std::string host = std::string(fs->host_path()) + "/" + path;
+
+    _fd = ::__real_open(host.c_str(), flags, 0644);
+
+    return (_fd >= 0) ? 0 : -errno;
+}
+
+int File::close()
+{
+    if (_fd < 0) {
+        return -EBADF;
+    }
+
+    int result = ::close(_fd);
+    _fd = -1;
+
+    return (result == 0) ? 0 : -errno;
+}
+
+ssize_t File::read(void* buffer, size_t size)
+{
+    ssize_t result = ::read(_fd, buffer, size);
+
+    return (result >= 0) ? result : -errno;
+}
+
+ssize_t File::write(const void* buffer, size_t size)
+{
+    ssize_t result = ::write(_fd, buffer, size);
+
+    return (result >= 0) ? result : -errno;
+}
+
+off_t File::seek(off_t offset, int whence)
+{
+    off_t result = ::lseek(_fd, offset, whence);
+
+    return (result >= 0) ? result : -errno;
+}
+
+} // namespace mbed
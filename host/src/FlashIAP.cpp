@@ -0,0 +1,454 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2016 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "drivers/FlashIAP.h"
+#include "host_config.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+const uint8_t FLASH_ERASE_VALUE = 0xFF;
+
+struct sector_region_t {
+    uint32_t start;
+    uint32_t size;
+    uint32_t count;
+};
+
+/** The single emulated flash device shared by all FlashIAP instances. */
+class HostFlash {
+public:
+    static HostFlash& instance()
+    {
+        static HostFlash flash;
+        return flash;
+    }
+
+    int init()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        if (_memory) {
+            return 0;
+        }
+
+        _start = host_config_size("MBED_HOST_FLASH_START", 0);
+        _size = host_config_size("MBED_HOST_FLASH_SIZE", 1024 * 1024);
+        _page_size = host_config_size("MBED_HOST_FLASH_PAGE", 8);
+        _erase_us_per_k = host_config_size("MBED_HOST_FLASH_ERASE_US", 0);
+        _program_us_per_k = host_config_size("MBED_HOST_FLASH_PROGRAM_US", 0);
+        _endurance = host_config_size("MBED_HOST_FLASH_ENDURANCE", 0);
+
+        if (!parse_sectors(host_config_string("MBED_HOST_FLASH_SECTORS", ""))) {
+            fprintf(stderr, "FlashIAP: invalid MBED_HOST_FLASH_SECTORS\r\n");
+            return -1;
+        }
+
+        std::string path = host_config_string("MBED_HOST_FLASH_FILE", "flash.bin");
+
+        int fd = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+        if (fd < 0) {
+            perror("FlashIAP: open");
+            return -1;
+        }
+
+        struct stat info;
+        bool blank = (fstat(fd, &info) != 0) || ((uint64_t) info.st_size != _size);
+
+        if (blank && (ftruncate(fd, _size) != 0)) {
+            perror("FlashIAP: ftruncate");
+            close(fd);
+            return -1;
+        }
+
+        void* memory = mmap(NULL, _size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+
+        if (memory == MAP_FAILED) {
+            perror("FlashIAP: mmap");
+            return -1;
+        }
+
+        _memory = static_cast<uint8_t*>(memory);
+
+        /* a new or resized device comes out of the factory erased */
+        if (blank) {
+            memset(_memory, FLASH_ERASE_VALUE, _size);
+        }
+
+        return init_wear(path + ".wear", blank);
+    }
+
+    int read(void* buffer, uint32_t addr, uint32_t size)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        if (!_memory || !in_range(addr, size)) {
+            return -1;
+        }
+
+        memcpy(buffer, &_memory[addr - _start], size);
+
+        return 0;
+    }
+
+    int program(const void* buffer, uint32_t addr, uint32_t size)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        if (!_memory || !in_range(addr, size) || (addr % _page_size) || (size % _page_size)) {
+            return -1;
+        }
+
+        /* NOR flash: programming can only clear bits */
+        const uint8_t* data = static_cast<const uint8_t*>(buffer);
+        uint8_t* target = &_memory[addr - _start];
+
+        for (uint32_t index = 0; index < size; index++) {
+            target[index] &= data[index];
+        }
+
+        uint32_t wear = _wear[sector_index(addr - _start)];
+
+        if (_program_us_per_k) {
+            std::this_thread::sleep_for(std::chrono::microseconds((uint64_t) (_program_us_per_k * size / 1024 * wear_factor(wear))));
+        }
+
+        /* past its rated endurance a sector starts losing bits, more often the further it goes */
+        if (_endurance && (wear > _endurance)) {
+            std::uniform_real_distribution<double> chance(0.0, 1.0);
+
+            if (chance(_random) < (double) (wear - _endurance) / _endurance) {
+                std::uniform_int_distribution<uint32_t> bit(0, size * 8 - 1);
+                uint32_t position = bit(_random);
+
+                target[position / 8] &= ~(1 << (position % 8));
+            }
+        }
+
+        return 0;
+    }
+
+    int erase(uint32_t addr, uint32_t size)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        if (!_memory || !in_range(addr, size)) {
+            return -1;
+        }
+
+        /* both ends must sit on sector boundaries */
+        if (!is_sector_aligned(addr) || !is_sector_aligned(addr + size)) {
+            return -1;
+        }
+
+        memset(&_memory[addr - _start], FLASH_ERASE_VALUE, size);
+
+        /* erase time scales with the area and the wear, and holds the device like a real erase stalls the bus */
+        double us = 0;
+
+        for (uint32_t offset = addr - _start; offset < addr - _start + size; ) {
+            uint32_t sector_size = get_sector_size(_start + offset);
+            uint32_t& wear = _wear[sector_index(offset)];
+
+            us += (double) _erase_us_per_k * sector_size / 1024 * wear_factor(wear);
+            wear++;
+
+            offset += sector_size;
+        }
+
+        if (us > 0) {
+            std::this_thread::sleep_for(std::chrono::microseconds((uint64_t) us));
+        }
+
+        return 0;
+    }
+
+    uint32_t get_sector_size(uint32_t addr) const
+    {
+        if ((addr < _start) || (addr >= (_start + _size))) {
+            return MBED_FLASH_INVALID_SIZE;
+        }
+
+        for (const sector_region_t& region : _regions) {
+            if ((addr - _start) < (region.start + region.size * region.count)) {
+                return region.size;
+            }
+        }
+
+        return MBED_FLASH_INVALID_SIZE;
+    }
+
+    uint32_t get_flash_start() const
+    {
+        return _start;
+    }
+
+    uint32_t get_flash_size() const
+    {
+        return _size;
+    }
+
+    uint32_t get_page_size() const
+    {
+        return _page_size;
+    }
+
+    const void* host_address(uint32_t addr) const
+    {
+        if (!_memory || !in_range(addr, 0)) {
+            return NULL;
+        }
+
+        return &_memory[addr - _start];
+    }
+
+private:
+    HostFlash()
+        : _memory(NULL),
+          _start(0),
+          _size(0),
+          _page_size(0),
+          _erase_us_per_k(0),
+          _program_us_per_k(0),
+          _endurance(0),
+          _wear(NULL),
+          _random(1)
+    {
+    }
+
+    /* erase counts per sector, kept next to the flash image so wear adds up across runs */
+    int init_wear(const std::string& path, bool blank)
+    {
+        uint32_t sectors = 0;
+
+        for (const sector_region_t& region : _regions) {
+            sectors += region.count;
+        }
+
+        int fd = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+        if (fd < 0) {
+            perror("FlashIAP: open wear");
+            return -1;
+        }
+
+        size_t length = sectors * sizeof(uint32_t);
+
+        struct stat info;
+        bool fresh = blank || (fstat(fd, &info) != 0) || ((uint64_t) info.st_size != length);
+
+        if (fresh && ((ftruncate(fd, 0) != 0) || (ftruncate(fd, length) != 0))) {
+            perror("FlashIAP: ftruncate wear");
+            close(fd);
+            return -1;
+        }
+
+        void* memory = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+
+        if (memory == MAP_FAILED) {
+            perror("FlashIAP: mmap wear");
+            return -1;
+        }
+
+        _wear = static_cast<uint32_t*>(memory);
+
+        return 0;
+    }
+
+    uint32_t sector_index(uint32_t offset) const
+    {
+        uint32_t index = 0;
+
+        for (const sector_region_t& region : _regions) {
+            if (offset < (region.start + region.size * region.count)) {
+                return index + (offset - region.start) / region.size;
+            }
+
+            index += region.count;
+        }
+
+        return index - 1;
+    }
+
+    /* erase and program slow down linearly, twice as slow at the rated endurance */
+    double wear_factor(uint32_t wear) const
+    {
+        return _endurance ? 1.0 + (double) wear / _endurance : 1.0;
+    }
+
+    bool in_range(uint32_t addr, uint32_t size) const
+    {
+        return (addr >= _start) && ((uint64_t) addr + size <= (uint64_t) _start + _size);
+    }
+
+    bool is_sector_aligned(uint32_t addr) const
+    {
+        if (addr == _start + _size) {
+            return true;
+        }
+
+        uint32_t offset = addr - _start;
+
+        for (const sector_region_t& region : _regions) {
+            if (offset < (region.start + region.size * region.count)) {
+                return ((offset - region.start) % region.size) == 0;
+            }
+        }
+
+        return false;
+    }
+
+    /* "4*16K,1*64K,7*128K", or empty for uniform 4 KiB sectors */
+    bool parse_sectors(const std::string& layout)
+    {
+        _regions.clear();
+
+        if (layout.empty()) {
+            sector_region_t region = { 0, 4096, _size / 4096 };
+            _regions.push_back(region);
+
+            return (_size % 4096) == 0;
+        }
+
+        uint32_t offset = 0;
+        size_t position = 0;
+
+        while (position < layout.size()) {
+            size_t end = layout.find(',', position);
+            if (end == std::string::npos) {
+                end = layout.size();
+            }
+
+            std::string entry = layout.substr(position, end - position);
+            size_t star = entry.find('*');
+            if (star == std::string::npos) {
+                return false;
+            }
+
+            uint64_t count = host_parse_size(entry.substr(0, star).c_str(), 0);
+            uint64_t size = host_parse_size(entry.substr(star + 1).c_str(), 0);
+            if ((count == 0) || (size == 0) || (size % _page_size)) {
+                return false;
+            }
+
+            sector_region_t region = { offset, (uint32_t) size, (uint32_t) count };
+            _regions.push_back(region);
+            offset += size * count;
+
+            position = end + 1;
+        }
+
+        /* an explicit layout defines the flash size */
+        _size = offset;
+
+        return true;
+    }
+
+    std::mutex _mutex;
+    uint8_t* _memory;
+    uint32_t _start;
+    uint32_t _size;
+    uint32_t _page_size;
+    uint32_t _erase_us_per_k;
+    uint32_t _program_us_per_k;
+    uint32_t _endurance;
+    uint32_t* _wear;
+    std::minstd_rand _random;
+    std::vector<sector_region_t> _regions;
+};
+
+} // namespace
+
+namespace mbed {
+
+FlashIAP::FlashIAP()
+{
+}
+
+FlashIAP::~FlashIAP()
+{
+}
+
+int FlashIAP::init()
+{
+    return HostFlash::instance().init();
+}
+
+int FlashIAP::deinit()
+{
+    return 0;
+}
+
+int FlashIAP::read(void* buffer, uint32_t addr, uint32_t size)
+{
+    return HostFlash::instance().read(buffer, addr, size);
+}
+
+int FlashIAP::program(const void* buffer, uint32_t addr, uint32_t size)
+{
+    return HostFlash::instance().program(buffer, addr, size);
+}
+
+int FlashIAP::erase(uint32_t addr, uint32_t size)
+{
+    return HostFlash::instance().erase(addr, size);
+}
+
+uint32_t FlashIAP::get_sector_size(uint32_t addr) const
+{
+    return HostFlash::instance().get_sector_size(addr);
+}
+
+uint32_t FlashIAP::get_flash_start() const
+{
+    return HostFlash::instance().get_flash_start();
+}
+
+uint32_t FlashIAP::get_flash_size() const
+{
+    return HostFlash::instance().get_flash_size();
+}
+
+uint32_t FlashIAP::get_page_size() const
+{
+    return HostFlash::instance().get_page_size();
+}
+
+uint8_t FlashIAP::get_erase_value() const
+{
+    return FLASH_ERASE_VALUE;
+}
+
+const void* FlashIAP::host_address(uint32_t addr) const
+{
+    return HostFlash::instance().host_address(addr);
+}
+
+} // namespace mbed
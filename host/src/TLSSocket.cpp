@@ -0,0 +1,541 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2016 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "netsocket/TLSSocket.h"
+
+#include <poll.h>
+#include <string.h>
+
+#if MBED_HOST_TLS_OPENSSL
+
+#include <openssl/err.h>
+#include <openssl/pem.h>
+#include <openssl/ssl.h>
+#include <openssl/x509.h>
+
+/* records go through the transport's send() and recv(), as with the Mbed TLS
+ * bio callbacks on target, so a transport subclass sees every byte */
+static int transport_bio_write(BIO* bio, const char* data, int size)
+{
+    Socket* transport = static_cast<Socket*>(BIO_get_data(bio));
+
+    BIO_clear_retry_flags(bio);
+
+    nsapi_size_or_error_t result = transport->send(data, size);
+    if (result == NSAPI_ERROR_WOULD_BLOCK) {
+        BIO_set_retry_write(bio);
+    }
+
+    return (result < 0) ? -1 : result;
+}
+
+static int transport_bio_read(BIO* bio, char* data, int size)
+{
+    Socket* transport = static_cast<Socket*>(BIO_get_data(bio));
+
+    BIO_clear_retry_flags(bio);
+
+    nsapi_size_or_error_t result = transport->recv(data, size);
+    if (result == NSAPI_ERROR_WOULD_BLOCK) {
+        BIO_set_retry_read(bio);
+    }
+
+    return (result < 0) ? -1 : result;
+}
+
+static long transport_bio_ctrl(BIO* bio, int command, long value, void* pointer)
+{
+    (void) bio;
+    (void) value;
+    (void) pointer;
+
+    return (command == BIO_CTRL_FLUSH) ? 1 : 0;
+}
+
+static BIO_METHOD* transport_bio_method_new()
+{
+    BIO_METHOD* method = BIO_meth_new(BIO_get_new_index() | BIO_TYPE_SOURCE_SINK, "mbed transport");
+
+    if (method) {
+        BIO_meth_set_write(method, transport_bio_write);
+        BIO_meth_set_read(method, transport_bio_read);
+        BIO_meth_set_ctrl(method, transport_bio_ctrl);
+    }
+
+    return method;
+}
+
+/* shared by every wrapper, created once even with sockets on several threads */
+static BIO_METHOD* transport_bio_method()
+{
+    static BIO_METHOD* method = transport_bio_method_new();
+
+    return method;
+}
+
+TLSSocketWrapper::TLSSocketWrapper(Socket* transport, const char* hostname, control_transport control)
+    : _transport(transport),
+      _connect_transport((control == TRANSPORT_CONNECT) || (control == TRANSPORT_CONNECT_AND_CLOSE)),
+      _close_transport((control == TRANSPORT_CLOSE) || (control == TRANSPORT_CONNECT_AND_CLOSE)),
+      _ssl_conf(),
+      _ssl_context(),
+      _handshaking(false),
+      _timeout(-1)
+{
+    _ssl_conf.ctx = SSL_CTX_new(TLS_client_method());
+    _ssl_context.conf = &_ssl_conf;
+
+    if (_ssl_conf.ctx) {
+        SSL_CTX_set_verify(_ssl_conf.ctx, SSL_VERIFY_NONE, NULL);
+    }
+
+    set_hostname(hostname);
+}
+
+TLSSocketWrapper::~TLSSocketWrapper()
+{
+    close();
+
+    if (_ssl_conf.ctx) {
+        SSL_CTX_free(_ssl_conf.ctx);
+    }
+}
+
+nsapi_error_t TLSSocketWrapper::set_root_ca_cert(const void* root_ca, size_t len)
+{
+    if (!_ssl_conf.ctx || !root_ca) {
+        return NSAPI_ERROR_NO_SOCKET;
+    }
+
+    X509_STORE* store = SSL_CTX_get_cert_store(_ssl_conf.ctx);
+    size_t loaded = 0;
+
+    if ((len > 10) && (memcmp(root_ca, "-----BEGIN", 10) == 0)) {
+        BIO* bio = BIO_new_mem_buf(root_ca, (int) len);
+
+        for (X509* cert = PEM_read_bio_X509(bio, NULL, NULL, NULL); cert; cert = PEM_read_bio_X509(bio, NULL, NULL, NULL)) {
+            X509_STORE_add_cert(store, cert);
+            X509_free(cert);
+            loaded++;
+        }
+
+        BIO_free(bio);
+        ERR_clear_error();
+    } else {
+        const unsigned char* der = static_cast<const unsigned char*>(root_ca);
+        const unsigned char* end = der + len;
+
+        while (der < end) {
+            X509* cert = d2i_X509(NULL, &der, end - der);
+            if (!cert) {
+                break;
+            }
+
+            X509_STORE_add_cert(store, cert);
+            X509_free(cert);
+            loaded++;
+        }
+    }
+
+    if (loaded == 0) {
+        return NSAPI_ERROR_PARAMETER;
+    }
+
+    SSL_CTX_set_verify(_ssl_conf.ctx, SSL_VERIFY_PEER, NULL);
+
+    return NSAPI_ERROR_OK;
+}
+
+nsapi_error_t TLSSocketWrapper::set_root_ca_cert(const char* root_ca_pem)
+{
+    if (!root_ca_pem) {
+        return NSAPI_ERROR_PARAMETER;
+    }
+
+    return set_root_ca_cert(root_ca_pem, strlen(root_ca_pem) + 1);
+}
+
+void TLSSocketWrapper::set_ca_chain(mbedtls_x509_crt* crt)
+{
+    if (!_ssl_conf.ctx || !crt || !crt->store) {
+        return;
+    }
+
+    /* referenced, not copied, like the chain pointer Mbed TLS keeps */
+    SSL_CTX_set1_cert_store(_ssl_conf.ctx, crt->store);
+    SSL_CTX_set_verify(_ssl_conf.ctx, SSL_VERIFY_PEER, NULL);
+}
+
+void TLSSocketWrapper::set_hostname(const char* hostname)
+{
+    _hostname = hostname ? hostname : "";
+}
+
+Socket* TLSSocketWrapper::get_transport()
+{
+    return _transport;
+}
+
+nsapi_error_t TLSSocketWrapper::close()
+{
+    if (_ssl_context.ssl) {
+        SSL_shutdown(_ssl_context.ssl);
+        SSL_free(_ssl_context.ssl);
+        _ssl_context.ssl = NULL;
+    }
+
+    _handshaking = false;
+
+    return close_transport();
+}
+
+nsapi_error_t TLSSocketWrapper::wait_ready(int error, int timeout)
+{
+    short events = (error == SSL_ERROR_WANT_WRITE) ? POLLOUT : POLLIN;
+    struct pollfd descriptor = { transport_fd(), events, 0 };
+
+    int result = poll(&descriptor, 1, timeout);
+
+    if (result < 0) {
+        return NSAPI_ERROR_DEVICE_ERROR;
+    } else if (result == 0) {
+        return NSAPI_ERROR_WOULD_BLOCK;
+    }
+
+    return NSAPI_ERROR_OK;
+}
+
+nsapi_error_t TLSSocketWrapper::connect(const SocketAddress& address)
+{
+    if (!_ssl_conf.ctx || !_transport) {
+        return NSAPI_ERROR_NO_SOCKET;
+    }
+
+    if (_handshaking) {
+        return continue_handshake(false);
+    }
+
+    if (_ssl_context.ssl) {
+        return NSAPI_ERROR_IS_CONNECTED;
+    }
+
+    if (_connect_transport) {
+        /* the TCP connection always completes before the handshake starts */
+        _transport->set_timeout(-1);
+        nsapi_error_t result = _transport->connect(address);
+        _transport->set_timeout(_timeout);
+
+        if ((result != NSAPI_ERROR_OK) && (result != NSAPI_ERROR_IS_CONNECTED)) {
+            return result;
+        }
+    }
+
+    _ssl_context.ssl = SSL_new(_ssl_conf.ctx);
+    if (!_ssl_context.ssl) {
+        return NSAPI_ERROR_NO_MEMORY;
+    }
+
+    BIO* bio = BIO_new(transport_bio_method());
+    if (!bio) {
+        SSL_free(_ssl_context.ssl);
+        _ssl_context.ssl = NULL;
+        return NSAPI_ERROR_NO_MEMORY;
+    }
+
+    BIO_set_data(bio, _transport);
+    BIO_set_init(bio, 1);
+    SSL_set_bio(_ssl_context.ssl, bio, bio);
+
+    /* the wrapper waits on the descriptor itself, as on target */
+    _transport->set_blocking(false);
+
+    SSL_set_mode(_ssl_context.ssl, SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER | SSL_MODE_ENABLE_PARTIAL_WRITE);
+
+    if (!_hostname.empty()) {
+        SSL_set_tlsext_host_name(_ssl_context.ssl, _hostname.c_str());
+        SSL_set1_host(_ssl_context.ssl, _hostname.c_str());
+    }
+
+    _handshaking = true;
+
+    return continue_handshake(true);
+}
+
+nsapi_error_t TLSSocketWrapper::continue_handshake(bool first_call)
+{
+    for (;;) {
+        int status = SSL_connect(_ssl_context.ssl);
+        if (status == 1) {
+            _handshaking = false;
+
+            /* Mbed TLS only verifies, and calls back, when the server sends its certificate */
+            if (_ssl_conf.f_vrfy && !SSL_session_reused(_ssl_context.ssl)) {
+                uint32_t flags = 0;
+                _ssl_conf.f_vrfy(_ssl_conf.p_vrfy, NULL, 0, &flags);
+            }
+
+            return NSAPI_ERROR_OK;
+        }
+
+        int error = SSL_get_error(_ssl_context.ssl, status);
+
+        if ((error == SSL_ERROR_WANT_READ) || (error == SSL_ERROR_WANT_WRITE)) {
+            if (_timeout == 0) {
+                return first_call ? NSAPI_ERROR_IN_PROGRESS : NSAPI_ERROR_ALREADY;
+            }
+
+            /* a blocking handshake always runs to completion */
+            if (wait_ready(error, -1) == NSAPI_ERROR_OK) {
+                continue;
+            }
+        }
+
+        ERR_print_errors_fp(stderr);
+
+        SSL_free(_ssl_context.ssl);
+        _ssl_context.ssl = NULL;
+        _handshaking = false;
+
+        return NSAPI_ERROR_AUTH_FAILURE;
+    }
+}
+
+nsapi_size_or_error_t TLSSocketWrapper::send(const void* data, nsapi_size_t size)
+{
+    if (!_ssl_context.ssl || _handshaking) {
+        return _handshaking ? NSAPI_ERROR_WOULD_BLOCK : NSAPI_ERROR_NO_CONNECTION;
+    }
+
+    const uint8_t* buffer = static_cast<const uint8_t*>(data);
+    nsapi_size_t sent = 0;
+
+    while (sent < size) {
+        int result = SSL_write(_ssl_context.ssl, &buffer[sent], size - sent);
+
+        if (result > 0) {
+            sent += result;
+            continue;
+        }
+
+        int error = SSL_get_error(_ssl_context.ssl, result);
+
+        if ((error == SSL_ERROR_WANT_READ) || (error == SSL_ERROR_WANT_WRITE)) {
+            if (_timeout == 0) {
+                return sent ? (nsapi_size_or_error_t) sent : NSAPI_ERROR_WOULD_BLOCK;
+            }
+
+            nsapi_error_t ready = wait_ready(error, _timeout);
+            if (ready != NSAPI_ERROR_OK) {
+                return sent ? (nsapi_size_or_error_t) sent : ready;
+            }
+        } else {
+            return sent ? (nsapi_size_or_error_t) sent : NSAPI_ERROR_CONNECTION_LOST;
+        }
+    }
+
+    return sent;
+}
+
+nsapi_size_or_error_t TLSSocketWrapper::recv(void* data, nsapi_size_t size)
+{
+    if (!_ssl_context.ssl || _handshaking) {
+        return _handshaking ? NSAPI_ERROR_WOULD_BLOCK : NSAPI_ERROR_NO_CONNECTION;
+    }
+
+    for (;;) {
+        int result = SSL_read(_ssl_context.ssl, data, size);
+
+        if (result > 0) {
+            return result;
+        }
+
+        int error = SSL_get_error(_ssl_context.ssl, result);
+
+        if ((error == SSL_ERROR_WANT_READ) || (error == SSL_ERROR_WANT_WRITE)) {
+            if (_timeout == 0) {
+                return NSAPI_ERROR_WOULD_BLOCK;
+            }
+
+            nsapi_error_t ready = wait_ready(error, _timeout);
+            if (ready != NSAPI_ERROR_OK) {
+                return ready;
+            }
+        } else if ((error == SSL_ERROR_ZERO_RETURN) || (error == SSL_ERROR_SYSCALL)) {
+            /* orderly shutdown, or the peer dropped the connection */
+            return 0;
+        } else {
+            return NSAPI_ERROR_CONNECTION_LOST;
+        }
+    }
+}
+
+#else /* MBED_HOST_TLS_OPENSSL */
+
+TLSSocketWrapper::TLSSocketWrapper(Socket* transport, const char* hostname, control_transport control)
+    : _transport(transport),
+      _connect_transport((control == TRANSPORT_CONNECT) || (control == TRANSPORT_CONNECT_AND_CLOSE)),
+      _close_transport((control == TRANSPORT_CLOSE) || (control == TRANSPORT_CONNECT_AND_CLOSE)),
+      _ssl_conf(),
+      _ssl_context(),
+      _handshaking(false),
+      _timeout(-1)
+{
+    _ssl_context.conf = &_ssl_conf;
+
+    set_hostname(hostname);
+}
+
+TLSSocketWrapper::~TLSSocketWrapper()
+{
+    close();
+}
+
+nsapi_error_t TLSSocketWrapper::set_root_ca_cert(const void* root_ca, size_t len)
+{
+    (void) root_ca;
+    (void) len;
+    return NSAPI_ERROR_OK;
+}
+
+nsapi_error_t TLSSocketWrapper::set_root_ca_cert(const char* root_ca_pem)
+{
+    (void) root_ca_pem;
+    return NSAPI_ERROR_OK;
+}
+
+void TLSSocketWrapper::set_ca_chain(mbedtls_x509_crt* crt)
+{
+    (void) crt;
+}
+
+void TLSSocketWrapper::set_hostname(const char* hostname)
+{
+    _hostname = hostname ? hostname : "";
+}
+
+Socket* TLSSocketWrapper::get_transport()
+{
+    return _transport;
+}
+
+nsapi_error_t TLSSocketWrapper::close()
+{
+    return close_transport();
+}
+
+nsapi_error_t TLSSocketWrapper::wait_ready(int error, int timeout)
+{
+    (void) error;
+    (void) timeout;
+    return NSAPI_ERROR_UNSUPPORTED;
+}
+
+nsapi_error_t TLSSocketWrapper::connect(const SocketAddress& address)
+{
+    (void) address;
+    return NSAPI_ERROR_UNSUPPORTED;
+}
+
+nsapi_error_t TLSSocketWrapper::continue_handshake(bool first_call)
+{
+    (void) first_call;
+    return NSAPI_ERROR_UNSUPPORTED;
+}
+
+nsapi_size_or_error_t TLSSocketWrapper::send(const void* data, nsapi_size_t size)
+{
+    (void) data;
+    (void) size;
+    return NSAPI_ERROR_UNSUPPORTED;
+}
+
+nsapi_size_or_error_t TLSSocketWrapper::recv(void* data, nsapi_size_t size)
+{
+    (void) data;
+    (void) size;
+    return NSAPI_ERROR_UNSUPPORTED;
+}
+
+#endif /* MBED_HOST_TLS_OPENSSL */
+
+/* a closed wrapper lets go of its transport, as on target */
+nsapi_error_t TLSSocketWrapper::close_transport()
+{
+    nsapi_error_t result = NSAPI_ERROR_OK;
+
+    if (_close_transport && _transport) {
+        result = _transport->close();
+    }
+
+    _transport = NULL;
+
+    return result;
+}
+
+mbedtls_ssl_context* TLSSocketWrapper::get_ssl_context() const
+{
+    return &_ssl_context;
+}
+
+mbedtls_ssl_config* TLSSocketWrapper::get_ssl_config() const
+{
+    return &_ssl_conf;
+}
+
+int TLSSocketWrapper::transport_fd()
+{
+    TCPSocket* tcp = dynamic_cast<TCPSocket*>(_transport);
+
+    return tcp ? tcp->get_fd() : -1;
+}
+
+void TLSSocketWrapper::set_blocking(bool blocking)
+{
+    set_timeout(blocking ? -1 : 0);
+}
+
+void TLSSocketWrapper::set_timeout(int timeout)
+{
+    _timeout = (timeout < 0) ? -1 : timeout;
+
+    /* the transport stays non-blocking once the handshake has started */
+    if (_transport && !_ssl_context.ssl) {
+        _transport->set_timeout(_timeout);
+    }
+}
+
+void TLSSocketWrapper::sigio(mbed::Callback<void()> func)
+{
+    if (_transport) {
+        _transport->sigio(func);
+    }
+}
+
+TLSSocket::TLSSocket()
+    : TLSSocketWrapper(&tcp_socket)
+{
+}
+
+TLSSocket::~TLSSocket()
+{
+    /* tcp_socket goes away before the base class destructor runs */
+    close();
+}
+
+nsapi_error_t TLSSocket::open(NetworkInterface* stack)
+{
+    return tcp_socket.open(stack);
+}
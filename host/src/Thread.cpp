@@ -0,0 +1,75 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2016 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "rtos/Thread.h"
+
+namespace rtos {
+
+Thread::Thread(osPriority priority, uint32_t stack_size, unsigned char* stack_mem, const char* name)
+    : _state(Inactive),
+      _stack_size(stack_size),
+      _name(name)
+{
+    (void) priority;
+    (void) stack_mem;
+}
+
+Thread::~Thread()
+{
+    /* mbed OS terminates a running thread here, the host can only wait for it */
+    join();
+}
+
+osStatus Thread::start(mbed::Callback<void()> task)
+{
+    if (_state != Inactive) {
+        return osErrorParameter;
+    }
+
+    _state = Running;
+    _thread = std::thread([this, task]() {
+        task();
+        _state = Deleted;
+    });
+
+    return osOK;
+}
+
+osStatus Thread::join()
+{
+    if (_thread.joinable() && (_thread.get_id() != std::this_thread::get_id())) {
+        _thread.join();
+    }
+
+    return osOK;
+}
+
+Thread::State Thread::get_state() const
+{
+    return static_cast<State>(_state.load());
+}
+
+uint32_t Thread::stack_size() const
+{
+    return _stack_size;
+}
+
+const char* Thread::get_name() const
+{
+    return _name;
+}
+
+} // namespace rtos
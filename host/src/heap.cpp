@@ -0,0 +1,165 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2016 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file heap.cpp Target sized heap for the host build.
+ *
+ *  The stress tests measure heap exhaustion, which never happens on a
+ *  Linux host with overcommit. malloc and friends are wrapped at link time
+ *  and fail once MBED_HOST_HEAP_SIZE bytes (default: 256K) are in use.
+ *  Only calls made from the test code are accounted, allocations inside
+ *  the C and C++ runtimes are not.
+ */
+
+#include "host_config.h"
+#include "platform/mbed_stats.h"
+
+#include <malloc.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <atomic>
+
+namespace {
+
+std::atomic<size_t> heap_used(0);
+std::atomic<size_t> heap_peak(0);
+std::atomic<size_t> heap_total(0);
+std::atomic<uint32_t> heap_allocations(0);     /* live allocations, like mbed OS */
+std::atomic<uint32_t> heap_failures(0);
+
+size_t heap_limit()
+{
+    static size_t limit = host_config_size("MBED_HOST_HEAP_SIZE", 256 * 1024);
+    return limit;
+}
+
+bool heap_reserve(size_t size)
+{
+    size_t used = heap_used.load();
+
+    do {
+        if ((size > heap_limit()) || (used > heap_limit() - size)) {
+            heap_failures++;
+            return false;
+        }
+    } while (!heap_used.compare_exchange_weak(used, used + size));
+
+    size_t peak = heap_peak.load();
+
+    while ((used + size > peak) && !heap_peak.compare_exchange_weak(peak, used + size)) {
+    }
+
+    heap_total += size;
+    heap_allocations++;
+
+    return true;
+}
+
+void heap_release(size_t size)
+{
+    size_t used = heap_used.load();
+
+    /* saturate, in case memory from an unwrapped allocator is freed here */
+    while (!heap_used.compare_exchange_weak(used, (used > size) ? used - size : 0)) {
+    }
+
+    uint32_t count = heap_allocations.load();
+
+    while (count && !heap_allocations.compare_exchange_weak(count, count - 1)) {
+    }
+}
+
+} // namespace
+
+void mbed_stats_heap_get(mbed_stats_heap_t* stats)
+{
+    memset(stats, 0, sizeof(mbed_stats_heap_t));
+
+    stats->current_size = heap_used.load();
+    stats->max_size = heap_peak.load();
+    stats->total_size = heap_total.load();
+    stats->reserved_size = heap_limit();
+    stats->alloc_cnt = heap_allocations.load();
+    stats->alloc_fail_cnt = heap_failures.load();
+}
+
+extern "C" {
+
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void __real_free(void* pointer);
+
+void* __wrap_malloc(size_t size)
+{
+    void* pointer = __real_malloc(size);
+
+    if (pointer && !heap_reserve(malloc_usable_size(pointer))) {
+        __real_free(pointer);
+        pointer = NULL;
+    }
+
+    return pointer;
+}
+
+void* __wrap_calloc(size_t count, size_t size)
+{
+    void* pointer = __real_calloc(count, size);
+
+    if (pointer && !heap_reserve(malloc_usable_size(pointer))) {
+        __real_free(pointer);
+        pointer = NULL;
+    }
+
+    return pointer;
+}
+
+void __wrap_free(void* pointer)
+{
+    if (pointer) {
+        heap_release(malloc_usable_size(pointer));
+    }
+
+    __real_free(pointer);
+}
+
+void* __wrap_realloc(void* pointer, size_t size)
+{
+    if (!pointer) {
+        return __wrap_malloc(size);
+    }
+
+    if (size == 0) {
+        __wrap_free(pointer);
+        return NULL;
+    }
+
+    size_t old_size = malloc_usable_size(pointer);
+
+    if (size <= old_size) {
+        return pointer;
+    }
+
+    void* result = __wrap_malloc(size);
+
+    if (result) {
+        memcpy(result, pointer, old_size);
+        __wrap_free(pointer);
+    }
+
+    return result;
+}
+
+} // extern "C"
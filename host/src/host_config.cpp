@@ -0,0 +1,62 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2016 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "host_config.h"
+
+#include <stdlib.h>
+
+uint64_t host_parse_size(const char* text, uint64_t fallback)
+{
+    if (!text || !*text) {
+        return fallback;
+    }
+
+    char* end = NULL;
+    uint64_t value = strtoull(text, &end, 0);
+
+    if (end == text) {
+        return fallback;
+    }
+
+    switch (*end) {
+        case 'k':
+        case 'K':
+            value *= 1024;
+            end++;
+            break;
+        case 'm':
+        case 'M':
+            value *= 1024 * 1024;
+            end++;
+            break;
+        default:
+            break;
+    }
+
+    return (*end == '\0') ? value : fallback;
+}
+
+uint64_t host_config_size(const char* name, uint64_t fallback)
+{
+    return host_parse_size(getenv(name), fallback);
+}
+
+std::string host_config_string(const char* name, const char* fallback)
+{
+    const char* value = getenv(name);
+
+    return value ? value : fallback;
+}
@@ -0,0 +1,33 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2016 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file host_config.h Environment lookups shared by the host stand-ins. */
+
+#ifndef MBED_HOST_CONFIG_H
+#define MBED_HOST_CONFIG_H
+
+#include <stdint.h>
+
+#include <string>
+
+/** Parse "4096", "0x1000", "4K" or "1M". Returns fallback when malformed. */
+uint64_t host_parse_size(const char* text, uint64_t fallback);
+
+uint64_t host_config_size(const char* name, uint64_t fallback);
+
+std::string host_config_string(const char* name, const char* fallback);
+
+#endif
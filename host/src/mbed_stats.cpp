@@ -0,0 +1,41 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2016 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "platform/mbed_stats.h"
+
+#include <string.h>
+#include <time.h>
+
+static us_timestamp_t clock_us(clockid_t clock)
+{
+    struct timespec now;
+    clock_gettime(clock, &now);
+
+    return (us_timestamp_t) now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
+static const us_timestamp_t start_us = clock_us(CLOCK_MONOTONIC);
+
+void mbed_stats_cpu_get(mbed_stats_cpu_t* stats)
+{
+    memset(stats, 0, sizeof(mbed_stats_cpu_t));
+
+    us_timestamp_t busy = clock_us(CLOCK_PROCESS_CPUTIME_ID);
+
+    stats->uptime = clock_us(CLOCK_MONOTONIC) - start_us;
+    stats->idle_time = (stats->uptime > busy) ? stats->uptime - busy : 0;
+    stats->sleep_time = stats->idle_time;
+}
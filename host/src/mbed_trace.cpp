@@ -0,0 +1,79 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2016 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "mbed_trace.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+
+static uint8_t trace_config = TRACE_ACTIVE_LEVEL_ALL;
+static void (*trace_mutex_wait)(void) = NULL;
+static void (*trace_mutex_release)(void) = NULL;
+
+int mbed_trace_init(void)
+{
+    return 0;
+}
+
+void mbed_trace_free(void)
+{
+}
+
+void mbed_trace_config_set(uint8_t config)
+{
+    trace_config = config;
+}
+
+void mbed_trace_mutex_wait_function_set(void (*mutex_wait_f)(void))
+{
+    trace_mutex_wait = mutex_wait_f;
+}
+
+void mbed_trace_mutex_release_function_set(void (*mutex_release_f)(void))
+{
+    trace_mutex_release = mutex_release_f;
+}
+
+void mbed_tracef(uint8_t dlevel, const char* grp, const char* fmt, ...)
+{
+    if ((trace_config & dlevel) == 0) {
+        return;
+    }
+
+    const char* level = "DBG ";
+    if (dlevel == TRACE_LEVEL_INFO) {
+        level = "INFO";
+    } else if (dlevel == TRACE_LEVEL_WARN) {
+        level = "WARN";
+    } else if (dlevel == TRACE_LEVEL_ERROR) {
+        level = "ERR ";
+    }
+
+    if (trace_mutex_wait) {
+        trace_mutex_wait();
+    }
+
+    va_list args;
+    va_start(args, fmt);
+    printf("[%s][%-4s]: ", level, grp);
+    vprintf(fmt, args);
+    printf("\r\n");
+    va_end(args);
+
+    if (trace_mutex_release) {
+        trace_mutex_release();
+    }
+}
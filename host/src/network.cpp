@@ -0,0 +1,564 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2016 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "netsocket/SocketAddress.h"
+#include "netsocket/NetworkInterface.h"
+#include "netsocket/TCPSocket.h"
+#include "host_config.h"
+#include "sigio_dispatcher.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <ifaddrs.h>
+#include <net/if.h>
+#include <netdb.h>
+#include <netinet/tcp.h>
+#include <netpacket/packet.h>
+#include <poll.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+/*****************************************************************************/
+/* SocketAddress                                                             */
+/*****************************************************************************/
+
+SocketAddress::SocketAddress()
+{
+    memset(&_address, 0, sizeof(_address));
+    _address.ss_family = AF_UNSPEC;
+    _ip_text[0] = '\0';
+}
+
+SocketAddress::SocketAddress(const char* addr, uint16_t port)
+    : SocketAddress()
+{
+    set_ip_address(addr);
+    set_port(port);
+}
+
+bool SocketAddress::set_ip_address(const char* addr)
+{
+    uint16_t port = get_port();
+
+    memset(&_address, 0, sizeof(_address));
+    _address.ss_family = AF_UNSPEC;
+
+    if (!addr) {
+        return false;
+    }
+
+    struct sockaddr_in* ipv4 = reinterpret_cast<struct sockaddr_in*>(&_address);
+    struct sockaddr_in6* ipv6 = reinterpret_cast<struct sockaddr_in6*>(&_address);
+
+    if (inet_pton(AF_INET, addr, &ipv4->sin_addr) == 1) {
+        ipv4->sin_family = AF_INET;
+    } else if (inet_pton(AF_INET6, addr, &ipv6->sin6_addr) == 1) {
+        ipv6->sin6_family = AF_INET6;
+    } else {
+        return false;
+    }
+
+    set_port(port);
+
+    return true;
+}
+
+void SocketAddress::set_port(uint16_t port)
+{
+    if (_address.ss_family == AF_INET6) {
+        reinterpret_cast<struct sockaddr_in6*>(&_address)->sin6_port = htons(port);
+    } else {
+        /* sin_port sits at the same offset for unspecified addresses */
+        reinterpret_cast<struct sockaddr_in*>(&_address)->sin_port = htons(port);
+    }
+}
+
+const char* SocketAddress::get_ip_address() const
+{
+    const void* raw = NULL;
+
+    if (_address.ss_family == AF_INET) {
+        raw = &reinterpret_cast<const struct sockaddr_in*>(&_address)->sin_addr;
+    } else if (_address.ss_family == AF_INET6) {
+        raw = &reinterpret_cast<const struct sockaddr_in6*>(&_address)->sin6_addr;
+    } else {
+        return NULL;
+    }
+
+    if (!inet_ntop(_address.ss_family, raw, _ip_text, sizeof(_ip_text))) {
+        return NULL;
+    }
+
+    return _ip_text;
+}
+
+uint16_t SocketAddress::get_port() const
+{
+    if (_address.ss_family == AF_INET6) {
+        return ntohs(reinterpret_cast<const struct sockaddr_in6*>(&_address)->sin6_port);
+    }
+
+    return ntohs(reinterpret_cast<const struct sockaddr_in*>(&_address)->sin_port);
+}
+
+nsapi_version_t SocketAddress::get_ip_version() const
+{
+    if (_address.ss_family == AF_INET) {
+        return NSAPI_IPv4;
+    } else if (_address.ss_family == AF_INET6) {
+        return NSAPI_IPv6;
+    }
+
+    return NSAPI_UNSPEC;
+}
+
+SocketAddress::operator bool() const
+{
+    return _address.ss_family != AF_UNSPEC;
+}
+
+const struct sockaddr* SocketAddress::get_sockaddr(socklen_t* length) const
+{
+    if (length) {
+        *length = (_address.ss_family == AF_INET6) ? sizeof(struct sockaddr_in6) : sizeof(struct sockaddr_in);
+    }
+
+    return reinterpret_cast<const struct sockaddr*>(&_address);
+}
+
+void SocketAddress::set_sockaddr(const struct sockaddr* address, socklen_t length)
+{
+    memset(&_address, 0, sizeof(_address));
+
+    if (length > sizeof(_address)) {
+        length = sizeof(_address);
+    }
+
+    memcpy(&_address, address, length);
+}
+
+bool operator==(const SocketAddress& a, const SocketAddress& b)
+{
+    if ((a.get_ip_version() != b.get_ip_version()) || (a.get_port() != b.get_port())) {
+        return false;
+    }
+
+    if (!a) {
+        return true;
+    }
+
+    return strcmp(a.get_ip_address(), b.get_ip_address()) == 0;
+}
+
+bool operator!=(const SocketAddress& a, const SocketAddress& b)
+{
+    return !(a == b);
+}
+
+/*****************************************************************************/
+/* NetworkInterface                                                          */
+/*****************************************************************************/
+
+NetworkInterface* NetworkInterface::get_default_instance()
+{
+    static EthernetInterface interface;
+
+    return &interface;
+}
+
+nsapi_error_t NetworkInterface::connect()
+{
+    return NSAPI_ERROR_OK;
+}
+
+nsapi_error_t NetworkInterface::disconnect()
+{
+    return NSAPI_ERROR_OK;
+}
+
+nsapi_error_t NetworkInterface::get_ip_address(SocketAddress* address)
+{
+    if (!address) {
+        return NSAPI_ERROR_PARAMETER;
+    }
+
+    struct ifaddrs* list = NULL;
+    if (getifaddrs(&list) == 0) {
+        for (struct ifaddrs* entry = list; entry; entry = entry->ifa_next) {
+            if (entry->ifa_addr && (entry->ifa_addr->sa_family == AF_INET) &&
+                (entry->ifa_flags & IFF_UP) && !(entry->ifa_flags & IFF_LOOPBACK)) {
+                address->set_sockaddr(entry->ifa_addr, sizeof(struct sockaddr_in));
+                freeifaddrs(list);
+                return NSAPI_ERROR_OK;
+            }
+        }
+        freeifaddrs(list);
+    }
+
+    address->set_ip_address("127.0.0.1");
+
+    return NSAPI_ERROR_OK;
+}
+
+const char* NetworkInterface::get_mac_address()
+{
+    snprintf(_mac_address, sizeof(_mac_address), "00:00:00:00:00:00");
+
+    struct ifaddrs* list = NULL;
+    if (getifaddrs(&list) == 0) {
+        for (struct ifaddrs* entry = list; entry; entry = entry->ifa_next) {
+            if (entry->ifa_addr && (entry->ifa_addr->sa_family == AF_PACKET) && !(entry->ifa_flags & IFF_LOOPBACK)) {
+                const struct sockaddr_ll* link = reinterpret_cast<const struct sockaddr_ll*>(entry->ifa_addr);
+
+                if (link->sll_halen == 6) {
+                    snprintf(_mac_address, sizeof(_mac_address), "%02x:%02x:%02x:%02x:%02x:%02x",
+                             link->sll_addr[0], link->sll_addr[1], link->sll_addr[2],
+                             link->sll_addr[3], link->sll_addr[4], link->sll_addr[5]);
+                    break;
+                }
+            }
+        }
+        freeifaddrs(list);
+    }
+
+    return _mac_address;
+}
+
+nsapi_error_t NetworkInterface::gethostbyname(const char* host, SocketAddress* address,
+                                              nsapi_version_t version, const char* interface_name)
+{
+    (void) interface_name;
+
+    if (!host || !address) {
+        return NSAPI_ERROR_PARAMETER;
+    }
+
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_family = (version == NSAPI_IPv4) ? AF_INET : (version == NSAPI_IPv6) ? AF_INET6 : AF_UNSPEC;
+
+    /* a resolver on a real link takes a round trip or more */
+    static uint64_t latency_ms = host_config_size("MBED_HOST_DNS_LATENCY_MS", 0);
+    if (latency_ms) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(latency_ms));
+    }
+
+    struct addrinfo* result = NULL;
+    if ((getaddrinfo(host, NULL, &hints, &result) != 0) || !result) {
+        return NSAPI_ERROR_DNS_FAILURE;
+    }
+
+    address->set_sockaddr(result->ai_addr, result->ai_addrlen);
+    freeaddrinfo(result);
+
+    return NSAPI_ERROR_OK;
+}
+
+/*****************************************************************************/
+/* TCPSocket                                                                 */
+/*****************************************************************************/
+
+static nsapi_error_t socket_error(int error)
+{
+    switch (error) {
+        case EAGAIN:
+            return NSAPI_ERROR_WOULD_BLOCK;
+        case ECONNRESET:
+        case EPIPE:
+            return NSAPI_ERROR_CONNECTION_LOST;
+        case ETIMEDOUT:
+            return NSAPI_ERROR_CONNECTION_TIMEOUT;
+        case ENOTCONN:
+        case ECONNREFUSED:
+        case EHOSTUNREACH:
+        case ENETUNREACH:
+            return NSAPI_ERROR_NO_CONNECTION;
+        case EMFILE:
+        case ENFILE:
+            return NSAPI_ERROR_NO_SOCKET;
+        case ENOMEM:
+        case ENOBUFS:
+            return NSAPI_ERROR_NO_MEMORY;
+        default:
+            return NSAPI_ERROR_DEVICE_ERROR;
+    }
+}
+
+TCPSocket::TCPSocket()
+    : _stack(NULL),
+      _fd(-1),
+      _connecting(false),
+      _timeout(-1),
+      _sigio_id(0)
+{
+}
+
+TCPSocket::~TCPSocket()
+{
+    close();
+}
+
+nsapi_error_t TCPSocket::open(NetworkInterface* stack)
+{
+    std::lock_guard<rtos::Mutex> lock(_lock);
+
+    if (_stack) {
+        return NSAPI_ERROR_PARAMETER;
+    }
+
+    _stack = stack;
+
+    return stack ? NSAPI_ERROR_OK : NSAPI_ERROR_PARAMETER;
+}
+
+nsapi_error_t TCPSocket::close()
+{
+    std::lock_guard<rtos::Mutex> lock(_lock);
+
+    release_descriptor();
+
+    bool was_open = (_stack != NULL);
+    _stack = NULL;
+
+    return was_open ? NSAPI_ERROR_OK : NSAPI_ERROR_NO_SOCKET;
+}
+
+void TCPSocket::release_descriptor()
+{
+    if (_sigio_id) {
+        SigioDispatcher::instance().detach(_sigio_id, _fd);
+        _sigio_id = 0;
+    }
+
+    if (_fd >= 0) {
+        ::close(_fd);
+        _fd = -1;
+    }
+
+    _connecting = false;
+}
+
+nsapi_error_t TCPSocket::connect(const SocketAddress& address)
+{
+    std::lock_guard<rtos::Mutex> lock(_lock);
+
+    if (!_stack) {
+        return NSAPI_ERROR_NO_SOCKET;
+    }
+
+    if (_fd >= 0) {
+        if (!_connecting) {
+            return NSAPI_ERROR_IS_CONNECTED;
+        }
+
+        /* non-blocking connect in progress, check how it went */
+        struct pollfd descriptor = { _fd, POLLOUT, 0 };
+        if (poll(&descriptor, 1, 0) == 0) {
+            return NSAPI_ERROR_ALREADY;
+        }
+
+        int error = 0;
+        socklen_t length = sizeof(error);
+        getsockopt(_fd, SOL_SOCKET, SO_ERROR, &error, &length);
+        _connecting = false;
+
+        if (error) {
+            release_descriptor();
+            return socket_error(error);
+        }
+
+        return NSAPI_ERROR_IS_CONNECTED;
+    }
+
+    if (!address) {
+        return NSAPI_ERROR_PARAMETER;
+    }
+
+    socklen_t length = 0;
+    const struct sockaddr* raw = address.get_sockaddr(&length);
+
+    _fd = ::socket(raw->sa_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (_fd < 0) {
+        return socket_error(errno);
+    }
+
+    if (_callback) {
+        _sigio_id = SigioDispatcher::instance().attach(_fd, _callback);
+    }
+
+    if (::connect(_fd, raw, length) == 0) {
+        return NSAPI_ERROR_OK;
+    }
+
+    if (errno != EINPROGRESS) {
+        int error = errno;
+        release_descriptor();
+        return socket_error(error);
+    }
+
+    if (_timeout == 0) {
+        _connecting = true;
+        return NSAPI_ERROR_IN_PROGRESS;
+    }
+
+    nsapi_error_t result = wait_ready(POLLOUT);
+    if (result == NSAPI_ERROR_OK) {
+        int error = 0;
+        socklen_t error_length = sizeof(error);
+        getsockopt(_fd, SOL_SOCKET, SO_ERROR, &error, &error_length);
+
+        result = error ? socket_error(error) : NSAPI_ERROR_OK;
+    } else if (result == NSAPI_ERROR_WOULD_BLOCK) {
+        result = NSAPI_ERROR_CONNECTION_TIMEOUT;
+    }
+
+    /* the socket stays open, so the caller can retry connect */
+    if (result != NSAPI_ERROR_OK) {
+        release_descriptor();
+    }
+
+    return result;
+}
+
+nsapi_error_t TCPSocket::connect(const char* host, uint16_t port)
+{
+    SocketAddress address;
+
+    nsapi_error_t result = NetworkInterface::get_default_instance()->gethostbyname(host, &address);
+    if (result != NSAPI_ERROR_OK) {
+        return result;
+    }
+
+    address.set_port(port);
+
+    return connect(address);
+}
+
+nsapi_error_t TCPSocket::wait_ready(short events)
+{
+    struct pollfd descriptor = { _fd, events, 0 };
+
+    int result = poll(&descriptor, 1, _timeout);
+
+    if (result < 0) {
+        return socket_error(errno);
+    } else if (result == 0) {
+        return NSAPI_ERROR_WOULD_BLOCK;
+    }
+
+    return NSAPI_ERROR_OK;
+}
+
+nsapi_size_or_error_t TCPSocket::send(const void* data, nsapi_size_t size)
+{
+    if (_fd < 0) {
+        return NSAPI_ERROR_NO_SOCKET;
+    }
+
+    const uint8_t* buffer = static_cast<const uint8_t*>(data);
+    nsapi_size_t sent = 0;
+
+    while (sent < size) {
+        ssize_t result = ::send(_fd, &buffer[sent], size - sent, MSG_NOSIGNAL);
+
+        if (result >= 0) {
+            sent += result;
+
+            /* non-blocking sockets report partial writes */
+            if (_timeout == 0) {
+                break;
+            }
+        } else if ((errno == EAGAIN) && (_timeout != 0)) {
+            nsapi_error_t ready = wait_ready(POLLOUT);
+            if (ready != NSAPI_ERROR_OK) {
+                return sent ? (nsapi_size_or_error_t) sent : ready;
+            }
+        } else if (errno != EINTR) {
+            return sent ? (nsapi_size_or_error_t) sent : socket_error(errno);
+        }
+    }
+
+    return sent;
+}
+
+nsapi_size_or_error_t TCPSocket::recv(void* data, nsapi_size_t size)
+{
+    if (_fd < 0) {
+        return NSAPI_ERROR_NO_SOCKET;
+    }
+
+    for (;;) {
+        ssize_t result = ::recv(_fd, data, size, 0);
+
+        if (result >= 0) {
+            return result;
+        } else if ((errno == EAGAIN) && (_timeout != 0)) {
+            nsapi_error_t ready = wait_ready(POLLIN);
+            if (ready != NSAPI_ERROR_OK) {
+                return ready;
+            }
+        } else if (errno != EINTR) {
+            return socket_error(errno);
+        }
+    }
+}
+
+void TCPSocket::set_blocking(bool blocking)
+{
+    _timeout = blocking ? -1 : 0;
+}
+
+void TCPSocket::set_timeout(int timeout)
+{
+    _timeout = (timeout < 0) ? -1 : timeout;
+}
+
+void TCPSocket::sigio(mbed::Callback<void()> func)
+{
+    std::lock_guard<rtos::Mutex> lock(_lock);
+
+    _callback = func;
+
+    if (_sigio_id) {
+        SigioDispatcher::instance().detach(_sigio_id, _fd);
+        _sigio_id = 0;
+    }
+
+    if ((_fd >= 0) && _callback) {
+        _sigio_id = SigioDispatcher::instance().attach(_fd, _callback);
+    }
+}
+
+nsapi_error_t TCPSocket::setsockopt(int level, int optname, const void* optval, unsigned optlen)
+{
+    if (_fd < 0) {
+        return NSAPI_ERROR_NO_SOCKET;
+    }
+
+    return (::setsockopt(_fd, level, optname, optval, optlen) == 0) ? NSAPI_ERROR_OK : socket_error(errno);
+}
+
+int TCPSocket::get_fd() const
+{
+    return _fd;
+}
@@ -0,0 +1,174 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2016 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "mbedtls/sha256.h"
+
+#include <string.h>
+
+static const uint32_t round_constants[64] = {
+    0x428A2F98, 0x71374491, 0xB5C0FBCF, 0xE9B5DBA5, 0x3956C25B, 0x59F111F1, 0x923F82A4, 0xAB1C5ED5,
+    0xD807AA98, 0x12835B01, 0x243185BE, 0x550C7DC3, 0x72BE5D74, 0x80DEB1FE, 0x9BDC06A7, 0xC19BF174,
+    0xE49B69C1, 0xEFBE4786, 0x0FC19DC6, 0x240CA1CC, 0x2DE92C6F, 0x4A7484AA, 0x5CB0A9DC, 0x76F988DA,
+    0x983E5152, 0xA831C66D, 0xB00327C8, 0xBF597FC7, 0xC6E00BF3, 0xD5A79147, 0x06CA6351, 0x14292967,
+    0x27B70A85, 0x2E1B2138, 0x4D2C6DFC, 0x53380D13, 0x650A7354, 0x766A0ABB, 0x81C2C92E, 0x92722C85,
+    0xA2BFE8A1, 0xA81A664B, 0xC24B8B70, 0xC76C51A3, 0xD192E819, 0xD6990624, 0xF40E3585, 0x106AA070,
+    0x19A4C116, 0x1E376C08, 0x2748774C, 0x34B0BCB5, 0x391C0CB3, 0x4ED8AA4A, 0x5B9CCA4F, 0x682E6FF3,
+    0x748F82EE, 0x78A5636F, 0x84C87814, 0x8CC70208, 0x90BEFFFA, 0xA4506CEB, 0xBEF9A3F7, 0xC67178F2,
+};
+
+static inline uint32_t rotate_right(uint32_t value, unsigned bits)
+{
+    return (value >> bits) | (value << (32 - bits));
+}
+
+static void sha256_process(mbedtls_sha256_context* ctx, const unsigned char data[64])
+{
+    uint32_t w[64];
+
+    for (int index = 0; index < 16; index++) {
+        w[index] = ((uint32_t) data[index * 4] << 24) | ((uint32_t) data[index * 4 + 1] << 16) |
+                   ((uint32_t) data[index * 4 + 2] << 8) | (uint32_t) data[index * 4 + 3];
+    }
+
+    for (int index = 16; index < 64; index++) {
+        uint32_t s0 = rotate_right(w[index - 15], 7) ^ rotate_right(w[index - 15], 18) ^ (w[index - 15] >> 3);
+        uint32_t s1 = rotate_right(w[index - 2], 17) ^ rotate_right(w[index - 2], 19) ^ (w[index - 2] >> 10);
+        w[index] = w[index - 16] + s0 + w[index - 7] + s1;
+    }
+
+    uint32_t a = ctx->state[0], b = ctx->state[1], c = ctx->state[2], d = ctx->state[3];
+    uint32_t e = ctx->state[4], f = ctx->state[5], g = ctx->state[6], h = ctx->state[7];
+
+    for (int index = 0; index < 64; index++) {
+        uint32_t s1 = rotate_right(e, 6) ^ rotate_right(e, 11) ^ rotate_right(e, 25);
+        uint32_t choose = (e & f) ^ (~e & g);
+        uint32_t t1 = h + s1 + choose + round_constants[index] + w[index];
+        uint32_t s0 = rotate_right(a, 2) ^ rotate_right(a, 13) ^ rotate_right(a, 22);
+        uint32_t majority = (a & b) ^ (a & c) ^ (b & c);
+        uint32_t t2 = s0 + majority;
+
+        h = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+    }
+
+    ctx->state[0] += a;
+    ctx->state[1] += b;
+    ctx->state[2] += c;
+    ctx->state[3] += d;
+    ctx->state[4] += e;
+    ctx->state[5] += f;
+    ctx->state[6] += g;
+    ctx->state[7] += h;
+}
+
+void mbedtls_sha256_init(mbedtls_sha256_context* ctx)
+{
+    memset(ctx, 0, sizeof(mbedtls_sha256_context));
+}
+
+void mbedtls_sha256_free(mbedtls_sha256_context* ctx)
+{
+    if (ctx) {
+        memset(ctx, 0, sizeof(mbedtls_sha256_context));
+    }
+}
+
+int mbedtls_sha256_starts_ret(mbedtls_sha256_context* ctx, int is224)
+{
+    static const uint32_t initial[8] = {
+        0x6A09E667, 0xBB67AE85, 0x3C6EF372, 0xA54FF53A, 0x510E527F, 0x9B05688C, 0x1F83D9AB, 0x5BE0CD19
+    };
+
+    if (is224) {
+        return -1;
+    }
+
+    ctx->total[0] = 0;
+    ctx->total[1] = 0;
+    ctx->is224 = 0;
+    memcpy(ctx->state, initial, sizeof(initial));
+
+    return 0;
+}
+
+int mbedtls_sha256_update_ret(mbedtls_sha256_context* ctx, const unsigned char* input, size_t ilen)
+{
+    size_t fill = ctx->total[0] & 0x3F;
+
+    /* 64 bit byte count in two words, as Mbed TLS keeps it */
+    ctx->total[0] += (uint32_t) ilen;
+    if (ctx->total[0] < (uint32_t) ilen) {
+        ctx->total[1]++;
+    }
+
+    if (fill && (ilen >= 64 - fill)) {
+        memcpy(&ctx->buffer[fill], input, 64 - fill);
+        sha256_process(ctx, ctx->buffer);
+
+        input += 64 - fill;
+        ilen -= 64 - fill;
+        fill = 0;
+    }
+
+    while (ilen >= 64) {
+        sha256_process(ctx, input);
+
+        input += 64;
+        ilen -= 64;
+    }
+
+    if (ilen) {
+        memcpy(&ctx->buffer[fill], input, ilen);
+    }
+
+    return 0;
+}
+
+int mbedtls_sha256_finish_ret(mbedtls_sha256_context* ctx, unsigned char output[32])
+{
+    size_t used = ctx->total[0] & 0x3F;
+    uint32_t high = (ctx->total[0] >> 29) | (ctx->total[1] << 3);
+    uint32_t low = ctx->total[0] << 3;
+
+    ctx->buffer[used++] = 0x80;
+
+    if (used > 56) {
+        memset(&ctx->buffer[used], 0, 64 - used);
+        sha256_process(ctx, ctx->buffer);
+        used = 0;
+    }
+
+    memset(&ctx->buffer[used], 0, 56 - used);
+
+    for (int index = 0; index < 4; index++) {
+        ctx->buffer[56 + index] = (unsigned char) (high >> (24 - index * 8));
+        ctx->buffer[60 + index] = (unsigned char) (low >> (24 - index * 8));
+    }
+
+    sha256_process(ctx, ctx->buffer);
+
+    for (int index = 0; index < 32; index++) {
+        output[index] = (unsigned char) (ctx->state[index / 4] >> (24 - (index % 4) * 8));
+    }
+
+    return 0;
+}
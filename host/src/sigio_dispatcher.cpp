@@ -0,0 +1,90 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2016 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sigio_dispatcher.h"
+
+#include <stdio.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+SigioDispatcher& SigioDispatcher::instance()
+{
+    /* never destroyed, the dispatcher thread runs until the process exits */
+    static SigioDispatcher* dispatcher = new SigioDispatcher();
+
+    return *dispatcher;
+}
+
+SigioDispatcher::SigioDispatcher()
+    : _epoll(epoll_create1(EPOLL_CLOEXEC)),
+      _next_id(1)
+{
+    if (_epoll < 0) {
+        perror("sigio: epoll_create1");
+    }
+
+    std::thread(&SigioDispatcher::run, this).detach();
+}
+
+uint64_t SigioDispatcher::attach(int fd, mbed::Callback<void()> callback)
+{
+    std::lock_guard<std::recursive_mutex> lock(_mutex);
+
+    uint64_t id = _next_id++;
+    _callbacks[id] = callback;
+
+    struct epoll_event event;
+    event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+    event.data.u64 = id;
+
+    if (epoll_ctl(_epoll, EPOLL_CTL_ADD, fd, &event) != 0) {
+        perror("sigio: epoll_ctl");
+    }
+
+    return id;
+}
+
+void SigioDispatcher::detach(uint64_t id, int fd)
+{
+    std::lock_guard<std::recursive_mutex> lock(_mutex);
+
+    if (fd >= 0) {
+        epoll_ctl(_epoll, EPOLL_CTL_DEL, fd, NULL);
+    }
+
+    _callbacks.erase(id);
+}
+
+void SigioDispatcher::run()
+{
+    struct epoll_event events[16];
+
+    for (;;) {
+        int count = epoll_wait(_epoll, events, 16, -1);
+
+        for (int index = 0; index < count; index++) {
+            std::lock_guard<std::recursive_mutex> lock(_mutex);
+
+            std::map<uint64_t, mbed::Callback<void()> >::iterator entry = _callbacks.find(events[index].data.u64);
+
+            /* the socket may have been closed since epoll_wait returned */
+            if ((entry != _callbacks.end()) && entry->second) {
+                mbed::Callback<void()> callback = entry->second;
+                callback();
+            }
+        }
+    }
+}
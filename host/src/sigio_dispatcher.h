@@ -0,0 +1,55 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2016 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MBED_HOST_SIGIO_DISPATCHER_H
+#define MBED_HOST_SIGIO_DISPATCHER_H
+
+#include "platform/Callback.h"
+
+#include <stdint.h>
+
+#include <map>
+#include <mutex>
+#include <thread>
+
+/** Delivers socket sigio callbacks from one epoll thread.
+ *
+ *  Descriptors are watched edge triggered for readability, writability and
+ *  hang-up, so a callback fires once per state change, like the network
+ *  stack thread does on target.
+ */
+class SigioDispatcher {
+public:
+    static SigioDispatcher& instance();
+
+    /** Start delivering callbacks for fd. Returns a handle for detach. */
+    uint64_t attach(int fd, mbed::Callback<void()> callback);
+
+    /** Stop delivering callbacks. Returns once no callback is in flight. */
+    void detach(uint64_t id, int fd);
+
+private:
+    SigioDispatcher();
+
+    void run();
+
+    int _epoll;
+    uint64_t _next_id;
+    std::recursive_mutex _mutex;
+    std::map<uint64_t, mbed::Callback<void()> > _callbacks;
+};
+
+#endif
@@ -0,0 +1,137 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2016 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "mbedtls/ssl.h"
+
+#include <string.h>
+
+#if MBED_HOST_TLS_OPENSSL
+
+#include <openssl/ssl.h>
+
+void mbedtls_ssl_session_init(mbedtls_ssl_session* session)
+{
+    memset(session, 0, sizeof(mbedtls_ssl_session));
+}
+
+void mbedtls_ssl_session_free(mbedtls_ssl_session* session)
+{
+    if (session->session) {
+        SSL_SESSION_free(session->session);
+    }
+
+    memset(session, 0, sizeof(mbedtls_ssl_session));
+}
+
+int mbedtls_ssl_get_session(const mbedtls_ssl_context* ssl, mbedtls_ssl_session* session)
+{
+    if (!ssl->ssl) {
+        return MBEDTLS_ERR_SSL_BAD_INPUT_DATA;
+    }
+
+    /* like Mbed TLS, the copy replaces whatever session held before */
+    mbedtls_ssl_session_free(session);
+    session->session = SSL_get1_session(ssl->ssl);
+
+    return session->session ? 0 : MBEDTLS_ERR_SSL_BAD_INPUT_DATA;
+}
+
+int mbedtls_ssl_set_session(mbedtls_ssl_context* ssl, const mbedtls_ssl_session* session)
+{
+    if (!ssl->ssl || !session->session) {
+        return MBEDTLS_ERR_SSL_BAD_INPUT_DATA;
+    }
+
+    return SSL_set_session(ssl->ssl, session->session) ? 0 : MBEDTLS_ERR_SSL_BAD_INPUT_DATA;
+}
+
+int mbedtls_ssl_session_reset(mbedtls_ssl_context* ssl)
+{
+    if (!ssl->ssl) {
+        return MBEDTLS_ERR_SSL_BAD_INPUT_DATA;
+    }
+
+    if (!SSL_clear(ssl->ssl)) {
+        return MBEDTLS_ERR_SSL_BAD_INPUT_DATA;
+    }
+
+    /* the SSL copied its options when it was created, Mbed TLS reads the
+     * configuration again on every handshake */
+    SSL_clear_options(ssl->ssl, SSL_OP_NO_TICKET);
+    SSL_set_options(ssl->ssl, SSL_CTX_get_options(ssl->conf->ctx) & SSL_OP_NO_TICKET);
+
+    return 0;
+}
+
+void mbedtls_ssl_conf_session_tickets(mbedtls_ssl_config* conf, int use_tickets)
+{
+    if (!conf->ctx) {
+        return;
+    }
+
+    if (use_tickets == MBEDTLS_SSL_SESSION_TICKETS_ENABLED) {
+        SSL_CTX_clear_options(conf->ctx, SSL_OP_NO_TICKET);
+    } else {
+        SSL_CTX_set_options(conf->ctx, SSL_OP_NO_TICKET);
+    }
+}
+
+#else /* MBED_HOST_TLS_OPENSSL */
+
+void mbedtls_ssl_session_init(mbedtls_ssl_session* session)
+{
+    memset(session, 0, sizeof(mbedtls_ssl_session));
+}
+
+void mbedtls_ssl_session_free(mbedtls_ssl_session* session)
+{
+    memset(session, 0, sizeof(mbedtls_ssl_session));
+}
+
+int mbedtls_ssl_get_session(const mbedtls_ssl_context* ssl, mbedtls_ssl_session* session)
+{
+    (void) ssl;
+    (void) session;
+    return MBEDTLS_ERR_SSL_FEATURE_UNAVAILABLE;
+}
+
+int mbedtls_ssl_set_session(mbedtls_ssl_context* ssl, const mbedtls_ssl_session* session)
+{
+    (void) ssl;
+    (void) session;
+    return MBEDTLS_ERR_SSL_FEATURE_UNAVAILABLE;
+}
+
+int mbedtls_ssl_session_reset(mbedtls_ssl_context* ssl)
+{
+    (void) ssl;
+    return MBEDTLS_ERR_SSL_FEATURE_UNAVAILABLE;
+}
+
+void mbedtls_ssl_conf_session_tickets(mbedtls_ssl_config* conf, int use_tickets)
+{
+    (void) conf;
+    (void) use_tickets;
+}
+
+#endif /* MBED_HOST_TLS_OPENSSL */
+
+/* called by TLSSocketWrapper after each full handshake */
+void mbedtls_ssl_conf_verify(mbedtls_ssl_config* conf, int (*f_vrfy)(void*, mbedtls_x509_crt*, int, uint32_t*), void* p_vrfy)
+{
+    conf->f_vrfy = f_vrfy;
+    conf->p_vrfy = p_vrfy;
+}
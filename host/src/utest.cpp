@@ -0,0 +1,247 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2016 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "utest/utest.h"
+#include "unity/unity.h"
+#include "greentea-client/test_env.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <stdarg.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <mutex>
+
+namespace {
+
+const char* current_case = "setup";
+std::mutex failure_mutex;
+
+void fail(const char* file, int line, const char* format, ...) __attribute__((format(printf, 3, 4), noreturn));
+
+void fail(const char* file, int line, const char* format, ...)
+{
+    /* only the first failing thread reports, the others wait for _Exit */
+    failure_mutex.lock();
+
+    va_list args;
+    va_start(args, format);
+    printf("%s:%d::FAIL: ", file, line);
+    vprintf(format, args);
+    printf("\r\n");
+    va_end(args);
+
+    printf(">>> '%s': 0 passed, 1 failed with reason 'Assertion Failed'\r\n", current_case);
+    printf("{{__testcase_finish;%s;0;1}}\r\n", current_case);
+    printf("{{__testcase_summary;0;1}}\r\n");
+    printf("{{end;failure}}\r\n");
+
+    fflush(stdout);
+    _Exit(1);
+}
+
+const char* message_or_empty(const char* message)
+{
+    return message ? message : "";
+}
+
+} // namespace
+
+extern "C" void UnityFail(const char* message, const char* file, int line)
+{
+    fail(file, line, "%s", message_or_empty(message));
+}
+
+extern "C" void UnityAssertEqualNumber(intmax_t expected, intmax_t actual, const char* message, const char* file, int line)
+{
+    if (expected != actual) {
+        fail(file, line, "Expected %" PRIdMAX " Was %" PRIdMAX ". %s", expected, actual, message_or_empty(message));
+    }
+}
+
+extern "C" void UnityAssertEqualUnsigned(uintmax_t expected, uintmax_t actual, const char* message, const char* file, int line)
+{
+    if (expected != actual) {
+        fail(file, line, "Expected %" PRIuMAX " Was %" PRIuMAX ". %s", expected, actual, message_or_empty(message));
+    }
+}
+
+extern "C" void UnityAssertEqualStringLen(const char* expected, const char* actual, uint32_t length,
+                                          const char* message, const char* file, int line)
+{
+    if ((expected == NULL) || (actual == NULL)) {
+        if (expected != actual) {
+            fail(file, line, "Expected string pointer to be non-NULL. %s", message_or_empty(message));
+        }
+        return;
+    }
+
+    /* same rule as Unity: compare up to length, stop once both strings end */
+    for (uint32_t index = 0; (index < length) && (expected[index] || actual[index]); index++) {
+        if (expected[index] != actual[index]) {
+            fail(file, line, "Expected '%.*s' Was '%.*s' at index %" PRIu32 ". %s",
+                 (int) (length - index > 16 ? 16 : length - index), &expected[index],
+                 (int) (length - index > 16 ? 16 : length - index), &actual[index],
+                 index, message_or_empty(message));
+        }
+    }
+}
+
+void GREENTEA_SETUP(const int timeout, const char* host_test_name)
+{
+    printf("{{__timeout;%d}}\r\n", timeout);
+    printf("{{__host_test_name;%s}}\r\n", host_test_name);
+    fflush(stdout);
+
+    /* greentea kills hung targets, the host build lets SIGALRM do it */
+    alarm(timeout);
+}
+
+void greentea_send_kv(const char* key, const char* value)
+{
+    printf("{{%s;%s}}\r\n", key, value);
+}
+
+void greentea_send_kv(const char* key, const int value)
+{
+    printf("{{%s;%d}}\r\n", key, value);
+}
+
+void greentea_send_kv(const char* key, const int passes, const int failures)
+{
+    printf("{{%s;%d;%d}}\r\n", key, passes, failures);
+}
+
+void greentea_send_kv(const char* key, const char* value, const int result)
+{
+    printf("{{%s;%s;%d}}\r\n", key, value, result);
+}
+
+void greentea_send_kv(const char* key, const char* value, const int passes, const int failures)
+{
+    printf("{{%s;%s;%d;%d}}\r\n", key, value, passes, failures);
+}
+
+namespace utest {
+namespace v1 {
+
+Case::Case(const char* description, const case_handler_t handler)
+    : _description(description),
+      _handler(handler),
+      _control_handler(NULL),
+      _call_count_handler(NULL)
+{
+}
+
+Case::Case(const char* description, const case_control_handler_t handler)
+    : _description(description),
+      _handler(NULL),
+      _control_handler(handler),
+      _call_count_handler(NULL)
+{
+}
+
+Case::Case(const char* description, const case_call_count_handler_t handler)
+    : _description(description),
+      _handler(NULL),
+      _control_handler(NULL),
+      _call_count_handler(handler)
+{
+}
+
+const char* Case::get_description() const
+{
+    return _description;
+}
+
+control_t Case::run(const size_t call_count) const
+{
+    if (_call_count_handler) {
+        return _call_count_handler(call_count);
+    } else if (_control_handler) {
+        return _control_handler();
+    } else if (_handler) {
+        _handler();
+    }
+
+    return CaseNext;
+}
+
+status_t greentea_test_setup_handler(const size_t number_of_cases)
+{
+    printf("{{__testcase_count;%u}}\r\n", (unsigned) number_of_cases);
+    printf(">>> Running %u test cases...\r\n", (unsigned) number_of_cases);
+
+    return STATUS_CONTINUE;
+}
+
+void greentea_test_teardown_handler(const size_t passed, const size_t failed, const failure_t failure)
+{
+    (void) failure;
+
+    printf("\r\n>>> Test cases: %u passed, %u failed\r\n", (unsigned) passed, (unsigned) failed);
+    printf("{{__testcase_summary;%u;%u}}\r\n", (unsigned) passed, (unsigned) failed);
+    printf("{{end;%s}}\r\n", failed ? "failure" : "success");
+    fflush(stdout);
+}
+
+bool Harness::run(const Specification& specification)
+{
+    if (specification._setup_handler(specification._length) != STATUS_CONTINUE) {
+        return false;
+    }
+
+    size_t passed = 0;
+
+    for (size_t index = 0; index < specification._length; index++) {
+        const Case& test_case = specification._cases[index];
+        current_case = test_case.get_description();
+
+        printf("\r\n>>> Running case #%u: '%s'...\r\n", (unsigned) (index + 1), current_case);
+        printf("{{__testcase_start;%s}}\r\n", current_case);
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+        size_t call_count = 1;
+        for (;;) {
+            control_t control = test_case.run(call_count);
+
+            if (control.repeat == REPEAT_NONE) {
+                break;
+            }
+            call_count++;
+        }
+
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        printf("{{__testcase_finish;%s;1;0}}\r\n", current_case);
+        printf(">>> '%s': 1 passed, 0 failed (%.3f s)\r\n", current_case, elapsed);
+        fflush(stdout);
+
+        passed++;
+    }
+
+    failure_t failure = { 0, 0 };
+    specification._teardown_handler(passed, 0, failure);
+
+    return true;
+}
+
+} // namespace v1
+} // namespace utest
@@ -0,0 +1,85 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2016 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "mbedtls/x509_crt.h"
+
+#include <string.h>
+
+#if MBED_HOST_TLS_OPENSSL
+
+#include <openssl/x509.h>
+
+void mbedtls_x509_crt_init(mbedtls_x509_crt* crt)
+{
+    memset(crt, 0, sizeof(mbedtls_x509_crt));
+}
+
+int mbedtls_x509_crt_parse_der(mbedtls_x509_crt* chain, const unsigned char* buf, size_t buflen)
+{
+    if (!chain->store) {
+        chain->store = X509_STORE_new();
+
+        if (!chain->store) {
+            return MBEDTLS_ERR_X509_ALLOC_FAILED;
+        }
+    }
+
+    const unsigned char* der = buf;
+    X509* cert = d2i_X509(NULL, &der, buflen);
+
+    if (!cert) {
+        return MBEDTLS_ERR_X509_INVALID_FORMAT;
+    }
+
+    X509_STORE_add_cert(chain->store, cert);
+    X509_free(cert);
+    chain->count++;
+
+    return 0;
+}
+
+void mbedtls_x509_crt_free(mbedtls_x509_crt* crt)
+{
+    if (crt->store) {
+        X509_STORE_free(crt->store);
+    }
+
+    memset(crt, 0, sizeof(mbedtls_x509_crt));
+}
+
+#else /* MBED_HOST_TLS_OPENSSL */
+
+void mbedtls_x509_crt_init(mbedtls_x509_crt* crt)
+{
+    memset(crt, 0, sizeof(mbedtls_x509_crt));
+}
+
+int mbedtls_x509_crt_parse_der(mbedtls_x509_crt* chain, const unsigned char* buf, size_t buflen)
+{
+    (void) buf;
+    (void) buflen;
+
+    chain->count++;
+
+    return 0;
+}
+
+void mbedtls_x509_crt_free(mbedtls_x509_crt* crt)
+{
+    memset(crt, 0, sizeof(mbedtls_x509_crt));
+}
+
+#endif /* MBED_HOST_TLS_OPENSSL */
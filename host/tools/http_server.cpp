@@ -0,0 +1,1090 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2016 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file http_server.cpp Local stand-in for the download server.
+ *
+ * Serves the protagonist datasets (alice.txt, peter.txt, elizabeth.txt,
+ * bogdan.txt, ...) from the repository root under /firmware/, the same
+ * layout as the S3 bucket the network tests use. Supports single
+ * "Range:" requests, HEAD, keep-alive, pipelined requests and optional
+ * chunked transfer encoding. Latency, jitter and bandwidth can be set for
+ * all connections, or scripted per connection from a file.
+ *
+ * /firmware/generated-<seed>-<length>.txt serves length bytes of the
+ * procedural stream from source/mbed_stress_test_generator.cpp, computed
+ * per range, so gigabyte downloads need neither a file nor memory.
+ *
+ * With OpenSSL the same content is also served over TLS 1.2, using the
+ * certificate in host/certificates, with session ID and session ticket
+ * resumption.
+ */
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "mbed_stress_test_generator.h"
+
+#if MBED_STRESS_TEST_SERVER_TLS
+#include <openssl/err.h>
+#include <openssl/pem.h>
+#include <openssl/ssl.h>
+
+#include "certificate_localhost.h"
+#endif
+
+#ifndef MBED_CONF_APP_DOWNLOAD_HTTP_PORT
+#define MBED_CONF_APP_DOWNLOAD_HTTP_PORT 8080
+#endif
+
+#ifndef MBED_CONF_APP_DOWNLOAD_HTTPS_PORT
+#define MBED_CONF_APP_DOWNLOAD_HTTPS_PORT 8443
+#endif
+
+#ifndef MBED_STRESS_TEST_ROOT
+#define MBED_STRESS_TEST_ROOT "."
+#endif
+
+#define RECEIVE_BUFFER_SIZE     2048
+#define MAX_HEADER_SIZE         (16 * 1024)
+#define MAX_SLICE_SIZE          (16 * 1024)
+#define TLS_PAIR_BUFFER_SIZE    (16 * 1024)
+
+namespace {
+
+/** Link conditions applied to one connection. */
+struct shaping_t {
+    uint32_t latency_ms;    /* delay from request arrival to response */
+    uint32_t jitter_ms;     /* random extra delay, 0 to jitter_ms */
+    uint64_t bandwidth;     /* bytes per second, 0 for unlimited */
+};
+
+struct options_t {
+    std::string bind_address;
+    uint16_t port;
+    uint16_t tls_port;
+    bool tickets;
+    std::string root;
+    shaping_t shaping;
+    std::vector<shaping_t> script;
+    bool chunked;
+    size_t chunk_size;
+    bool verbose;
+    std::string pid_file;
+};
+
+options_t options;
+std::atomic<uint32_t> connection_counter(0);
+
+/*****************************************************************************/
+/* helpers                                                                   */
+/*****************************************************************************/
+
+bool parse_number(const std::string& text, uint64_t* value)
+{
+    if (text.empty()) {
+        return false;
+    }
+
+    char* end = NULL;
+    uint64_t result = strtoull(text.c_str(), &end, 0);
+
+    if ((*end == 'k') || (*end == 'K')) {
+        result *= 1024;
+        end++;
+    } else if ((*end == 'm') || (*end == 'M')) {
+        result *= 1024 * 1024;
+        end++;
+    }
+
+    if (*end != '\0') {
+        return false;
+    }
+
+    *value = result;
+    return true;
+}
+
+std::string lower(std::string text)
+{
+    std::transform(text.begin(), text.end(), text.begin(), ::tolower);
+    return text;
+}
+
+std::string trim(const std::string& text)
+{
+    size_t start = text.find_first_not_of(" \t\r");
+    size_t end = text.find_last_not_of(" \t\r");
+
+    return (start == std::string::npos) ? std::string() : text.substr(start, end - start + 1);
+}
+
+/** Apply one "key=value" shaping setting. */
+bool parse_shaping(const std::string& key, const std::string& value, shaping_t* shaping)
+{
+    uint64_t number = 0;
+
+    if (!parse_number(value, &number)) {
+        return false;
+    }
+
+    if (key == "latency") {
+        shaping->latency_ms = number;
+    } else if (key == "jitter") {
+        shaping->jitter_ms = number;
+    } else if (key == "bandwidth") {
+        shaping->bandwidth = number;
+    } else {
+        return false;
+    }
+
+    return true;
+}
+
+/** Script file: one line per connection, "latency=50 jitter=10 bandwidth=64K".
+ *  Connections cycle through the lines, keys missing from a line use the
+ *  command line values.
+ */
+bool load_script(const char* path)
+{
+    std::ifstream file(path);
+    if (!file) {
+        fprintf(stderr, "unable to open script %s\r\n", path);
+        return false;
+    }
+
+    std::string line;
+    while (std::getline(file, line)) {
+        line = trim(line.substr(0, line.find('#')));
+        if (line.empty()) {
+            continue;
+        }
+
+        shaping_t shaping = options.shaping;
+        std::istringstream tokens(line);
+        std::string token;
+
+        while (tokens >> token) {
+            size_t equals = token.find('=');
+
+            if ((equals == std::string::npos) ||
+                !parse_shaping(token.substr(0, equals), token.substr(equals + 1), &shaping)) {
+                fprintf(stderr, "invalid script entry: %s\r\n", token.c_str());
+                return false;
+            }
+        }
+
+        options.script.push_back(shaping);
+    }
+
+    return true;
+}
+
+/*****************************************************************************/
+/* datasets                                                                  */
+/*****************************************************************************/
+
+std::mutex dataset_mutex;
+std::map<std::string, std::shared_ptr<std::string> > datasets;
+
+/** A file from the root, cached in memory, or a range of the generated stream. */
+struct dataset_t {
+    std::shared_ptr<std::string> file;
+    bool generated = false;
+    uint32_t seed = 0;
+    size_t length = 0;
+
+    bool found() const
+    {
+        return file || generated;
+    }
+
+    size_t size() const
+    {
+        return file ? file->size() : length;
+    }
+};
+
+/** Map a request target onto a dataset. */
+dataset_t load_dataset(const std::string& target)
+{
+    std::string name = target.substr(0, target.find('?'));
+    dataset_t dataset;
+
+    if (name.compare(0, 10, "/firmware/") == 0) {
+        name = name.substr(10);
+    } else if (!name.empty() && (name[0] == '/')) {
+        name = name.substr(1);
+    }
+
+    if (name.empty() || (name.find('/') != std::string::npos) || (name.find("..") != std::string::npos)) {
+        return dataset;
+    }
+
+    unsigned long seed = 0;
+    unsigned long length = 0;
+    int consumed = 0;
+
+    if ((sscanf(name.c_str(), "generated-%lu-%lu.txt%n", &seed, &length, &consumed) == 2) &&
+            (consumed == (int) name.size()) && (seed <= UINT32_MAX) && (length <= UINT32_MAX)) {
+        dataset.generated = true;
+        dataset.seed = seed;
+        dataset.length = length;
+        return dataset;
+    }
+
+    std::lock_guard<std::mutex> lock(dataset_mutex);
+
+    std::map<std::string, std::shared_ptr<std::string> >::iterator entry = datasets.find(name);
+    if (entry != datasets.end()) {
+        dataset.file = entry->second;
+        return dataset;
+    }
+
+    std::ifstream file(options.root + "/" + name, std::ios::binary);
+    if (!file) {
+        return dataset;
+    }
+
+    dataset.file = std::make_shared<std::string>(
+        std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    datasets[name] = dataset.file;
+
+    return dataset;
+}
+
+/** Parse a single "bytes=first-last" range. Returns false when unsatisfiable. */
+bool parse_range(const std::string& header, size_t length, size_t* first, size_t* last)
+{
+    std::string value = trim(header);
+
+    if ((value.compare(0, 6, "bytes=") != 0) || (value.find(',') != std::string::npos)) {
+        return false;
+    }
+
+    value = value.substr(6);
+    size_t dash = value.find('-');
+    if (dash == std::string::npos) {
+        return false;
+    }
+
+    std::string start_text = trim(value.substr(0, dash));
+    std::string end_text = trim(value.substr(dash + 1));
+    uint64_t start = 0;
+    uint64_t end = 0;
+
+    if (start_text.empty()) {
+        /* suffix range: the last N bytes */
+        if (!parse_number(end_text, &end) || (end == 0)) {
+            return false;
+        }
+
+        *first = (end > length) ? 0 : length - end;
+        *last = length - 1;
+    } else {
+        if (!parse_number(start_text, &start) || (start >= length)) {
+            return false;
+        }
+
+        if (end_text.empty() || !parse_number(end_text, &end) || (end >= length)) {
+            end = length - 1;
+        }
+
+        if (end < start) {
+            return false;
+        }
+
+        *first = start;
+        *last = end;
+    }
+
+    return true;
+}
+
+/*****************************************************************************/
+/* connection                                                                */
+/*****************************************************************************/
+
+class Connection {
+public:
+    Connection(int fd, uint32_t id, const shaping_t& shaping)
+        : _fd(fd),
+          _id(id),
+          _shaping(shaping),
+          _random(id)
+    {
+    }
+
+    ~Connection()
+    {
+        close(_fd);
+    }
+
+    /** Requests are read on their own thread and time stamped on arrival, so
+     *  latency behaves like a link delay and pipelined requests overlap it.
+     */
+    void run()
+    {
+        log("open latency=%u jitter=%u bandwidth=%llu", _shaping.latency_ms, _shaping.jitter_ms,
+            (unsigned long long) _shaping.bandwidth);
+
+        std::thread reader(&Connection::receive, this);
+
+        for (;;) {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _ready.wait(lock, [this]() { return !_requests_pending.empty() || _closed; });
+
+            if (_requests_pending.empty()) {
+                break;
+            }
+
+            request_t request = _requests_pending.front();
+            _requests_pending.pop_front();
+            lock.unlock();
+
+            if (!respond(request.text, request.arrival)) {
+                break;
+            }
+        }
+
+        shutdown(_fd, SHUT_RDWR);
+        reader.join();
+
+        log("close after %u requests", _requests);
+    }
+
+private:
+    struct request_t {
+        std::chrono::steady_clock::time_point arrival;
+        std::string text;
+    };
+
+    void receive()
+    {
+        std::string request;
+
+        while (read_request(&request)) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _requests_pending.push_back(request_t { std::chrono::steady_clock::now(), request });
+            _ready.notify_one();
+        }
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        _closed = true;
+        _ready.notify_one();
+    }
+
+    void log(const char* format, ...) __attribute__((format(printf, 2, 3)))
+    {
+        if (!options.verbose) {
+            return;
+        }
+
+        char line[256];
+        va_list args;
+        va_start(args, format);
+        vsnprintf(line, sizeof(line), format, args);
+        va_end(args);
+
+        printf("[%u] %s\r\n", _id, line);
+        fflush(stdout);
+    }
+
+    /** Read one request header block; extra bytes stay buffered for pipelining. */
+    bool read_request(std::string* request)
+    {
+        if (!read_header(request)) {
+            return false;
+        }
+
+        /* skip request bodies, nothing here expects one */
+        std::string header = lower(*request);
+        size_t field = header.find("\ncontent-length:");
+
+        if (field != std::string::npos) {
+            size_t body = strtoul(header.c_str() + field + 16, NULL, 10);
+
+            while (_buffer.size() < body) {
+                char data[RECEIVE_BUFFER_SIZE];
+                ssize_t received = recv(_fd, data, sizeof(data), 0);
+                if (received <= 0) {
+                    return false;
+                }
+                _buffer.append(data, received);
+            }
+
+            _buffer.erase(0, body);
+        }
+
+        return true;
+    }
+
+    bool read_header(std::string* request)
+    {
+        for (;;) {
+            size_t crlf = _buffer.find("\r\n\r\n");
+            size_t lf = _buffer.find("\n\n");
+            size_t end = std::min(crlf == std::string::npos ? std::string::npos : crlf + 4,
+                                  lf == std::string::npos ? std::string::npos : lf + 2);
+
+            if (end != std::string::npos) {
+                *request = _buffer.substr(0, end);
+                _buffer.erase(0, end);
+                return true;
+            }
+
+            if (_buffer.size() > MAX_HEADER_SIZE) {
+                return false;
+            }
+
+            char data[RECEIVE_BUFFER_SIZE];
+            ssize_t received = recv(_fd, data, sizeof(data), 0);
+
+            if (received <= 0) {
+                return false;
+            }
+
+            _buffer.append(data, received);
+        }
+    }
+
+    bool respond(const std::string& request, std::chrono::steady_clock::time_point arrival)
+    {
+        _requests++;
+
+        std::istringstream lines(request);
+        std::string line;
+        std::getline(lines, line);
+
+        std::istringstream request_line(trim(line));
+        std::string method;
+        std::string target;
+        std::string version;
+        request_line >> method >> target >> version;
+
+        std::map<std::string, std::string> headers;
+        while (std::getline(lines, line)) {
+            size_t colon = line.find(':');
+            if (colon != std::string::npos) {
+                headers[lower(trim(line.substr(0, colon)))] = trim(line.substr(colon + 1));
+            }
+        }
+
+        std::string connection = lower(headers["connection"]);
+        bool keep_alive = (version == "HTTP/1.0") ? (connection == "keep-alive") : (connection != "close");
+
+        delay(arrival);
+
+        if ((method != "GET") && (method != "HEAD")) {
+            return send_status(405, "Method Not Allowed", keep_alive);
+        }
+
+        dataset_t content = load_dataset(target);
+        if (!content.found()) {
+            log("%s %s -> 404", method.c_str(), target.c_str());
+            return send_status(404, "Not Found", keep_alive);
+        }
+
+        size_t first = 0;
+        size_t last = content.size() - 1;
+        bool partial = headers.count("range") > 0;
+
+        if (partial && !parse_range(headers["range"], content.size(), &first, &last)) {
+            char extra[64];
+            snprintf(extra, sizeof(extra), "Content-Range: bytes */%zu\r\n", content.size());
+            return send_status(416, "Range Not Satisfiable", keep_alive, extra);
+        }
+
+        size_t length = (content.size() == 0) ? 0 : last - first + 1;
+
+        std::string header = partial ? "HTTP/1.1 206 Partial Content\r\n" : "HTTP/1.1 200 OK\r\n";
+        header += "Content-Type: text/plain\r\n";
+        header += "Accept-Ranges: bytes\r\n";
+
+        char field[128];
+        if (partial) {
+            snprintf(field, sizeof(field), "Content-Range: bytes %zu-%zu/%zu\r\n", first, last, content.size());
+            header += field;
+        }
+
+        if (options.chunked) {
+            header += "Transfer-Encoding: chunked\r\n";
+        } else {
+            snprintf(field, sizeof(field), "Content-Length: %zu\r\n", length);
+            header += field;
+        }
+
+        header += keep_alive ? "Connection: keep-alive\r\n\r\n" : "Connection: close\r\n\r\n";
+
+        log("%s %s %zu-%zu -> %d", method.c_str(), target.c_str(), first, last, partial ? 206 : 200);
+
+        start_transfer();
+
+        if (!send_shaped(header.data(), header.size())) {
+            return false;
+        }
+
+        if (method == "HEAD") {
+            return keep_alive;
+        }
+
+        /* generated bodies are computed one slice at a time */
+        size_t block = options.chunked ? options.chunk_size : (content.generated ? MAX_SLICE_SIZE : length);
+        std::vector<char> generated(content.generated ? std::min(block, length) : 0);
+
+        for (size_t offset = 0; offset < length; offset += block) {
+            size_t size = std::min(block, length - offset);
+            const char* body = NULL;
+
+            if (content.generated) {
+                mbed_stress_test_generate(content.seed, first + offset, generated.data(), size);
+                body = generated.data();
+            } else {
+                body = content.file->data() + first + offset;
+            }
+
+            if (!options.chunked) {
+                if (!send_shaped(body, size)) {
+                    return false;
+                }
+                continue;
+            }
+
+            snprintf(field, sizeof(field), "%zx\r\n", size);
+            if (!send_shaped(field, strlen(field)) || !send_shaped(body, size) || !send_shaped("\r\n", 2)) {
+                return false;
+            }
+        }
+
+        if (options.chunked) {
+            return send_shaped("0\r\n\r\n", 5) && keep_alive;
+        }
+
+        return keep_alive;
+    }
+
+    bool send_status(int status, const char* reason, bool keep_alive, const char* extra = "")
+    {
+        char response[256];
+        int size = snprintf(response, sizeof(response),
+                            "HTTP/1.1 %d %s\r\n%sContent-Length: 0\r\nConnection: %s\r\n\r\n",
+                            status, reason, extra, keep_alive ? "keep-alive" : "close");
+
+        start_transfer();
+
+        return send_shaped(response, size) && keep_alive;
+    }
+
+    void delay(std::chrono::steady_clock::time_point arrival)
+    {
+        uint32_t delay_ms = _shaping.latency_ms;
+
+        if (_shaping.jitter_ms) {
+            delay_ms += std::uniform_int_distribution<uint32_t>(0, _shaping.jitter_ms)(_random);
+        }
+
+        std::this_thread::sleep_until(arrival + std::chrono::milliseconds(delay_ms));
+    }
+
+    void start_transfer()
+    {
+        _transfer_start = std::chrono::steady_clock::now();
+        _transfer_bytes = 0;
+    }
+
+    /** Send, pacing the bytes of the current response to the bandwidth cap. */
+    bool send_shaped(const char* data, size_t size)
+    {
+        size_t slice = MAX_SLICE_SIZE;
+
+        if (_shaping.bandwidth) {
+            /* roughly 100 slices per second keeps the pacing smooth */
+            slice = std::max<size_t>(1, std::min<uint64_t>(MAX_SLICE_SIZE, _shaping.bandwidth / 100));
+        }
+
+        while (size > 0) {
+            size_t length = std::min(slice, size);
+            ssize_t sent = send(_fd, data, length, MSG_NOSIGNAL);
+
+            if (sent < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return false;
+            }
+
+            data += sent;
+            size -= sent;
+            _transfer_bytes += sent;
+
+            if (_shaping.bandwidth) {
+                std::chrono::microseconds due((_transfer_bytes * 1000000) / _shaping.bandwidth);
+                std::this_thread::sleep_until(_transfer_start + due);
+            }
+        }
+
+        return true;
+    }
+
+    int _fd;
+    uint32_t _id;
+    shaping_t _shaping;
+    std::minstd_rand _random;
+    std::string _buffer;
+    uint32_t _requests = 0;
+    std::mutex _mutex;
+    std::condition_variable _ready;
+    std::deque<request_t> _requests_pending;
+    bool _closed = false;
+    std::chrono::steady_clock::time_point _transfer_start;
+    uint64_t _transfer_bytes = 0;
+};
+
+void usage(const char* name)
+{
+    printf("usage: %s [options]\r\n"
+           "  --port PORT          listen port (default: %u)\r\n"
+           "  --bind ADDRESS       listen address (default: 0.0.0.0)\r\n"
+           "  --tls-port PORT      TLS listen port, 0 to disable (default: %u)\r\n"
+           "  --no-tickets         resume TLS sessions by session ID only\r\n"
+           "  --root DIR           directory with the datasets (default: %s)\r\n"
+           "  --latency MS         delay from request arrival to response and per\r\n"
+           "                       client TLS handshake flight\r\n"
+           "  --jitter MS          random extra delay, 0 to MS\r\n"
+           "  --bandwidth BYTES    per connection cap in bytes per second, K and M suffixes\r\n"
+           "  --chunked            use chunked transfer encoding\r\n"
+           "  --chunk-size BYTES   chunk size for --chunked (default: 1K)\r\n"
+           "  --script FILE        per connection shaping, one line per connection:\r\n"
+           "                       \"latency=50 jitter=10 bandwidth=64K\"\r\n"
+           "  --pid-file FILE      write the process id to FILE\r\n"
+           "  --verbose            log connections and requests\r\n",
+           name, MBED_CONF_APP_DOWNLOAD_HTTP_PORT, MBED_CONF_APP_DOWNLOAD_HTTPS_PORT, MBED_STRESS_TEST_ROOT);
+}
+
+bool parse_options(int argc, char** argv)
+{
+    options.bind_address = "0.0.0.0";
+    options.port = MBED_CONF_APP_DOWNLOAD_HTTP_PORT;
+#if MBED_STRESS_TEST_SERVER_TLS
+    options.tls_port = MBED_CONF_APP_DOWNLOAD_HTTPS_PORT;
+#else
+    options.tls_port = 0;
+#endif
+    options.tickets = true;
+    options.root = MBED_STRESS_TEST_ROOT;
+    options.shaping.latency_ms = 0;
+    options.shaping.jitter_ms = 0;
+    options.shaping.bandwidth = 0;
+    options.chunked = false;
+    options.chunk_size = 1024;
+    options.verbose = false;
+
+    const char* script = NULL;
+
+    for (int index = 1; index < argc; index++) {
+        std::string option = argv[index];
+        bool has_value = (index + 1) < argc;
+        uint64_t number = 0;
+
+        if (option == "--chunked") {
+            options.chunked = true;
+        } else if (option == "--no-tickets") {
+            options.tickets = false;
+        } else if (option == "--verbose") {
+            options.verbose = true;
+        } else if (option == "--help") {
+            usage(argv[0]);
+            exit(0);
+        } else if (!has_value) {
+            usage(argv[0]);
+            return false;
+        } else if (option == "--port" && parse_number(argv[index + 1], &number)) {
+            options.port = number;
+            index++;
+        } else if (option == "--tls-port" && parse_number(argv[index + 1], &number)) {
+            options.tls_port = number;
+            index++;
+        } else if (option == "--bind") {
+            options.bind_address = argv[++index];
+        } else if (option == "--root") {
+            options.root = argv[++index];
+        } else if (option == "--latency" || option == "--jitter" || option == "--bandwidth") {
+            if (!parse_shaping(option.substr(2), argv[index + 1], &options.shaping)) {
+                usage(argv[0]);
+                return false;
+            }
+            index++;
+        } else if (option == "--chunk-size" && parse_number(argv[index + 1], &number) && number > 0) {
+            options.chunk_size = number;
+            index++;
+        } else if (option == "--script") {
+            script = argv[++index];
+        } else if (option == "--pid-file") {
+            options.pid_file = argv[++index];
+        } else {
+            usage(argv[0]);
+            return false;
+        }
+    }
+
+    /* script lines inherit the command line values, so load it last */
+    return !script || load_script(script);
+}
+
+/*****************************************************************************/
+/* listeners                                                                 */
+/*****************************************************************************/
+
+int open_listener(uint16_t port)
+{
+    int server = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (server < 0) {
+        perror("socket");
+        return -1;
+    }
+
+    int enable = 1;
+    setsockopt(server, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+
+    if (inet_pton(AF_INET, options.bind_address.c_str(), &address.sin_addr) != 1) {
+        fprintf(stderr, "invalid bind address %s\r\n", options.bind_address.c_str());
+        close(server);
+        return -1;
+    }
+
+    if (bind(server, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) != 0) {
+        perror("bind");
+        close(server);
+        return -1;
+    }
+
+    if (listen(server, 64) != 0) {
+        perror("listen");
+        close(server);
+        return -1;
+    }
+
+    return server;
+}
+
+#if MBED_STRESS_TEST_SERVER_TLS
+SSL_CTX* tls_context = NULL;
+
+/** TLS 1.2 at most, like Mbed TLS 2 on the boards, which also keeps session
+ *  ID resumption available next to session tickets.
+ */
+bool setup_tls()
+{
+    tls_context = SSL_CTX_new(TLS_server_method());
+    if (!tls_context) {
+        return false;
+    }
+
+    SSL_CTX_set_max_proto_version(tls_context, TLS1_2_VERSION);
+
+    BIO* bio = BIO_new_mem_buf(SSL_CA_PEM, -1);
+    X509* certificate = PEM_read_bio_X509(bio, NULL, NULL, NULL);
+    BIO_free(bio);
+
+    bio = BIO_new_mem_buf(SSL_SERVER_KEY_PEM, -1);
+    EVP_PKEY* key = PEM_read_bio_PrivateKey(bio, NULL, NULL, NULL);
+    BIO_free(bio);
+
+    bool loaded = certificate && key &&
+                  (SSL_CTX_use_certificate(tls_context, certificate) == 1) &&
+                  (SSL_CTX_use_PrivateKey(tls_context, key) == 1) &&
+                  (SSL_CTX_check_private_key(tls_context) == 1);
+
+    X509_free(certificate);
+    EVP_PKEY_free(key);
+
+    if (!loaded) {
+        ERR_print_errors_fp(stderr);
+        return false;
+    }
+
+    static const unsigned char session_context[] = "mbed-stress-test";
+    SSL_CTX_set_session_id_context(tls_context, session_context, sizeof(session_context) - 1);
+    SSL_CTX_set_session_cache_mode(tls_context, SSL_SESS_CACHE_SERVER);
+
+    if (!options.tickets) {
+        SSL_CTX_set_options(tls_context, SSL_OP_NO_TICKET);
+    }
+
+    return true;
+}
+
+bool send_all(int fd, const char* data, size_t size)
+{
+    while (size > 0) {
+        ssize_t sent = send(fd, data, size, MSG_NOSIGNAL);
+
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+
+        data += sent;
+        size -= sent;
+    }
+
+    return true;
+}
+
+/** Feed the next bytes from the client into the read BIO. During the
+ *  handshake they are held back by the latency, so full and resumed
+ *  handshakes cost two and one round trips like on a real link.
+ */
+bool receive_tls(int client, BIO* input, const shaping_t* delay, std::minstd_rand* random)
+{
+    char data[RECEIVE_BUFFER_SIZE];
+    ssize_t received = recv(client, data, sizeof(data), 0);
+
+    if (received <= 0) {
+        return false;
+    }
+
+    if (delay && delay->latency_ms) {
+        uint32_t delay_ms = delay->latency_ms;
+
+        if (delay->jitter_ms) {
+            delay_ms += std::uniform_int_distribution<uint32_t>(0, delay->jitter_ms)(*random);
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(delay_ms));
+    }
+
+    return BIO_write(input, data, received) == received;
+}
+
+/** Terminate TLS and pass the plain stream to a Connection over a socket pair. */
+void serve_tls(int client, uint32_t id, const shaping_t& shaping)
+{
+    SSL* ssl = SSL_new(tls_context);
+    BIO* input = BIO_new(BIO_s_mem());
+    std::minstd_rand random(id);
+    int pair[2];
+
+    /* an empty input reads as "try again", not as end of file */
+    BIO_set_mem_eof_return(input, -1);
+    SSL_set_bio(ssl, input, BIO_new_socket(client, BIO_NOCLOSE));
+
+    int status = 0;
+
+    while ((status = SSL_accept(ssl)) != 1) {
+        if ((SSL_get_error(ssl, status) != SSL_ERROR_WANT_READ) || !receive_tls(client, input, &shaping, &random)) {
+            break;
+        }
+    }
+
+    if ((status != 1) || (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, pair) != 0)) {
+        if (options.verbose) {
+            ERR_print_errors_fp(stderr);
+        }
+
+        SSL_free(ssl);
+        close(client);
+        return;
+    }
+
+    if (options.verbose) {
+        printf("[%u] tls %s\r\n", id, SSL_session_reused(ssl) ? "resumed" : "full handshake");
+        fflush(stdout);
+    }
+
+    /* small buffers keep the bandwidth pacing close to the TLS socket */
+    int size = TLS_PAIR_BUFFER_SIZE;
+    setsockopt(pair[0], SOL_SOCKET, SO_SNDBUF, &size, sizeof(size));
+    setsockopt(pair[1], SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+
+    int plain = pair[0];
+
+    std::thread([plain, id, shaping]() {
+        Connection connection(plain, id, shaping);
+        connection.run();
+    }).detach();
+
+    struct pollfd descriptors[2] = { { client, POLLIN, 0 }, { pair[1], POLLIN, 0 } };
+    char data[RECEIVE_BUFFER_SIZE];
+
+    for (;;) {
+        descriptors[0].revents = 0;
+        descriptors[1].revents = 0;
+
+        /* the handshake may have left application data in the input */
+        if ((BIO_ctrl_pending(input) == 0) && (SSL_pending(ssl) == 0) && (poll(descriptors, 2, -1) < 0)) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+
+        if (descriptors[0].revents && !receive_tls(client, input, NULL, NULL)) {
+            /* client is done sending, let the Connection finish */
+            shutdown(pair[1], SHUT_WR);
+            descriptors[0].fd = -1;
+        }
+
+        int received = 0;
+
+        while ((received = SSL_read(ssl, data, sizeof(data))) > 0) {
+            if (!send_all(pair[1], data, received)) {
+                break;
+            }
+        }
+
+        if ((received <= 0) && (SSL_get_error(ssl, received) != SSL_ERROR_WANT_READ)) {
+            shutdown(pair[1], SHUT_WR);
+            descriptors[0].fd = -1;
+        }
+
+        if (descriptors[1].revents) {
+            ssize_t length = recv(pair[1], data, sizeof(data), 0);
+
+            if ((length <= 0) || (SSL_write(ssl, data, length) != length)) {
+                break;
+            }
+        }
+    }
+
+    SSL_shutdown(ssl);
+    SSL_free(ssl);
+    close(pair[1]);
+    close(client);
+}
+#endif
+
+void serve(int server, bool tls)
+{
+    int enable = 1;
+
+    for (;;) {
+        int client = accept4(server, NULL, NULL, SOCK_CLOEXEC);
+
+        if (client < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("accept");
+            exit(1);
+        }
+
+        setsockopt(client, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+
+        uint32_t id = connection_counter++;
+        shaping_t shaping = options.script.empty() ? options.shaping : options.script[id % options.script.size()];
+
+        std::thread([client, id, shaping, tls]() {
+#if MBED_STRESS_TEST_SERVER_TLS
+            if (tls) {
+                serve_tls(client, id, shaping);
+                return;
+            }
+#else
+            (void) tls;
+#endif
+            Connection connection(client, id, shaping);
+            connection.run();
+        }).detach();
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    if (!parse_options(argc, argv)) {
+        return 1;
+    }
+
+    signal(SIGPIPE, SIG_IGN);
+
+    int server = open_listener(options.port);
+    if (server < 0) {
+        return 1;
+    }
+
+    int tls_server = -1;
+
+    if (options.tls_port) {
+#if MBED_STRESS_TEST_SERVER_TLS
+        if (!setup_tls()) {
+            fprintf(stderr, "failed to load the TLS certificate\r\n");
+            return 1;
+        }
+
+        tls_server = open_listener(options.tls_port);
+        if (tls_server < 0) {
+            return 1;
+        }
+#else
+        fprintf(stderr, "built without OpenSSL, --tls-port is not available\r\n");
+        return 1;
+#endif
+    }
+
+    if (!options.pid_file.empty()) {
+        FILE* pid = fopen(options.pid_file.c_str(), "w");
+        if (pid) {
+            fprintf(pid, "%d\n", (int) getpid());
+            fclose(pid);
+        }
+    }
+
+    printf("serving %s on %s:%u\r\n", options.root.c_str(), options.bind_address.c_str(), options.port);
+
+    if (tls_server >= 0) {
+        printf("serving TLS on %s:%u%s\r\n", options.bind_address.c_str(), options.tls_port,
+               options.tickets ? "" : " without session tickets");
+
+        std::thread(serve, tls_server, true).detach();
+    }
+
+    fflush(stdout);
+
+    serve(server, false);
+}
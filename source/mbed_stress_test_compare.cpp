@@ -0,0 +1,144 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2016 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "mbed.h"
+#include "unity/unity.h"
+
+#include <inttypes.h>
+
+#include "mbed_stress_test_compare.h"
+#include "mbed_stress_test_generator.h"
+
+#if defined(TARGET_HOST) && defined(__SSE2__)
+#include <emmintrin.h>
+#define COMPARE_SSE2 1
+#else
+#define COMPARE_SSE2 0
+#endif
+
+#define DUMP_CONTEXT 16
+#define DUMP_ROW 16
+#define GENERATED_BLOCK_SIZE 256
+
+size_t mbed_stress_test_compare(const void* expected, const void* actual, size_t length)
+{
+    const unsigned char* left = (const unsigned char*) expected;
+    const unsigned char* right = (const unsigned char*) actual;
+    size_t index = 0;
+
+#if COMPARE_SSE2
+    for (; index + 16 <= length; index += 16) {
+        __m128i a = _mm_loadu_si128((const __m128i*) &left[index]);
+        __m128i b = _mm_loadu_si128((const __m128i*) &right[index]);
+        unsigned equal = _mm_movemask_epi8(_mm_cmpeq_epi8(a, b));
+
+        if (equal != 0xFFFF) {
+            return index + __builtin_ctz(~equal);
+        }
+    }
+#else
+    /* bytes until actual is aligned, expected may stay unaligned */
+    while ((index < length) && (((uintptr_t) &right[index]) % sizeof(uint32_t))) {
+        if (left[index] != right[index]) {
+            return index;
+        }
+        index++;
+    }
+
+    for (; index + sizeof(uint32_t) <= length; index += sizeof(uint32_t)) {
+        uint32_t a;
+        uint32_t b;
+
+        /* single loads where the core allows unaligned access */
+        memcpy(&a, &left[index], sizeof(a));
+        memcpy(&b, &right[index], sizeof(b));
+
+        if (a != b) {
+            break;
+        }
+    }
+#endif
+
+    /* tail, or the word holding the mismatch */
+    for (; index < length; index++) {
+        if (left[index] != right[index]) {
+            return index;
+        }
+    }
+
+    return length;
+}
+
+static void mbed_stress_test_compare_dump_row(const char* label, const unsigned char* data, size_t first, size_t last, size_t row, size_t mismatch)
+{
+    printf("  %-8s", label);
+
+    /* first, last, row and mismatch are data set offsets, data starts at base */
+    for (size_t index = row; index < row + DUMP_ROW; index++) {
+        if ((index < first) || (index >= last)) {
+            printf("   ");
+        } else {
+            printf((index == mismatch) ? "[%02x" : ((index == mismatch + 1) ? "]%02x" : " %02x"), data[index - first]);
+        }
+    }
+
+    printf("\r\n");
+}
+
+void mbed_stress_test_compare_dump(const void* expected, const void* actual, size_t length, size_t mismatch, size_t base)
+{
+    const unsigned char* left = (const unsigned char*) expected;
+    const unsigned char* right = (const unsigned char*) actual;
+
+    size_t first = (mismatch > DUMP_CONTEXT) ? mismatch - DUMP_CONTEXT : 0;
+    size_t last = (length - mismatch > DUMP_CONTEXT) ? mismatch + DUMP_CONTEXT : length;
+
+    printf("mismatch at offset: %" PRIu32 " (0x%" PRIX32 ")\r\n", (uint32_t) (base + mismatch), (uint32_t) (base + mismatch));
+
+    /* rows aligned to the data set offset, so they line up with a hexdump of the file */
+    for (size_t row = (base + first) - ((base + first) % DUMP_ROW); row < base + last; row += DUMP_ROW) {
+        printf("%08" PRIX32 "\r\n", (uint32_t) row);
+        mbed_stress_test_compare_dump_row("expected", &left[first], base + first, base + last, row, base + mismatch);
+        mbed_stress_test_compare_dump_row("actual", &right[first], base + first, base + last, row, base + mismatch);
+    }
+}
+
+void mbed_stress_test_assert_equal(const void* expected, const void* actual, size_t length, size_t base, const char* message)
+{
+    size_t mismatch = mbed_stress_test_compare(expected, actual, length);
+
+    if (mismatch != length) {
+        mbed_stress_test_compare_dump(expected, actual, length, mismatch, base);
+        TEST_FAIL_MESSAGE(message);
+    }
+}
+
+void mbed_stress_test_assert_generated(uint32_t seed, size_t offset, const void* actual, size_t length, const char* message)
+{
+    const unsigned char* data = (const unsigned char*) actual;
+    unsigned char expected[GENERATED_BLOCK_SIZE];
+
+    for (size_t index = 0; index < length; index += GENERATED_BLOCK_SIZE) {
+        size_t block = length - index;
+
+        if (block > GENERATED_BLOCK_SIZE) {
+            block = GENERATED_BLOCK_SIZE;
+        }
+
+        mbed_stress_test_generate(seed, offset + index, expected, block);
+        mbed_stress_test_assert_equal(expected, &data[index], block, offset + index, message);
+    }
+}
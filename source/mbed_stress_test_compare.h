@@ -0,0 +1,40 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2016 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MBED_STRESS_TEST_COMPARE_H
+#define MBED_STRESS_TEST_COMPARE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Offset of the first byte where actual differs from expected, length when
+ * they are equal. Compares a word at a time once actual is aligned, and 16
+ * bytes at a time with SSE2 on the host build.
+ */
+size_t mbed_stress_test_compare(const void* expected, const void* actual, size_t length);
+
+/* print the mismatch offset and a hexdump of both buffers around it; base
+ * is where the buffers start within the data set
+ */
+void mbed_stress_test_compare_dump(const void* expected, const void* actual, size_t length, size_t mismatch, size_t base);
+
+/* fail with message, offset and hexdump unless the buffers are equal */
+void mbed_stress_test_assert_equal(const void* expected, const void* actual, size_t length, size_t base, const char* message);
+
+/* as mbed_stress_test_assert_equal, against the generated stream for seed from offset */
+void mbed_stress_test_assert_generated(uint32_t seed, size_t offset, const void* actual, size_t length, const char* message);
+
+#endif
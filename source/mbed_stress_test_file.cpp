@@ -29,8 +29,26 @@
 #include "features/storage/filesystem/FileSystem.h"
 #include "features/storage/filesystem/fat/FATFileSystem.h"
 #include "features/storage/filesystem/littlefs/LittleFileSystem.h"
+#include "platform/File.h"
 #include "unity/unity.h"
 
+#ifndef __STDC_FORMAT_MACROS
+#define __STDC_FORMAT_MACROS
+#endif
+
+#include <inttypes.h>
+
+#if defined(TARGET_HOST)
+#include <fcntl.h>
+#include <unistd.h>
+#else
+#include "platform/mbed_retarget.h"
+#endif
+
+#include "mbed_stress_test_compare.h"
+#include "mbed_stress_test_file.h"
+#include "mbed_stress_test_generator.h"
+
 #define MAX_BLOCKDEVICE_SIZE (32*1024*1024)
 
 FileSystem* set_filesystem(BlockDevice* bd)
@@ -72,7 +90,7 @@ void mbed_stress_test_format_file(void)
     mbed::bd_size_t size = bd->size();
     TEST_ASSERT_NOT_EQUAL_MESSAGE(0, size, "incorrect BlockDevice size");
 
-    printf("BlockDevice size: %llu\r\n", size);
+    printf("BlockDevice size: %" PRIu64 "\r\n", size);
 
     if (size > MAX_BLOCKDEVICE_SIZE) {
         bd = new SlicingBlockDevice(bd, 0, MAX_BLOCKDEVICE_SIZE);
@@ -81,7 +99,7 @@ void mbed_stress_test_format_file(void)
         size = bd->size();
         TEST_ASSERT_EQUAL_INT_MESSAGE(MAX_BLOCKDEVICE_SIZE, size, "incorrect SlicingBlockDevice size");
 
-        printf("Adjusted BlockDevice size: %llu\r\n", size);
+        printf("Adjusted BlockDevice size: %" PRIu64 "\r\n", size);
     }
 
     FileSystem* fs = set_filesystem(bd);
@@ -93,14 +111,14 @@ void mbed_stress_test_format_file(void)
 
 void mbed_stress_test_write_file(const char* file, size_t offset, const unsigned char* data, size_t data_length, size_t block_size)
 {
-    char filename[255] = { 0 };
-    snprintf(filename, 255, "/" MOUNT_POINT "/%s", file);
-
-    FILE* output = fopen(filename, "w+");
-    TEST_ASSERT_NOT_NULL_MESSAGE(output, "could not open file");
+    mbed_stress_test_write_file_io(file, offset, data, data_length, block_size, MBED_STRESS_TEST_FILE_STDIO, 0);
+}
 
-    int result = fseek(output, offset, SEEK_SET);
-    TEST_ASSERT_EQUAL_INT_MESSAGE(0, result, "could not seek to location");
+void mbed_stress_test_write_file_io(const char* file, size_t offset, const unsigned char* data, size_t data_length, size_t block_size,
+                                    mbed_stress_test_file_io_t io, size_t vbuf_size)
+{
+    mbed_stress_test_file_t output;
+    mbed_stress_test_file_open_io(&output, file, "w+", offset, io, vbuf_size);
 
     size_t index = 0;
     while (index < data_length)
@@ -112,29 +130,27 @@ void mbed_stress_test_write_file(const char* file, size_t offset, const unsigned
             write_length = block_size;
         }
 
-        size_t written = fwrite(&data[index], sizeof(unsigned char), write_length, output);
-        TEST_ASSERT_EQUAL_UINT_MESSAGE(write_length, written, "failed to write");
+        mbed_stress_test_file_write(&output, &data[index], write_length);
 
         index += write_length;
     }
     TEST_ASSERT_EQUAL_UINT_MESSAGE(index, data_length, "wrong length");
 
-    result = fclose(output);
-    TEST_ASSERT_EQUAL_INT_MESSAGE(0, result, "could not close file");
+    mbed_stress_test_file_close(&output);
 }
 
 void mbed_stress_test_compare_file(const char* file, size_t offset, const unsigned char* data, size_t data_length, size_t block_size)
 {
-    char filename[255] = { 0 };
-    snprintf(filename, 255, "/" MOUNT_POINT "/%s", file);
-
-    FILE* output = fopen(filename, "r");
-    TEST_ASSERT_NOT_NULL_MESSAGE(output, "could not open file");
+    mbed_stress_test_compare_file_io(file, offset, data, data_length, block_size, MBED_STRESS_TEST_FILE_STDIO, 0);
+}
 
-    int result = fseek(output, offset, SEEK_SET);
-    TEST_ASSERT_EQUAL_INT_MESSAGE(0, result, "could not seek to location");
+void mbed_stress_test_compare_file_io(const char* file, size_t offset, const unsigned char* data, size_t data_length, size_t block_size,
+                                      mbed_stress_test_file_io_t io, size_t vbuf_size)
+{
+    mbed_stress_test_file_t input;
+    mbed_stress_test_file_open_io(&input, file, "r", offset, io, vbuf_size);
 
-    char* buffer = (char*) malloc(block_size);
+    unsigned char* buffer = (unsigned char*) malloc(block_size);
     TEST_ASSERT_NOT_NULL_MESSAGE(buffer, "could not allocate buffer");
 
     size_t index = 0;
@@ -147,16 +163,15 @@ void mbed_stress_test_compare_file(const char* file, size_t offset, const unsign
             read_length = block_size;
         }
 
-        size_t read = fread(buffer, sizeof(char), read_length, output);
+        size_t read = mbed_stress_test_file_read(&input, buffer, read_length);
         TEST_ASSERT_EQUAL_MESSAGE(read, read_length, "failed to read");
-        TEST_ASSERT_EQUAL_STRING_LEN_MESSAGE(buffer, &data[index], read_length, "character mismatch");
+        mbed_stress_test_assert_equal(&data[index], buffer, read_length, index, "character mismatch");
 
         index += read_length;
     }
     TEST_ASSERT_EQUAL_UINT_MESSAGE(index, data_length, "wrong length");
 
-    result = fclose(output);
-    TEST_ASSERT_EQUAL_INT_MESSAGE(0, result, "could not close file");
+    mbed_stress_test_file_close(&input);
 
     free(buffer);
 }
@@ -180,4 +195,255 @@ size_t mbed_stress_test_read_file(const char* file, size_t offset, unsigned char
     return read;
 }
 
+/* open(2) flags for an fopen mode string */
+static int mbed_stress_test_file_flags(const char* mode)
+{
+    int flags = (mode[0] == 'r') ? O_RDONLY : O_WRONLY | O_CREAT | ((mode[0] == 'a') ? O_APPEND : O_TRUNC);
+
+    if (strchr(mode, '+'))
+    {
+        flags = (flags & ~(O_RDONLY | O_WRONLY)) | O_RDWR;
+    }
+
+    return flags;
+}
+
+void mbed_stress_test_file_open(mbed_stress_test_file_t* session, const char* file, const char* mode, size_t offset)
+{
+    mbed_stress_test_file_open_io(session, file, mode, offset, MBED_STRESS_TEST_FILE_STDIO, 0);
+}
+
+void mbed_stress_test_file_open_io(mbed_stress_test_file_t* session, const char* file, const char* mode, size_t offset,
+                                   mbed_stress_test_file_io_t io, size_t vbuf_size)
+{
+    char filename[255] = { 0 };
+    snprintf(filename, 255, "/" MOUNT_POINT "/%s", file);
+
+    memset(session, 0, sizeof(mbed_stress_test_file_t));
+    session->io = io;
+    session->fd = -1;
+
+    int result = 0;
+
+    switch (io)
+    {
+        case MBED_STRESS_TEST_FILE_STDIO:
+            session->file = fopen(filename, mode);
+            TEST_ASSERT_NOT_NULL_MESSAGE(session->file, "could not open file");
+
+            /* newlib ignores the size of a NULL buffer, so supply our own */
+            if (vbuf_size)
+            {
+                session->vbuf = (unsigned char*) malloc(vbuf_size);
+                TEST_ASSERT_NOT_NULL_MESSAGE(session->vbuf, "could not allocate buffer");
+
+                result = setvbuf(session->file, (char*) session->vbuf, _IOFBF, vbuf_size);
+                TEST_ASSERT_EQUAL_INT_MESSAGE(0, result, "could not set buffer");
+            }
+
+            result = fseek(session->file, offset, SEEK_SET);
+            break;
+
+        case MBED_STRESS_TEST_FILE_POSIX:
+            session->fd = open(filename, mbed_stress_test_file_flags(mode), 0644);
+            TEST_ASSERT_MESSAGE(session->fd >= 0, "could not open file");
+
+            result = (lseek(session->fd, offset, SEEK_SET) == (off_t) offset) ? 0 : -1;
+            break;
+
+        case MBED_STRESS_TEST_FILE_API:
+            session->handle = new File();
+            TEST_ASSERT_NOT_NULL_MESSAGE(session->handle, "could not allocate file");
+
+            result = session->handle->open(FileSystem::get_default_instance(), file, mbed_stress_test_file_flags(mode));
+            TEST_ASSERT_EQUAL_INT_MESSAGE(0, result, "could not open file");
+
+            result = (session->handle->seek(offset, SEEK_SET) == (off_t) offset) ? 0 : -1;
+            break;
+
+        default:
+            TEST_FAIL_MESSAGE("unknown file mode");
+            break;
+    }
+    TEST_ASSERT_EQUAL_INT_MESSAGE(0, result, "could not seek to location");
+
+    session->offset = offset;
+}
+
+size_t mbed_stress_test_file_read(mbed_stress_test_file_t* session, unsigned char* data, size_t length)
+{
+    size_t read = 0;
+
+    if (session->io == MBED_STRESS_TEST_FILE_STDIO)
+    {
+        TEST_ASSERT_NOT_NULL_MESSAGE(session->file, "file not open");
+
+        read = fread(data, sizeof(unsigned char), length, session->file);
+    }
+    else
+    {
+        ssize_t result;
+
+        if (session->io == MBED_STRESS_TEST_FILE_POSIX)
+        {
+            TEST_ASSERT_MESSAGE(session->fd >= 0, "file not open");
+
+            result = ::read(session->fd, data, length);
+        }
+        else
+        {
+            TEST_ASSERT_NOT_NULL_MESSAGE(session->handle, "file not open");
+
+            result = session->handle->read(data, length);
+        }
+        TEST_ASSERT_MESSAGE(result >= 0, "failed to read");
+
+        read = result;
+    }
+
+    session->offset += read;
+
+    return read;
+}
+
+void mbed_stress_test_file_write(mbed_stress_test_file_t* session, const unsigned char* data, size_t length)
+{
+    ssize_t written;
+
+    if (session->io == MBED_STRESS_TEST_FILE_STDIO)
+    {
+        TEST_ASSERT_NOT_NULL_MESSAGE(session->file, "file not open");
+
+        written = fwrite(data, sizeof(unsigned char), length, session->file);
+    }
+    else if (session->io == MBED_STRESS_TEST_FILE_POSIX)
+    {
+        TEST_ASSERT_MESSAGE(session->fd >= 0, "file not open");
+
+        written = ::write(session->fd, data, length);
+    }
+    else
+    {
+        TEST_ASSERT_NOT_NULL_MESSAGE(session->handle, "file not open");
+
+        written = session->handle->write(data, length);
+    }
+    TEST_ASSERT_EQUAL_INT_MESSAGE(length, written, "failed to write");
+
+    session->offset += written;
+}
+
+void mbed_stress_test_file_close(mbed_stress_test_file_t* session)
+{
+    int result;
+
+    if (session->io == MBED_STRESS_TEST_FILE_STDIO)
+    {
+        TEST_ASSERT_NOT_NULL_MESSAGE(session->file, "file not open");
+
+        result = fclose(session->file);
+
+        /* only after fclose has flushed through it */
+        free(session->vbuf);
+    }
+    else if (session->io == MBED_STRESS_TEST_FILE_POSIX)
+    {
+        TEST_ASSERT_MESSAGE(session->fd >= 0, "file not open");
+
+        result = ::close(session->fd);
+    }
+    else
+    {
+        TEST_ASSERT_NOT_NULL_MESSAGE(session->handle, "file not open");
+
+        result = session->handle->close();
+        delete session->handle;
+    }
+    TEST_ASSERT_EQUAL_INT_MESSAGE(0, result, "could not close file");
+
+    session->file = NULL;
+    session->vbuf = NULL;
+    session->fd = -1;
+    session->handle = NULL;
+}
+
+const char* mbed_stress_test_file_io_name(mbed_stress_test_file_io_t io)
+{
+    switch (io)
+    {
+        case MBED_STRESS_TEST_FILE_STDIO:
+            return "stdio";
+        case MBED_STRESS_TEST_FILE_POSIX:
+            return "posix";
+        case MBED_STRESS_TEST_FILE_API:
+            return "file";
+        default:
+            return "unknown";
+    }
+}
+
+void mbed_stress_test_write_file_generated(const char* file, uint32_t seed, size_t length, size_t block_size)
+{
+    char filename[255] = { 0 };
+    snprintf(filename, 255, "/" MOUNT_POINT "/%s", file);
+
+    FILE* output = fopen(filename, "w+");
+    TEST_ASSERT_NOT_NULL_MESSAGE(output, "could not open file");
+
+    unsigned char* buffer = (unsigned char*) malloc(block_size);
+    TEST_ASSERT_NOT_NULL_MESSAGE(buffer, "could not allocate buffer");
+
+    for (size_t index = 0; index < length; index += block_size)
+    {
+        size_t write_length = length - index;
+
+        if (write_length > block_size)
+        {
+            write_length = block_size;
+        }
+
+        mbed_stress_test_generate(seed, index, buffer, write_length);
+
+        size_t written = fwrite(buffer, sizeof(unsigned char), write_length, output);
+        TEST_ASSERT_EQUAL_UINT_MESSAGE(write_length, written, "failed to write");
+    }
+
+    int result = fclose(output);
+    TEST_ASSERT_EQUAL_INT_MESSAGE(0, result, "could not close file");
+
+    free(buffer);
+}
+
+void mbed_stress_test_compare_file_generated(const char* file, uint32_t seed, size_t length, size_t block_size)
+{
+    char filename[255] = { 0 };
+    snprintf(filename, 255, "/" MOUNT_POINT "/%s", file);
+
+    FILE* input = fopen(filename, "r");
+    TEST_ASSERT_NOT_NULL_MESSAGE(input, "could not open file");
+
+    unsigned char* buffer = (unsigned char*) malloc(block_size);
+    TEST_ASSERT_NOT_NULL_MESSAGE(buffer, "could not allocate buffer");
+
+    for (size_t index = 0; index < length; index += block_size)
+    {
+        size_t read_length = length - index;
+
+        if (read_length > block_size)
+        {
+            read_length = block_size;
+        }
+
+        size_t read = fread(buffer, sizeof(unsigned char), read_length, input);
+        TEST_ASSERT_EQUAL_UINT_MESSAGE(read_length, read, "failed to read");
+
+        mbed_stress_test_assert_generated(seed, index, buffer, read_length, "character mismatch");
+    }
+
+    int result = fclose(input);
+    TEST_ASSERT_EQUAL_INT_MESSAGE(0, result, "could not close file");
+
+    free(buffer);
+}
+
 #endif
@@ -14,6 +14,8 @@
  * limitations under the License.
  */
 
+#include <stdio.h>
+
 void mbed_stress_test_format_file(void);
 
 void mbed_stress_test_write_file(const char* file, size_t offset, const unsigned char* data, size_t data_length, size_t buffer_size);
@@ -21,3 +23,58 @@ void mbed_stress_test_write_file(const char* file, size_t offset, const unsigned
 void mbed_stress_test_compare_file(const char* file, size_t offset, const unsigned char* data, size_t data_length, size_t buffer_size);
 
 size_t mbed_stress_test_read_file(const char* file, size_t offset, unsigned char* data, size_t data_length);
+
+/* write length bytes of the generated stream for seed, block_size bytes per fwrite */
+void mbed_stress_test_write_file_generated(const char* file, uint32_t seed, size_t length, size_t block_size);
+
+void mbed_stress_test_compare_file_generated(const char* file, uint32_t seed, size_t length, size_t block_size);
+
+/* how the file helpers reach the file system */
+typedef enum {
+    MBED_STRESS_TEST_FILE_STDIO,    /* fopen, fread, fwrite */
+    MBED_STRESS_TEST_FILE_POSIX,    /* open, read, write */
+    MBED_STRESS_TEST_FILE_API,      /* File on the default FileSystem */
+    MBED_STRESS_TEST_FILE_IO_MODES
+} mbed_stress_test_file_io_t;
+
+namespace mbed {
+class File;
+}
+
+/* open-once handle for sequential reads or writes, so chunked callers don't
+ * pay fopen/fseek/fclose (a path lookup on LittleFS) for every chunk
+ */
+typedef struct {
+    mbed_stress_test_file_io_t io;
+    FILE* file;
+    unsigned char* vbuf;
+    int fd;
+    mbed::File* handle;
+    size_t offset;
+} mbed_stress_test_file_t;
+
+/* mode as for fopen, then seek to offset */
+void mbed_stress_test_file_open(mbed_stress_test_file_t* session, const char* file, const char* mode, size_t offset);
+
+/* as mbed_stress_test_file_open through io; vbuf_size sets a stdio buffer
+ * of that size with setvbuf, 0 keeps the C library default
+ */
+void mbed_stress_test_file_open_io(mbed_stress_test_file_t* session, const char* file, const char* mode, size_t offset,
+                                   mbed_stress_test_file_io_t io, size_t vbuf_size);
+
+/* read up to length bytes at the current offset and advance past them */
+size_t mbed_stress_test_file_read(mbed_stress_test_file_t* session, unsigned char* data, size_t length);
+
+/* write length bytes at the current offset and advance past them */
+void mbed_stress_test_file_write(mbed_stress_test_file_t* session, const unsigned char* data, size_t length);
+
+void mbed_stress_test_file_close(mbed_stress_test_file_t* session);
+
+const char* mbed_stress_test_file_io_name(mbed_stress_test_file_io_t io);
+
+/* mbed_stress_test_write_file and mbed_stress_test_compare_file through io */
+void mbed_stress_test_write_file_io(const char* file, size_t offset, const unsigned char* data, size_t data_length, size_t block_size,
+                                    mbed_stress_test_file_io_t io, size_t vbuf_size);
+
+void mbed_stress_test_compare_file_io(const char* file, size_t offset, const unsigned char* data, size_t data_length, size_t block_size,
+                                      mbed_stress_test_file_io_t io, size_t vbuf_size);
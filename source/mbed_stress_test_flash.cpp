@@ -18,15 +18,263 @@
 
 #include "mbed.h"
 #include "unity/unity.h"
+#include "greentea-client/test_env.h"
 
 #ifndef __STDC_FORMAT_MACROS
 #define __STDC_FORMAT_MACROS
 #endif
 
 #include <inttypes.h>
+#include <stddef.h>
+
+#include "mbed_stress_test_compare.h"
+#include "mbed_stress_test_flash.h"
+#include "mbed_stress_test_generator.h"
+
+/* largest program call made from the staging buffer */
+#ifndef MBED_STRESS_TEST_FLASH_STAGING_SIZE
+#define MBED_STRESS_TEST_FLASH_STAGING_SIZE 1024
+#endif
+
+/* bytes per compare call when verifying mapped flash */
+#define MBED_STRESS_TEST_FLASH_STRIDE (64*1024)
 
 FlashIAP flash;
 
+/*****************************************************************************/
+/* timing                                                                    */
+/*****************************************************************************/
+
+static mbed_stress_test_histogram_t erase_histogram = { 0, UINT32_MAX, 0, { 0 } };
+static mbed_stress_test_histogram_t program_histogram = { 0, UINT32_MAX, 0, { 0 } };
+static mbed_stress_test_flash_sector_t sector_records[MBED_STRESS_TEST_FLASH_SECTOR_RECORDS];
+static uint32_t sector_record_count = 0;
+static uint32_t sector_record_last = 0;
+
+void mbed_stress_test_histogram_init(mbed_stress_test_histogram_t* histogram)
+{
+    memset(histogram, 0, sizeof(mbed_stress_test_histogram_t));
+    histogram->min = UINT32_MAX;
+}
+
+void mbed_stress_test_histogram_add(mbed_stress_test_histogram_t* histogram, uint32_t value)
+{
+    uint32_t bucket = 0;
+
+    while ((bucket < MBED_STRESS_TEST_HISTOGRAM_BUCKETS - 1) && (value >> (bucket + 1)))
+    {
+        bucket++;
+    }
+
+    histogram->buckets[bucket]++;
+    histogram->count++;
+
+    if (value < histogram->min)
+    {
+        histogram->min = value;
+    }
+
+    if (value > histogram->max)
+    {
+        histogram->max = value;
+    }
+}
+
+uint32_t mbed_stress_test_histogram_percentile(const mbed_stress_test_histogram_t* histogram, uint32_t percent)
+{
+    if (histogram->count == 0)
+    {
+        return 0;
+    }
+
+    /* nearest rank */
+    uint32_t rank = (uint32_t) (((uint64_t) histogram->count * percent + 99) / 100);
+
+    if (rank == 0)
+    {
+        rank = 1;
+    }
+
+    uint32_t seen = 0;
+
+    for (uint32_t bucket = 0; bucket < MBED_STRESS_TEST_HISTOGRAM_BUCKETS; bucket++)
+    {
+        seen += histogram->buckets[bucket];
+
+        if (seen >= rank)
+        {
+            uint32_t upper = (uint32_t) ((2ULL << bucket) - 1);
+
+            return (upper < histogram->max) ? upper : histogram->max;
+        }
+    }
+
+    return histogram->max;
+}
+
+void mbed_stress_test_histogram_report(const char* name, const mbed_stress_test_histogram_t* histogram)
+{
+    uint32_t min = (histogram->count > 0) ? histogram->min : 0;
+
+    printf("%s: %" PRIu32 " samples, min %" PRIu32 " max %" PRIu32 "\r\n", name, histogram->count, min, histogram->max);
+
+    for (uint32_t bucket = 0; bucket < MBED_STRESS_TEST_HISTOGRAM_BUCKETS; bucket++)
+    {
+        if (histogram->buckets[bucket])
+        {
+            printf("  %10" PRIu32 " - %10" PRIu32 ": %" PRIu32 "\r\n",
+                   (bucket == 0) ? 0 : (uint32_t) (1UL << bucket), (uint32_t) ((2ULL << bucket) - 1), histogram->buckets[bucket]);
+        }
+    }
+
+    char key[48];
+
+    snprintf(key, sizeof(key), "%s_count", name);
+    greentea_send_kv(key, (int) histogram->count);
+    snprintf(key, sizeof(key), "%s_min", name);
+    greentea_send_kv(key, (int) min);
+    snprintf(key, sizeof(key), "%s_max", name);
+    greentea_send_kv(key, (int) histogram->max);
+    snprintf(key, sizeof(key), "%s_p50", name);
+    greentea_send_kv(key, (int) mbed_stress_test_histogram_percentile(histogram, 50));
+    snprintf(key, sizeof(key), "%s_p90", name);
+    greentea_send_kv(key, (int) mbed_stress_test_histogram_percentile(histogram, 90));
+    snprintf(key, sizeof(key), "%s_p99", name);
+    greentea_send_kv(key, (int) mbed_stress_test_histogram_percentile(histogram, 99));
+}
+
+void mbed_stress_test_flash_timing_reset(void)
+{
+    mbed_stress_test_histogram_init(&erase_histogram);
+    mbed_stress_test_histogram_init(&program_histogram);
+
+    sector_record_count = 0;
+    sector_record_last = 0;
+}
+
+/* record for the sector holding address, NULL once the table is full */
+static mbed_stress_test_flash_sector_t* mbed_stress_test_flash_sector(uint32_t address)
+{
+    /* sequential writes keep hitting the same sector */
+    for (uint32_t count = 0; count < sector_record_count; count++)
+    {
+        uint32_t index = (sector_record_last + count) % sector_record_count;
+        mbed_stress_test_flash_sector_t* record = &sector_records[index];
+
+        if ((address >= record->address) && (address - record->address < flash.get_sector_size(record->address)))
+        {
+            sector_record_last = index;
+            return record;
+        }
+    }
+
+    if (sector_record_count == MBED_STRESS_TEST_FLASH_SECTOR_RECORDS)
+    {
+        return NULL;
+    }
+
+    /* new sector: walk from the start of flash for its start and number */
+    uint32_t start = flash.get_flash_start();
+    uint32_t index = 0;
+
+    while (address - start >= flash.get_sector_size(start))
+    {
+        start += flash.get_sector_size(start);
+        index++;
+    }
+
+    mbed_stress_test_flash_sector_t* record = &sector_records[sector_record_count];
+    memset(record, 0, sizeof(mbed_stress_test_flash_sector_t));
+    record->address = start;
+    record->index = index;
+    record->erase_min_us = UINT32_MAX;
+
+    sector_record_last = sector_record_count;
+    sector_record_count++;
+
+    return record;
+}
+
+static void mbed_stress_test_erase_sector(uint32_t address, uint32_t size)
+{
+    Timer timer;
+    timer.start();
+
+    int result = flash.erase(address, size);
+
+    timer.stop();
+    TEST_ASSERT_EQUAL_INT_MESSAGE(0, result, "failed to erase flash");
+
+    uint32_t us = timer.elapsed_time().count();
+    mbed_stress_test_histogram_add(&erase_histogram, us);
+
+    mbed_stress_test_flash_sector_t* record = mbed_stress_test_flash_sector(address);
+
+    if (record)
+    {
+        record->erases++;
+
+        if (us < record->erase_min_us)
+        {
+            record->erase_min_us = us;
+        }
+
+        if (us > record->erase_max_us)
+        {
+            record->erase_max_us = us;
+        }
+    }
+}
+
+void mbed_stress_test_flash_timing_report(void)
+{
+    mbed_stress_test_histogram_report("flash_erase_us", &erase_histogram);
+    mbed_stress_test_histogram_report("flash_program_call_ns_per_page", &program_histogram);
+
+    printf("sector  address    erases  min us  max us  call max ns/page\r\n");
+
+    for (uint32_t count = 0; count < sector_record_count; count++)
+    {
+        const mbed_stress_test_flash_sector_t* record = &sector_records[count];
+        uint32_t erase_min_us = record->erases ? record->erase_min_us : 0;
+
+        printf("%6" PRIu32 "  %08" PRIX32 " %7" PRIu32 " %7" PRIu32 " %7" PRIu32 " %17" PRIu32 "\r\n",
+               record->index, record->address, record->erases, erase_min_us, record->erase_max_us, record->program_max_ns);
+    }
+
+    for (uint32_t count = 0; count < sector_record_count; count++)
+    {
+        const mbed_stress_test_flash_sector_t* record = &sector_records[count];
+
+        if (record->erases)
+        {
+            char key[48];
+            snprintf(key, sizeof(key), "flash_sector_%" PRIu32 "_erase_max_us", record->index);
+            greentea_send_kv(key, (int) record->erase_max_us);
+        }
+    }
+}
+
+/*****************************************************************************/
+/* erase and program                                                         */
+/*****************************************************************************/
+
+/* the last sector holds the endurance record */
+static uint32_t mbed_stress_test_endurance_address(void)
+{
+    uint32_t flash_end = flash.get_flash_start() + flash.get_flash_size();
+
+    return flash_end - flash.get_sector_size(flash_end - 1);
+}
+
+uint32_t mbed_stress_test_flash_usable_size(void)
+{
+    int result = flash.init();
+    TEST_ASSERT_EQUAL_INT_MESSAGE(0, result, "failed to initialize FlashIAP");
+
+    return mbed_stress_test_endurance_address() - flash.get_flash_start();
+}
+
 void mbed_stress_test_erase_flash(void)
 {
     int result;
@@ -53,43 +301,381 @@ void mbed_stress_test_erase_flash(void)
     TEST_ASSERT_MESSAGE(MBED_FLASH_INVALID_SIZE != last_sector_size, "invalid sector size");
 
     uint32_t start_address = flash_start + MBED_CONF_APP_ESTIMATED_APPLICATION_SIZE;
-    uint32_t erase_size = flash_size - MBED_CONF_APP_ESTIMATED_APPLICATION_SIZE;
+    uint32_t end_address = mbed_stress_test_endurance_address();
+    uint32_t erase_size = end_address - start_address;
     printf("Erase flash: %" PRIX32 " %" PRIX32 "\r\n", start_address, erase_size);
 
-    result = flash.erase(start_address, erase_size);
-    TEST_ASSERT_EQUAL_INT_MESSAGE(0, result, "failed to erase flash");
+    /* a sector at a time, so each one gets timed */
+    for (uint32_t address = start_address; address < end_address; )
+    {
+        uint32_t sector_size = flash.get_sector_size(address);
+        TEST_ASSERT_MESSAGE(MBED_FLASH_INVALID_SIZE != sector_size, "invalid sector size");
+
+        mbed_stress_test_erase_sector(address, sector_size);
+
+        address += sector_size;
+    }
 }
 
 void mbed_stress_test_write_flash(size_t offset, const unsigned char* buffer, size_t buffer_length)
+{
+    mbed_stress_test_write_flash_batch(offset, buffer, buffer_length, 0);
+}
+
+/* bytes that can go into one program call at address: to the end of its
+ * sector, no more than batch_size when that is set. batch_size is rounded
+ * up to whole pages so every call makes progress.
+ */
+static uint32_t mbed_stress_test_program_limit(uint32_t address, uint32_t batch_size)
+{
+    uint32_t sector_size = flash.get_sector_size(address);
+    TEST_ASSERT_MESSAGE(MBED_FLASH_INVALID_SIZE != sector_size, "invalid sector size");
+
+    uint32_t page_size = flash.get_page_size();
+    batch_size = ((batch_size + page_size - 1) / page_size) * page_size;
+
+    uint32_t limit = sector_size - (address % sector_size);
+
+    if (batch_size && (limit > batch_size))
+    {
+        limit = batch_size;
+    }
+
+    return limit;
+}
+
+static void mbed_stress_test_program(const unsigned char* data, uint32_t address, uint32_t size)
+{
+    Timer timer;
+    timer.start();
+
+    int result = flash.program(data, address, size);
+
+    timer.stop();
+
+    /* one sample per call, the call time averaged over its pages; single page
+     * outliers inside a batch do not show. Calls never cross a sector, so the
+     * whole call belongs to one record.
+     */
+    uint32_t pages = size / flash.get_page_size();
+    uint32_t ns = (uint32_t) ((uint64_t) timer.elapsed_time().count() * 1000 / pages);
+    mbed_stress_test_histogram_add(&program_histogram, ns);
+
+    mbed_stress_test_flash_sector_t* record = mbed_stress_test_flash_sector(address);
+
+    if (record && (ns > record->program_max_ns))
+    {
+        record->program_max_ns = ns;
+    }
+
+    if (result != 0)
+    {
+        printf("program: %" PRIX32 " %" PRIu32 "\r\n", address, size);
+    }
+    TEST_ASSERT_EQUAL_INT_MESSAGE(0, result, "failed to program flash");
+}
+
+void mbed_stress_test_write_flash_batch(size_t offset, const unsigned char* buffer, size_t buffer_length, uint32_t batch_size)
 {
     uint32_t flash_start = flash.get_flash_start();
-    uint32_t flash_size = flash.get_flash_size();
     uint32_t page_size = flash.get_page_size();
+    uint8_t erase_value = flash.get_erase_value();
 
     uint32_t start_address = flash_start + offset;
 
-    printf("program: %" PRIX32 " %u\r\n", start_address, buffer_length);
+    printf("program: %" PRIX32 " %" PRIu32 "\r\n", start_address, (uint32_t) buffer_length);
+
+    /* a page already holding data cannot be programmed again on flash with ECC */
+    TEST_ASSERT_MESSAGE((start_address % page_size) == 0, "address not page aligned");
+
+    /* the padded tail still has to fit */
+    uint32_t end_address = ((start_address + buffer_length + page_size - 1) / page_size) * page_size;
+    TEST_ASSERT_MESSAGE(end_address <= mbed_stress_test_endurance_address(), "address and data out of bounds");
+
+    uint32_t staging_size = (MBED_STRESS_TEST_FLASH_STAGING_SIZE / page_size) * page_size;
+
+    if (staging_size < page_size)
+    {
+        staging_size = page_size;
+    }
+
+    unsigned char* staging = (unsigned char*) malloc(staging_size);
+    TEST_ASSERT_NOT_NULL_MESSAGE(staging, "could not allocate buffer");
+
+    uint32_t address = start_address;
 
     size_t index = 0;
     while (index < buffer_length)
     {
-        TEST_ASSERT_MESSAGE((start_address + index + page_size) <= (flash_start + flash_size), "address and data out of bounds");
+        uint32_t limit = mbed_stress_test_program_limit(address, batch_size);
+        size_t remaining = buffer_length - index;
+
+        if ((remaining >= page_size) && (((uintptr_t) &buffer[index] % sizeof(uint32_t)) == 0))
+        {
+            /* whole pages straight from the caller's buffer */
+            uint32_t size = (remaining < limit) ? remaining : limit;
+            size = (size / page_size) * page_size;
+
+            mbed_stress_test_program(&buffer[index], address, size);
+
+            index += size;
+            address += size;
+        }
+        else
+        {
+            /* unaligned source or the tail through the staging buffer, the
+             * tail padded with the erase value so the padding stays blank
+             */
+            uint32_t size = (staging_size < limit) ? staging_size : limit;
+            size_t length = (remaining < size) ? remaining : size;
+
+            size = ((length + page_size - 1) / page_size) * page_size;
+
+            memcpy(staging, &buffer[index], length);
+            memset(&staging[length], erase_value, size - length);
+
+            mbed_stress_test_program(staging, address, size);
+
+            index += length;
+            address += size;
+        }
+    }
+
+    free(staging);
+}
+
+void mbed_stress_test_flash_writer_open(mbed_stress_test_flash_writer_t* writer, size_t offset)
+{
+    int result = flash.init();
+    TEST_ASSERT_EQUAL_INT_MESSAGE(0, result, "failed to initialize FlashIAP");
+
+    uint32_t address = flash.get_flash_start() + offset;
+
+    uint32_t sector_size = flash.get_sector_size(address);
+    TEST_ASSERT_MESSAGE(MBED_FLASH_INVALID_SIZE != sector_size, "invalid sector size");
+    TEST_ASSERT_MESSAGE((offset % sector_size) == 0, "offset not on a sector boundary");
+
+    writer->address = address;
+    writer->erased_end = address;
+    writer->erases = 0;
+}
+
+void mbed_stress_test_flash_writer_erase_ahead(mbed_stress_test_flash_writer_t* writer, size_t length)
+{
+    uint32_t flash_end = mbed_stress_test_endurance_address();
+    uint32_t end = writer->address + length;
+
+    if (end > flash_end)
+    {
+        end = flash_end;
+    }
+
+    /* one sector at a time, so each erase stall stays as short as the part allows */
+    while (writer->erased_end < end)
+    {
+        uint32_t sector_size = flash.get_sector_size(writer->erased_end);
+        TEST_ASSERT_MESSAGE(MBED_FLASH_INVALID_SIZE != sector_size, "invalid sector size");
+
+        mbed_stress_test_erase_sector(writer->erased_end, sector_size);
+
+        writer->erased_end += sector_size;
+        writer->erases++;
+    }
+}
+
+void mbed_stress_test_flash_writer_write(mbed_stress_test_flash_writer_t* writer, const unsigned char* data, size_t length)
+{
+    mbed_stress_test_flash_writer_erase_ahead(writer, length);
+
+    mbed_stress_test_write_flash_batch(writer->address - flash.get_flash_start(), data, length, 0);
+
+    writer->address += length;
+}
+
+static bool mbed_stress_test_is_blank(const unsigned char* data, size_t length, uint8_t erase_value)
+{
+    for (size_t index = 0; index < length; index++)
+    {
+        if (data[index] != erase_value)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void mbed_stress_test_write_flash_differential(size_t offset, const unsigned char* data, size_t data_length,
+                                               mbed_stress_test_flash_update_t* update)
+{
+    int result = flash.init();
+    TEST_ASSERT_EQUAL_INT_MESSAGE(0, result, "failed to initialize FlashIAP");
+
+    uint32_t flash_start = flash.get_flash_start();
+    uint32_t page_size = flash.get_page_size();
+    uint8_t erase_value = flash.get_erase_value();
+
+    uint32_t start_address = flash_start + offset;
+    TEST_ASSERT_MESSAGE((start_address + data_length) <= mbed_stress_test_endurance_address(), "address and data out of bounds");
+
+    uint32_t sector_size = flash.get_sector_size(start_address);
+    TEST_ASSERT_MESSAGE(MBED_FLASH_INVALID_SIZE != sector_size, "invalid sector size");
+    TEST_ASSERT_MESSAGE((offset % sector_size) == 0, "offset not on a sector boundary");
+
+    memset(update, 0, sizeof(mbed_stress_test_flash_update_t));
+
+    unsigned char* buffer = (unsigned char*) malloc(MBED_STRESS_TEST_FLASH_STAGING_SIZE);
+    TEST_ASSERT_NOT_NULL_MESSAGE(buffer, "could not allocate buffer");
+
+    Timer timer;
+    timer.start();
+
+    for (size_t index = 0; index < data_length; )
+    {
+        uint32_t address = start_address + index;
+
+        sector_size = flash.get_sector_size(address);
+        TEST_ASSERT_MESSAGE(MBED_FLASH_INVALID_SIZE != sector_size, "invalid sector size");
+
+        size_t length = data_length - index;
+
+        if (length > sector_size)
+        {
+            length = sector_size;
+        }
 
-        int result = flash.program(&buffer[index], start_address + index, page_size);
+        /* read back what the sector holds: the same, blank, or neither */
+        bool same = true;
+        bool blank = true;
 
-        if (result != 0)
+        for (size_t position = 0; (position < length) && (same || blank); position += MBED_STRESS_TEST_FLASH_STAGING_SIZE)
         {
-            printf("program: %" PRIX32 " %" PRIu32 "\r\n", start_address + index, page_size);
+            size_t read_length = length - position;
+
+            if (read_length > MBED_STRESS_TEST_FLASH_STAGING_SIZE)
+            {
+                read_length = MBED_STRESS_TEST_FLASH_STAGING_SIZE;
+            }
+
+            result = flash.read(buffer, address + position, read_length);
+            TEST_ASSERT_EQUAL_INT_MESSAGE(0, result, "failed to read flash");
+
+            same = same && (mbed_stress_test_compare(&data[index + position], buffer, read_length) == read_length);
+            blank = blank && mbed_stress_test_is_blank(buffer, read_length, erase_value);
+        }
+
+        update->sectors++;
+
+        if (same)
+        {
+            update->skipped++;
+        }
+        else
+        {
+            if (!blank)
+            {
+                mbed_stress_test_erase_sector(address, sector_size);
+
+                update->erases++;
+            }
+
+            /* program runs of pages, leaving out the ones that stay erased */
+            size_t run = 0;
 
+            for (size_t position = 0; position < length; position += page_size)
+            {
+                size_t page_length = length - position;
+
+                if (page_length > page_size)
+                {
+                    page_length = page_size;
+                }
+
+                if (mbed_stress_test_is_blank(&data[index + position], page_length, erase_value))
+                {
+                    if (position > run)
+                    {
+                        mbed_stress_test_write_flash_batch(offset + index + run, &data[index + run], position - run, 0);
+                    }
+
+                    run = position + page_length;
+                    update->blank_pages++;
+                }
+                else
+                {
+                    update->pages++;
+                }
+            }
+
+            if (length > run)
+            {
+                mbed_stress_test_write_flash_batch(offset + index + run, &data[index + run], length - run, 0);
+            }
         }
-        TEST_ASSERT_EQUAL_INT_MESSAGE(0, result, "failed to program flash");
 
-        index += page_size;
+        index += length;
     }
+
+    timer.stop();
+    update->us = timer.elapsed_time().count();
+
+    free(buffer);
+
+    printf("update: %" PRIu32 " sectors, %" PRIu32 " skipped, %" PRIu32 " erased, %" PRIu32 " pages programmed, %" PRIu32 " blank, %" PRIu32 " us\r\n",
+           update->sectors, update->skipped, update->erases, update->pages, update->blank_pages, update->us);
+}
+
+/* internal flash as the CPU sees it, for reads without a copy */
+static const unsigned char* mbed_stress_test_flash_mapped(uint32_t address)
+{
+#if defined(TARGET_HOST)
+    const unsigned char* mapped = (const unsigned char*) flash.host_address(address);
+    TEST_ASSERT_NOT_NULL_MESSAGE(mapped, "flash not mapped");
+
+    return mapped;
+#else
+    return (const unsigned char*) (uintptr_t) address;
+#endif
+}
+
+static mbed_stress_test_flash_verify_t mbed_stress_test_flash_verify_default(void)
+{
+    return MBED_CONF_APP_FLASH_MEMORY_MAPPED ? MBED_STRESS_TEST_FLASH_VERIFY_MAPPED : MBED_STRESS_TEST_FLASH_VERIFY_READ;
 }
 
 void mbed_stress_test_compare_flash(size_t offset, const unsigned char* data, size_t data_length)
 {
+    mbed_stress_test_compare_flash_mode(offset, data, data_length, mbed_stress_test_flash_verify_default());
+}
+
+void mbed_stress_test_compare_flash_mode(size_t offset, const unsigned char* data, size_t data_length, mbed_stress_test_flash_verify_t mode)
+{
+    if (mode == MBED_STRESS_TEST_FLASH_VERIFY_MAPPED)
+    {
+        uint32_t flash_start = flash.get_flash_start();
+        uint32_t flash_size = flash.get_flash_size();
+
+        TEST_ASSERT_MESSAGE((offset + data_length) <= flash_size, "address and data out of bounds");
+
+        const unsigned char* mapped = mbed_stress_test_flash_mapped(flash_start + offset);
+
+        printf("compare mapped: %" PRIX32 " %" PRIu32 "\r\n", (uint32_t) (flash_start + offset), (uint32_t) data_length);
+
+        for (size_t index = 0; index < data_length; index += MBED_STRESS_TEST_FLASH_STRIDE)
+        {
+            size_t length = data_length - index;
+
+            if (length > MBED_STRESS_TEST_FLASH_STRIDE)
+            {
+                length = MBED_STRESS_TEST_FLASH_STRIDE;
+            }
+
+            mbed_stress_test_assert_equal(&data[index], &mapped[index], length, index, "character mismatch");
+        }
+
+        return;
+    }
+
     uint32_t flash_start = flash.get_flash_start();
     uint32_t flash_size = flash.get_flash_size();
     uint32_t page_size = flash.get_page_size();
@@ -111,12 +697,12 @@ void mbed_stress_test_compare_flash(size_t offset, const unsigned char* data, si
 
         if ((page_size >= 1024) || (index % (page_size * 0x1000) == 0))
         {
-            printf("read: %u %" PRIu32 "\r\n", start_address + index, page_size);
+            printf("read: %" PRIu32 " %" PRIu32 "\r\n", (uint32_t) (start_address + index), page_size);
         }
 
         int result = flash.read(buffer, start_address + index, read_length);
         TEST_ASSERT_EQUAL_INT_MESSAGE(0, result, "failed to read flash");
-        TEST_ASSERT_EQUAL_STRING_LEN_MESSAGE(buffer, &data[index], read_length, "character mismatch");
+        mbed_stress_test_assert_equal(&data[index], buffer, read_length, index, "character mismatch");
 
         index += read_length;
     }
@@ -125,4 +711,329 @@ void mbed_stress_test_compare_flash(size_t offset, const unsigned char* data, si
     free(buffer);
 }
 
+void mbed_stress_test_write_flash_generated(size_t offset, uint32_t seed, size_t length)
+{
+    uint32_t flash_start = flash.get_flash_start();
+    uint32_t page_size = flash.get_page_size();
+    uint8_t erase_value = flash.get_erase_value();
+
+    uint32_t start_address = flash_start + offset;
+    TEST_ASSERT_MESSAGE((start_address % page_size) == 0, "address not page aligned");
+
+    printf("program generated: %" PRIX32 " %" PRIu32 " seed: %" PRIu32 "\r\n", start_address, (uint32_t) length, seed);
+
+    uint32_t end_address = ((start_address + length + page_size - 1) / page_size) * page_size;
+    TEST_ASSERT_MESSAGE(end_address <= mbed_stress_test_endurance_address(), "address and data out of bounds");
+
+    uint32_t staging_size = (MBED_STRESS_TEST_FLASH_STAGING_SIZE / page_size) * page_size;
+
+    if (staging_size < page_size)
+    {
+        staging_size = page_size;
+    }
+
+    unsigned char* buffer = (unsigned char*) malloc(staging_size);
+    TEST_ASSERT_NOT_NULL_MESSAGE(buffer, "could not allocate buffer");
+
+    for (size_t index = 0; index < length; )
+    {
+        uint32_t limit = mbed_stress_test_program_limit(start_address + index, 0);
+        uint32_t size = (staging_size < limit) ? staging_size : limit;
+        size_t generate_length = length - index;
+
+        if (generate_length > size)
+        {
+            generate_length = size;
+        }
+
+        size = ((generate_length + page_size - 1) / page_size) * page_size;
+
+        /* the stream is addressed by flash offset, so any page can be checked on its own */
+        memset(buffer, erase_value, size);
+        mbed_stress_test_generate(seed, offset + index, buffer, generate_length);
+
+        mbed_stress_test_program(buffer, start_address + index, size);
+
+        index += generate_length;
+    }
+
+    free(buffer);
+}
+
+void mbed_stress_test_compare_flash_generated(size_t offset, uint32_t seed, size_t length)
+{
+    uint32_t flash_start = flash.get_flash_start();
+    uint32_t page_size = flash.get_page_size();
+
+    if (mbed_stress_test_flash_verify_default() == MBED_STRESS_TEST_FLASH_VERIFY_MAPPED)
+    {
+        TEST_ASSERT_MESSAGE((offset + length) <= flash.get_flash_size(), "address and data out of bounds");
+
+        mbed_stress_test_assert_generated(seed, offset, mbed_stress_test_flash_mapped(flash_start + offset), length, "character mismatch");
+
+        return;
+    }
+
+    /* reading a page at a time is slow on parts with 8 byte pages */
+    size_t buffer_size = (page_size < 1024) ? 1024 : page_size;
+
+    unsigned char* buffer = (unsigned char*) malloc(buffer_size);
+    TEST_ASSERT_NOT_NULL_MESSAGE(buffer, "could not allocate buffer");
+
+    for (size_t index = 0; index < length; index += buffer_size)
+    {
+        size_t read_length = length - index;
+
+        if (read_length > buffer_size)
+        {
+            read_length = buffer_size;
+        }
+
+        int result = flash.read(buffer, flash_start + offset + index, read_length);
+        TEST_ASSERT_EQUAL_INT_MESSAGE(0, result, "failed to read flash");
+
+        mbed_stress_test_assert_generated(seed, offset + index, buffer, read_length, "character mismatch");
+    }
+
+    free(buffer);
+}
+
+/*****************************************************************************/
+/* endurance                                                                 */
+/*****************************************************************************/
+
+static uint32_t mbed_stress_test_endurance_checksum(const mbed_stress_test_endurance_record_t* record)
+{
+    const unsigned char* data = (const unsigned char*) record;
+    uint32_t checksum = 2166136261UL;
+
+    /* FNV-1a over everything before the checksum */
+    for (size_t index = 0; index < offsetof(mbed_stress_test_endurance_record_t, checksum); index++)
+    {
+        checksum = (checksum ^ data[index]) * 16777619UL;
+    }
+
+    return checksum;
+}
+
+static void mbed_stress_test_endurance_load(mbed_stress_test_endurance_record_t* record, size_t offset, uint32_t sectors, bool reset)
+{
+    int result = flash.read(record, mbed_stress_test_endurance_address(), sizeof(mbed_stress_test_endurance_record_t));
+    TEST_ASSERT_EQUAL_INT_MESSAGE(0, result, "failed to read flash");
+
+    bool valid = (record->magic == MBED_STRESS_TEST_ENDURANCE_MAGIC) &&
+                 (record->checksum == mbed_stress_test_endurance_checksum(record));
+
+    if (valid && !reset)
+    {
+        if ((record->offset != offset) || (record->sectors != sectors))
+        {
+            /* counts for another window, keep them until reset on purpose */
+            printf("endurance record: %" PRIu32 " cycles over %" PRIu32 " sectors from offset 0x%08" PRIX32 ", asked for %" PRIu32 " sectors from offset 0x%08" PRIX32 "\r\n",
+                   record->cycles, record->sectors, record->offset, sectors, (uint32_t) offset);
+            TEST_FAIL_MESSAGE("endurance record is for another window, set app.flash-endurance-reset to start over");
+        }
+
+        printf("endurance record: %" PRIu32 " cycles so far\r\n", record->cycles);
+        return;
+    }
+
+    if (valid)
+    {
+        printf("endurance record: reset, dropping %" PRIu32 " cycles over %" PRIu32 " sectors from offset 0x%08" PRIX32 "\r\n",
+               record->cycles, record->sectors, record->offset);
+    }
+    else
+    {
+        printf("endurance record: none, starting from zero\r\n");
+    }
+
+    memset(record, 0, sizeof(mbed_stress_test_endurance_record_t));
+    record->magic = MBED_STRESS_TEST_ENDURANCE_MAGIC;
+    record->offset = offset;
+    record->sectors = sectors;
+}
+
+static void mbed_stress_test_endurance_save(mbed_stress_test_endurance_record_t* record)
+{
+    uint32_t address = mbed_stress_test_endurance_address();
+    uint32_t page_size = flash.get_page_size();
+    uint32_t size = ((sizeof(mbed_stress_test_endurance_record_t) + page_size - 1) / page_size) * page_size;
+
+    record->checksum = mbed_stress_test_endurance_checksum(record);
+
+    /* programmed directly, the write helpers stop short of this sector */
+    unsigned char* buffer = (unsigned char*) malloc(size);
+    TEST_ASSERT_NOT_NULL_MESSAGE(buffer, "could not allocate buffer");
+
+    memset(buffer, flash.get_erase_value(), size);
+    memcpy(buffer, record, sizeof(mbed_stress_test_endurance_record_t));
+
+    mbed_stress_test_erase_sector(address, flash.get_sector_size(address));
+    mbed_stress_test_program(buffer, address, size);
+
+    free(buffer);
+}
+
+/* true when length bytes at offset hold the generated stream for seed */
+static bool mbed_stress_test_endurance_verify(size_t offset, uint32_t seed, size_t length, unsigned char* buffer, size_t buffer_size)
+{
+    uint32_t flash_start = flash.get_flash_start();
+
+    if (mbed_stress_test_flash_verify_default() == MBED_STRESS_TEST_FLASH_VERIFY_MAPPED)
+    {
+        return mbed_stress_test_generate_compare(seed, offset, mbed_stress_test_flash_mapped(flash_start + offset), length) == length;
+    }
+
+    for (size_t index = 0; index < length; index += buffer_size)
+    {
+        size_t read_length = length - index;
+
+        if (read_length > buffer_size)
+        {
+            read_length = buffer_size;
+        }
+
+        int result = flash.read(buffer, flash_start + offset + index, read_length);
+        TEST_ASSERT_EQUAL_INT_MESSAGE(0, result, "failed to read flash");
+
+        if (mbed_stress_test_generate_compare(seed, offset + index, buffer, read_length) != read_length)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+uint32_t mbed_stress_test_flash_endurance(size_t offset, uint32_t sectors, uint32_t cycles, uint32_t report_every, bool reset)
+{
+    int result = flash.init();
+    TEST_ASSERT_EQUAL_INT_MESSAGE(0, result, "failed to initialize FlashIAP");
+
+    TEST_ASSERT_MESSAGE((sectors > 0) && (sectors <= MBED_STRESS_TEST_ENDURANCE_SECTORS_MAX), "too many sectors");
+    TEST_ASSERT_MESSAGE(report_every > 0, "no report interval");
+
+    uint32_t flash_start = flash.get_flash_start();
+
+    uint32_t sector_size = flash.get_sector_size(flash_start + offset);
+    TEST_ASSERT_MESSAGE(MBED_FLASH_INVALID_SIZE != sector_size, "invalid sector size");
+    TEST_ASSERT_MESSAGE((offset % sector_size) == 0, "offset not on a sector boundary");
+
+    /* window sector starts and sizes, which may differ across the window */
+    uint32_t addresses[MBED_STRESS_TEST_ENDURANCE_SECTORS_MAX];
+    uint32_t sizes[MBED_STRESS_TEST_ENDURANCE_SECTORS_MAX];
+    uint32_t window_bytes = 0;
+
+    for (uint32_t sector = 0; sector < sectors; sector++)
+    {
+        addresses[sector] = flash_start + offset + window_bytes;
+        sizes[sector] = flash.get_sector_size(addresses[sector]);
+        TEST_ASSERT_MESSAGE(MBED_FLASH_INVALID_SIZE != sizes[sector], "window past the end of flash");
+
+        window_bytes += sizes[sector];
+    }
+    TEST_ASSERT_MESSAGE(flash_start + offset + window_bytes <= mbed_stress_test_endurance_address(), "window overlaps the endurance record");
+
+    mbed_stress_test_endurance_record_t record;
+    mbed_stress_test_endurance_load(&record, offset, sectors, reset);
+
+    unsigned char* buffer = (unsigned char*) malloc(MBED_STRESS_TEST_FLASH_STAGING_SIZE);
+    TEST_ASSERT_NOT_NULL_MESSAGE(buffer, "could not allocate buffer");
+
+    uint32_t failures = 0;
+    uint32_t interval_failures = 0;
+    uint32_t interval_cycles = 0;
+    Timer erase_timer;
+    Timer program_timer;
+    Timer verify_timer;
+
+    for (uint32_t cycle = 1; cycle <= cycles; cycle++)
+    {
+        /* new data every cycle, so every bit gets exercised */
+        uint32_t seed = record.cycles + 1;
+
+        erase_timer.start();
+        for (uint32_t sector = 0; sector < sectors; sector++)
+        {
+            mbed_stress_test_erase_sector(addresses[sector], sizes[sector]);
+            record.erases[sector]++;
+        }
+        erase_timer.stop();
+
+        program_timer.start();
+        mbed_stress_test_write_flash_generated(offset, seed, window_bytes);
+        program_timer.stop();
+
+        verify_timer.start();
+        for (uint32_t sector = 0; sector < sectors; sector++)
+        {
+            size_t sector_offset = addresses[sector] - flash_start;
+
+            if (!mbed_stress_test_endurance_verify(sector_offset, seed, sizes[sector], buffer, MBED_STRESS_TEST_FLASH_STAGING_SIZE))
+            {
+                printf("endurance: sector at %" PRIX32 " failed verification after %" PRIu32 " erases\r\n",
+                       addresses[sector], record.erases[sector]);
+                interval_failures++;
+            }
+        }
+        verify_timer.stop();
+
+        record.cycles++;
+        interval_cycles++;
+
+        if ((cycle % report_every == 0) || (cycle == cycles))
+        {
+            uint64_t bytes = (uint64_t) window_bytes * interval_cycles;
+            uint32_t erase_us = erase_timer.elapsed_time().count() / (interval_cycles * sectors);
+            uint32_t program_us = program_timer.elapsed_time().count();
+            uint32_t verify_us = verify_timer.elapsed_time().count();
+            uint32_t program_kibps = program_us ? (uint32_t) (bytes * 1000000 / 1024 / program_us) : 0;
+            uint32_t verify_kibps = verify_us ? (uint32_t) (bytes * 1000000 / 1024 / verify_us) : 0;
+            uint32_t erases_max = 0;
+
+            for (uint32_t sector = 0; sector < sectors; sector++)
+            {
+                if (record.erases[sector] > erases_max)
+                {
+                    erases_max = record.erases[sector];
+                }
+            }
+
+            printf("endurance cycle %" PRIu32 ": %" PRIu32 " erases, erase %" PRIu32 " us per sector, program %" PRIu32 " KiB/s, verify %" PRIu32 " KiB/s, %" PRIu32 " failures\r\n",
+                   record.cycles, erases_max, erase_us, program_kibps, verify_kibps, interval_failures);
+
+            char key[48];
+            snprintf(key, sizeof(key), "endurance_%" PRIu32 "_erase_us", record.cycles);
+            greentea_send_kv(key, (int) erase_us);
+            snprintf(key, sizeof(key), "endurance_%" PRIu32 "_program_kibps", record.cycles);
+            greentea_send_kv(key, (int) program_kibps);
+            snprintf(key, sizeof(key), "endurance_%" PRIu32 "_verify_kibps", record.cycles);
+            greentea_send_kv(key, (int) verify_kibps);
+            snprintf(key, sizeof(key), "endurance_%" PRIu32 "_failures", record.cycles);
+            greentea_send_kv(key, (int) interval_failures);
+
+            mbed_stress_test_endurance_save(&record);
+
+            failures += interval_failures;
+            interval_failures = 0;
+            interval_cycles = 0;
+            erase_timer.reset();
+            program_timer.reset();
+            verify_timer.reset();
+        }
+    }
+
+    free(buffer);
+
+    for (uint32_t sector = 0; sector < sectors; sector++)
+    {
+        char key[48];
+        snprintf(key, sizeof(key), "endurance_sector_%" PRIu32 "_erases", sector);
+        greentea_send_kv(key, (int) record.erases[sector]);
+    }
+
+    return failures;
+}
+
 #endif /* DEVICE_FLASH */
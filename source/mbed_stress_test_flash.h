@@ -14,8 +14,151 @@
  * limitations under the License.
  */
 
+/* bytes from the flash start up to the last sector, which holds the
+ * endurance record; erase_flash and the write helpers stay below it
+ */
+uint32_t mbed_stress_test_flash_usable_size(void);
+
+/* erase from the application end up to the endurance record */
 void mbed_stress_test_erase_flash(void);
 
+/* program data at a page aligned offset with as few program calls as the driver allows */
 void mbed_stress_test_write_flash(size_t offset, const unsigned char* data, size_t data_length);
 
+/* as mbed_stress_test_write_flash, with each program call ending at a
+ * sector boundary and covering no more than batch_size bytes, rounded up
+ * to whole pages (0: a whole sector). offset must be page aligned: every
+ * page is programmed once, as flash with ECC requires, and a partial last
+ * page is padded with the erase value. Unaligned source buffers and the
+ * tail go through a staging buffer of MBED_STRESS_TEST_FLASH_STAGING_SIZE
+ * bytes, which caps the size of those program calls.
+ */
+void mbed_stress_test_write_flash_batch(size_t offset, const unsigned char* data, size_t data_length, uint32_t batch_size);
+
+/* streaming writer that erases each sector when the write cursor first
+ * reaches it, instead of erasing the whole area up front
+ */
+typedef struct {
+    uint32_t address;       /* next address to program */
+    uint32_t erased_end;    /* every sector below this has been erased */
+    uint32_t erases;        /* sectors erased so far */
+} mbed_stress_test_flash_writer_t;
+
+/* offset must be on a sector boundary */
+void mbed_stress_test_flash_writer_open(mbed_stress_test_flash_writer_t* writer, size_t offset);
+
+/* erase whatever the next length bytes still need, then program them */
+void mbed_stress_test_flash_writer_write(mbed_stress_test_flash_writer_t* writer, const unsigned char* data, size_t length);
+
+/* erase the sectors the next length bytes will need, e.g. while the
+ * producer is still filling that buffer
+ */
+void mbed_stress_test_flash_writer_erase_ahead(mbed_stress_test_flash_writer_t* writer, size_t length);
+
+typedef struct {
+    uint32_t sectors;           /* sectors the data touches */
+    uint32_t skipped;           /* already held the data */
+    uint32_t erases;            /* needed an erase first */
+    uint32_t pages;             /* pages programmed */
+    uint32_t blank_pages;       /* all erase value, left alone */
+    uint32_t us;                /* wall time */
+} mbed_stress_test_flash_update_t;
+
+/* Program data at offset, a sector boundary, touching only what differs.
+ * Sectors that already hold the data are skipped, blank sectors are
+ * programmed without an erase, and pages that are all erase value are not
+ * programmed. A sector that has to be erased loses whatever it held past
+ * the end of data.
+ */
+void mbed_stress_test_write_flash_differential(size_t offset, const unsigned char* data, size_t data_length,
+                                               mbed_stress_test_flash_update_t* update);
+
+#ifndef MBED_CONF_APP_FLASH_MEMORY_MAPPED
+#define MBED_CONF_APP_FLASH_MEMORY_MAPPED 1
+#endif
+
+typedef enum {
+    MBED_STRESS_TEST_FLASH_VERIFY_MAPPED,   /* compare in place at the mapped address */
+    MBED_STRESS_TEST_FLASH_VERIFY_READ      /* copy out with FlashIAP::read page by page */
+} mbed_stress_test_flash_verify_t;
+
+/* verify through the mapped flash unless flash-memory-mapped is 0 */
 void mbed_stress_test_compare_flash(size_t offset, const unsigned char* data, size_t data_length);
+
+void mbed_stress_test_compare_flash_mode(size_t offset, const unsigned char* data, size_t data_length, mbed_stress_test_flash_verify_t mode);
+
+/* program length bytes of the generated stream for seed, a staging buffer at a time */
+void mbed_stress_test_write_flash_generated(size_t offset, uint32_t seed, size_t length);
+
+void mbed_stress_test_compare_flash_generated(size_t offset, uint32_t seed, size_t length);
+
+/* log2 histogram: bucket 0 holds 0 and 1, bucket n holds [2^n, 2^(n+1)) */
+#define MBED_STRESS_TEST_HISTOGRAM_BUCKETS 24
+
+typedef struct {
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint32_t buckets[MBED_STRESS_TEST_HISTOGRAM_BUCKETS];
+} mbed_stress_test_histogram_t;
+
+void mbed_stress_test_histogram_init(mbed_stress_test_histogram_t* histogram);
+
+void mbed_stress_test_histogram_add(mbed_stress_test_histogram_t* histogram, uint32_t value);
+
+/* upper bound of the bucket holding the percent'th value, no more than max */
+uint32_t mbed_stress_test_histogram_percentile(const mbed_stress_test_histogram_t* histogram, uint32_t percent);
+
+/* print the buckets and send <name>_count, _min, _max, _p50, _p90 and _p99 */
+void mbed_stress_test_histogram_report(const char* name, const mbed_stress_test_histogram_t* histogram);
+
+/* sectors with their own erase and program records, the rest only count
+ * towards the overall histograms
+ */
+#ifndef MBED_STRESS_TEST_FLASH_SECTOR_RECORDS
+#define MBED_STRESS_TEST_FLASH_SECTOR_RECORDS 256
+#endif
+
+typedef struct {
+    uint32_t address;
+    uint32_t index;             /* sector number counted from the flash start */
+    uint32_t erases;
+    uint32_t erase_min_us;
+    uint32_t erase_max_us;
+    uint32_t program_max_ns;    /* per page, averaged over a program call */
+} mbed_stress_test_flash_sector_t;
+
+/* Every erase (a sector at a time) and program call made by the flash
+ * helpers is timed: erases in us, program calls in ns per page averaged
+ * over the pages of the call.
+ */
+void mbed_stress_test_flash_timing_reset(void);
+
+/* the overall histograms, then the sector table; each sector's slowest
+ * erase goes out as flash_sector_<index>_erase_max_us
+ */
+void mbed_stress_test_flash_timing_report(void);
+
+/* endurance: erase, program and verify a window of sectors over and over,
+ * keeping per-sector erase counts in the last sector of flash so they add
+ * up across runs
+ */
+#define MBED_STRESS_TEST_ENDURANCE_SECTORS_MAX 32
+
+#define MBED_STRESS_TEST_ENDURANCE_MAGIC 0x454E4455
+
+typedef struct {
+    uint32_t magic;
+    uint32_t offset;            /* window start, from the flash start */
+    uint32_t sectors;           /* window length */
+    uint32_t cycles;            /* completed over every run */
+    uint32_t erases[MBED_STRESS_TEST_ENDURANCE_SECTORS_MAX];
+    uint32_t checksum;
+} mbed_stress_test_endurance_record_t;
+
+/* run cycles more cycles over sectors sectors from offset, reporting and
+ * saving the erase counts every report_every cycles; returns the number
+ * of sector verifications that failed. A record for another window fails
+ * the run unless reset drops it.
+ */
+uint32_t mbed_stress_test_flash_endurance(size_t offset, uint32_t sectors, uint32_t cycles, uint32_t report_every, bool reset);
@@ -0,0 +1,83 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2016 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "mbed_stress_test_generator.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#define GENERATOR_BLOCK_SIZE 64
+
+static inline uint64_t generator_word(uint32_t seed, uint64_t counter)
+{
+    /* splitmix64: Weyl sequence, then the finalizer */
+    uint64_t z = ((uint64_t) seed << 32) + (counter + 1) * 0x9E3779B97F4A7C15ull;
+
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+
+    return z ^ (z >> 31);
+}
+
+void mbed_stress_test_generate(uint32_t seed, uint64_t offset, void* data, size_t length)
+{
+    unsigned char* output = (unsigned char*) data;
+    uint64_t counter = offset / 8;
+    unsigned shift = (offset % 8) * 8;
+
+    while (length > 0) {
+        uint64_t word = generator_word(seed, counter++) >> shift;
+
+        for (; (shift < 64) && (length > 0); shift += 8, length--) {
+            *output++ = (unsigned char) word;
+            word >>= 8;
+        }
+
+        shift = 0;
+    }
+}
+
+size_t mbed_stress_test_generate_compare(uint32_t seed, uint64_t offset, const void* data, size_t length)
+{
+    const unsigned char* input = (const unsigned char*) data;
+    unsigned char expected[GENERATOR_BLOCK_SIZE];
+
+    for (size_t index = 0; index < length; index += GENERATOR_BLOCK_SIZE) {
+        size_t block = length - index;
+
+        if (block > GENERATOR_BLOCK_SIZE) {
+            block = GENERATOR_BLOCK_SIZE;
+        }
+
+        mbed_stress_test_generate(seed, offset + index, expected, block);
+
+        if (memcmp(expected, &input[index], block) != 0) {
+            for (size_t position = 0; position < block; position++) {
+                if (expected[position] != input[index + position]) {
+                    return index + position;
+                }
+            }
+        }
+    }
+
+    return length;
+}
+
+void mbed_stress_test_generated_name(char* name, size_t size, uint32_t seed, uint32_t length)
+{
+    snprintf(name, size, "generated-%" PRIu32 "-%" PRIu32, seed, length);
+}
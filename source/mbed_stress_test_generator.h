@@ -0,0 +1,38 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2016 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MBED_STRESS_TEST_GENERATOR_H
+#define MBED_STRESS_TEST_GENERATOR_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Endless pseudo-random stream keyed by seed. Word n is the splitmix64
+ * output for counter n, so any byte range is computed on its own, with no
+ * state and no reference copy. Words are laid out little-endian everywhere,
+ * so targets, the host and the download server agree on every byte.
+ */
+void mbed_stress_test_generate(uint32_t seed, uint64_t offset, void* data, size_t length);
+
+/* index of the first byte of data that differs from the stream, length when all match */
+size_t mbed_stress_test_generate_compare(uint32_t seed, uint64_t offset, const void* data, size_t length);
+
+#define MBED_STRESS_TEST_GENERATED_NAME_SIZE 32
+
+/* name the download server serves length bytes of the stream under, without ".txt" */
+void mbed_stress_test_generated_name(char* name, size_t size, uint32_t seed, uint32_t length);
+
+#endif
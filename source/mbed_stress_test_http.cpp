@@ -0,0 +1,240 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2016 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "mbed.h"
+#include <ctype.h>
+#include <strings.h>
+#include "mbed_stress_test_http.h"
+
+void mbed_stress_test_http_init(mbed_stress_test_http_t* http, mbed_stress_test_http_body_t body, void* context)
+{
+    memset(http, 0, sizeof(mbed_stress_test_http_t));
+
+    http->state = MBED_STRESS_TEST_HTTP_STATUS_LINE;
+    http->body = body;
+    http->context = context;
+}
+
+static void mbed_stress_test_http_status_line(mbed_stress_test_http_t* http)
+{
+    unsigned int major = 0;
+    unsigned int minor = 0;
+    unsigned int status = 0;
+
+    /* tolerate empty lines before the status line */
+    if (http->line_length == 0) {
+        return;
+    }
+
+    if (sscanf(http->line, "HTTP/%u.%u %u", &major, &minor, &status) != 3) {
+        http->state = MBED_STRESS_TEST_HTTP_ERROR;
+        return;
+    }
+
+    http->status = status;
+    http->keep_alive = (major > 1) || (minor >= 1);
+    http->state = MBED_STRESS_TEST_HTTP_HEADER;
+}
+
+static void mbed_stress_test_http_header_end(mbed_stress_test_http_t* http)
+{
+    if ((http->status >= 100) && (http->status < 200)) {
+        /* interim response, the real one follows */
+        mbed_stress_test_http_init(http, http->body, http->context);
+    } else if ((http->status == 204) || (http->status == 304)) {
+        http->state = MBED_STRESS_TEST_HTTP_DONE;
+    } else if (http->chunked) {
+        http->state = MBED_STRESS_TEST_HTTP_CHUNK_SIZE;
+    } else if (http->has_content_length) {
+        http->remaining = http->content_length;
+        http->state = http->remaining ? MBED_STRESS_TEST_HTTP_BODY : MBED_STRESS_TEST_HTTP_DONE;
+    } else {
+        http->keep_alive = false;
+        http->state = MBED_STRESS_TEST_HTTP_BODY_UNTIL_CLOSE;
+    }
+}
+
+static void mbed_stress_test_http_header(mbed_stress_test_http_t* http)
+{
+    if (http->line_length == 0) {
+        mbed_stress_test_http_header_end(http);
+        return;
+    }
+
+    char* value = strchr(http->line, ':');
+    if (value == NULL) {
+        return;
+    }
+
+    *value++ = '\0';
+    while ((*value == ' ') || (*value == '\t')) {
+        value++;
+    }
+
+    /* field values compared here are case-insensitive */
+    for (char* c = value; *c != '\0'; c++) {
+        *c = tolower((unsigned char) *c);
+    }
+
+    if (strcasecmp(http->line, "Content-Length") == 0) {
+        http->has_content_length = true;
+        http->content_length = strtoul(value, NULL, 10);
+    } else if (strcasecmp(http->line, "Content-Range") == 0) {
+        unsigned long first = 0;
+        unsigned long last = 0;
+        unsigned long total = 0;
+
+        if (sscanf(value, "bytes %lu-%lu/%lu", &first, &last, &total) >= 2) {
+            http->has_content_range = true;
+            http->range_first = first;
+            http->range_last = last;
+            http->range_total = total;
+        }
+    } else if (strcasecmp(http->line, "Transfer-Encoding") == 0) {
+        http->chunked = (strstr(value, "chunked") != NULL);
+    } else if (strcasecmp(http->line, "Connection") == 0) {
+        if (strstr(value, "close")) {
+            http->keep_alive = false;
+        } else if (strstr(value, "keep-alive")) {
+            http->keep_alive = true;
+        }
+    }
+}
+
+static void mbed_stress_test_http_line(mbed_stress_test_http_t* http)
+{
+    /* strip CR, bare LF line endings are accepted too */
+    if ((http->line_length > 0) && (http->line[http->line_length - 1] == '\r')) {
+        http->line_length--;
+    }
+    http->line[http->line_length] = '\0';
+
+    switch (http->state) {
+        case MBED_STRESS_TEST_HTTP_STATUS_LINE:
+            mbed_stress_test_http_status_line(http);
+            break;
+
+        case MBED_STRESS_TEST_HTTP_HEADER:
+            mbed_stress_test_http_header(http);
+            break;
+
+        case MBED_STRESS_TEST_HTTP_CHUNK_SIZE: {
+            char* end = NULL;
+            http->remaining = strtoul(http->line, &end, 16);
+
+            if ((end == http->line) || ((*end != '\0') && (*end != ';') && (*end != ' '))) {
+                http->state = MBED_STRESS_TEST_HTTP_ERROR;
+            } else {
+                http->state = http->remaining ? MBED_STRESS_TEST_HTTP_CHUNK_DATA : MBED_STRESS_TEST_HTTP_TRAILER;
+            }
+            break;
+        }
+
+        case MBED_STRESS_TEST_HTTP_CHUNK_END:
+            http->state = (http->line_length == 0) ? MBED_STRESS_TEST_HTTP_CHUNK_SIZE : MBED_STRESS_TEST_HTTP_ERROR;
+            break;
+
+        case MBED_STRESS_TEST_HTTP_TRAILER:
+            if (http->line_length == 0) {
+                http->state = MBED_STRESS_TEST_HTTP_DONE;
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    http->line_length = 0;
+}
+
+static size_t mbed_stress_test_http_body(mbed_stress_test_http_t* http, const char* data, size_t length)
+{
+    if ((http->state != MBED_STRESS_TEST_HTTP_BODY_UNTIL_CLOSE) && (length > http->remaining)) {
+        length = http->remaining;
+    }
+
+    if (http->body) {
+        http->body(http->context, http->body_received, data, length);
+    }
+
+    http->body_received += length;
+
+    if (http->state != MBED_STRESS_TEST_HTTP_BODY_UNTIL_CLOSE) {
+        http->remaining -= length;
+
+        if (http->remaining == 0) {
+            http->state = (http->state == MBED_STRESS_TEST_HTTP_BODY) ? MBED_STRESS_TEST_HTTP_DONE : MBED_STRESS_TEST_HTTP_CHUNK_END;
+        }
+    }
+
+    return length;
+}
+
+size_t mbed_stress_test_http_parse(mbed_stress_test_http_t* http, const char* data, size_t length)
+{
+    size_t index = 0;
+
+    while ((index < length) &&
+           (http->state != MBED_STRESS_TEST_HTTP_DONE) &&
+           (http->state != MBED_STRESS_TEST_HTTP_ERROR)) {
+
+        switch (http->state) {
+            case MBED_STRESS_TEST_HTTP_BODY:
+            case MBED_STRESS_TEST_HTTP_BODY_UNTIL_CLOSE:
+            case MBED_STRESS_TEST_HTTP_CHUNK_DATA:
+                index += mbed_stress_test_http_body(http, &data[index], length - index);
+                break;
+
+            default: {
+                char c = data[index++];
+
+                if (c == '\n') {
+                    mbed_stress_test_http_line(http);
+                } else if (http->line_length < MBED_STRESS_TEST_HTTP_LINE_SIZE - 1) {
+                    /* only the start of overlong lines is kept, none of the fields used are that long */
+                    http->line[http->line_length++] = c;
+                }
+                break;
+            }
+        }
+    }
+
+    return index;
+}
+
+void mbed_stress_test_http_finish(mbed_stress_test_http_t* http)
+{
+    if (http->state == MBED_STRESS_TEST_HTTP_BODY_UNTIL_CLOSE) {
+        http->state = MBED_STRESS_TEST_HTTP_DONE;
+    } else if (http->state != MBED_STRESS_TEST_HTTP_DONE) {
+        http->state = MBED_STRESS_TEST_HTTP_ERROR;
+    }
+}
+
+bool mbed_stress_test_http_header_complete(const mbed_stress_test_http_t* http)
+{
+    return (http->state >= MBED_STRESS_TEST_HTTP_BODY) && (http->state != MBED_STRESS_TEST_HTTP_ERROR);
+}
+
+bool mbed_stress_test_http_done(const mbed_stress_test_http_t* http)
+{
+    return http->state == MBED_STRESS_TEST_HTTP_DONE;
+}
+
+bool mbed_stress_test_http_failed(const mbed_stress_test_http_t* http)
+{
+    return http->state == MBED_STRESS_TEST_HTTP_ERROR;
+}
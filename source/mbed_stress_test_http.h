@@ -0,0 +1,81 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2016 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MBED_STRESS_TEST_HTTP_H
+#define MBED_STRESS_TEST_HTTP_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define MBED_STRESS_TEST_HTTP_LINE_SIZE 128
+
+/* body bytes, handed over in place from the buffer given to mbed_stress_test_http_parse */
+typedef void (*mbed_stress_test_http_body_t)(void* context, size_t offset, const char* data, size_t length);
+
+typedef enum {
+    MBED_STRESS_TEST_HTTP_STATUS_LINE,
+    MBED_STRESS_TEST_HTTP_HEADER,
+    MBED_STRESS_TEST_HTTP_BODY,
+    MBED_STRESS_TEST_HTTP_BODY_UNTIL_CLOSE,
+    MBED_STRESS_TEST_HTTP_CHUNK_SIZE,
+    MBED_STRESS_TEST_HTTP_CHUNK_DATA,
+    MBED_STRESS_TEST_HTTP_CHUNK_END,
+    MBED_STRESS_TEST_HTTP_TRAILER,
+    MBED_STRESS_TEST_HTTP_DONE,
+    MBED_STRESS_TEST_HTTP_ERROR
+} mbed_stress_test_http_state_t;
+
+/* incremental HTTP/1.x response parser, works on any segment boundaries without heap use */
+typedef struct {
+    /* response header, valid once mbed_stress_test_http_header_complete */
+    uint32_t status;
+    bool has_content_length;
+    uint32_t content_length;
+    bool has_content_range;
+    uint32_t range_first;
+    uint32_t range_last;
+    uint32_t range_total;
+    bool chunked;
+    bool keep_alive;
+
+    /* body bytes handed to the callback so far */
+    uint32_t body_received;
+
+    /* parser state */
+    mbed_stress_test_http_state_t state;
+    uint32_t remaining;
+    size_t line_length;
+    char line[MBED_STRESS_TEST_HTTP_LINE_SIZE];
+    mbed_stress_test_http_body_t body;
+    void* context;
+} mbed_stress_test_http_t;
+
+void mbed_stress_test_http_init(mbed_stress_test_http_t* http, mbed_stress_test_http_body_t body, void* context);
+
+/* parse up to length bytes; returns the bytes consumed, which is less than length once the response is complete */
+size_t mbed_stress_test_http_parse(mbed_stress_test_http_t* http, const char* data, size_t length);
+
+/* end of stream; completes a body delimited by connection close */
+void mbed_stress_test_http_finish(mbed_stress_test_http_t* http);
+
+bool mbed_stress_test_http_header_complete(const mbed_stress_test_http_t* http);
+
+bool mbed_stress_test_http_done(const mbed_stress_test_http_t* http);
+
+bool mbed_stress_test_http_failed(const mbed_stress_test_http_t* http);
+
+#endif
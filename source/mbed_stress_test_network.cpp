@@ -20,28 +20,348 @@
 
 #include "mbed.h"
 #include "unity/unity.h"
+#include "greentea-client/test_env.h"
 #include <inttypes.h>
-#include <string>
+#include <stdlib.h>
 #include "TLSSocket.h"
+#include "mbed_stress_test_compare.h"
+#include "mbed_stress_test_generator.h"
+#include "mbed_stress_test_http.h"
+#include "mbed_stress_test_network.h"
 
-#include "certificate_aws_s3.h"
+#include MBED_CONF_APP_DOWNLOAD_CA_CERTIFICATE
 
-static volatile bool event_fired = false;
 #define BUFFER_SIZE 1024
 #define MAX_RETRIES 3
+#define SOCKET_EVENT_FLAG 0x01
+#define SOCKET_TIMEOUT_MS 30000
 
 const char request_template[] =
     "GET /firmware/%s.txt HTTP/1.1\n"
-    "Host: lootbox.s3.dualstack.us-west-2.amazonaws.com\n"
-    "Range: bytes=%d-%d\n"
+    "Host: " MBED_CONF_APP_DOWNLOAD_HOST "\n"
+    "Range: bytes=%" PRIu32 "-%" PRIu32 "\n"
     "\n";
 
-static void socket_event(void)
+const char request_full_template[] =
+    "GET /firmware/%s.txt HTTP/1.1\n"
+    "Host: " MBED_CONF_APP_DOWNLOAD_HOST "\n"
+    "\n";
+
+mbed_stress_test_wait_mode_t mbed_stress_test_wait_mode = MBED_STRESS_TEST_WAIT_EVENT;
+
+mbed_stress_test_tls_session_t* mbed_stress_test_tls_session = NULL;
+
+static mbedtls_x509_crt* tls_ca_chain = NULL;
+static Mutex tls_ca_mutex;
+
+/* parse SSL_CA_PEM for every socket, as before the shared chain */
+static bool tls_ca_per_socket = false;
+
+/* guards the entropy pool while a socket seeds its CTR_DRBG */
+static Mutex tls_entropy_mutex;
+
+#define DNS_HOST_SIZE 64
+
+typedef struct {
+    char host[DNS_HOST_SIZE];
+    SocketAddress address;
+    Kernel::Clock::time_point expires;
+} dns_cache_entry_t;
+
+bool mbed_stress_test_dns_cache_enabled = true;
+
+static dns_cache_entry_t dns_cache[MBED_STRESS_TEST_DNS_CACHE_ENTRIES];
+static mbed_stress_test_dns_stats_t dns_stats;
+static Mutex dns_cache_mutex;
+
+static void mbed_stress_test_socket_event_signal(mbed_stress_test_socket_event_t* event)
 {
-    event_fired = true;
+    core_util_atomic_incr_u32(&event->wakeups, 1);
+    event->flags.set(SOCKET_EVENT_FLAG);
 }
 
-size_t mbed_stress_test_download(NetworkInterface* interface, const char* filename, size_t offset, char* data, size_t data_length, bool tls)
+void mbed_stress_test_socket_event_attach(mbed_stress_test_socket_event_t* event, Socket* socket)
+{
+    event->flags.clear(SOCKET_EVENT_FLAG);
+    event->mode = mbed_stress_test_wait_mode;
+    event->wakeups = 0;
+
+    socket->sigio(callback(mbed_stress_test_socket_event_signal, event));
+}
+
+void mbed_stress_test_socket_event_detach(mbed_stress_test_socket_event_t* event, Socket* socket)
+{
+    (void) event;
+
+    socket->sigio(nullptr);
+}
+
+bool mbed_stress_test_socket_event_wait(mbed_stress_test_socket_event_t* event, uint32_t timeout_ms)
+{
+    if (event->mode == MBED_STRESS_TEST_WAIT_EVENT) {
+        return (event->flags.wait_any_for(SOCKET_EVENT_FLAG, std::chrono::milliseconds(timeout_ms)) & osFlagsError) == 0;
+    }
+
+    /* the polling modes the tests used before, kept for comparison */
+    Timer timer;
+    timer.start();
+
+    while ((event->flags.get() & SOCKET_EVENT_FLAG) == 0) {
+        if (timer.elapsed_time() >= std::chrono::milliseconds(timeout_ms)) {
+            return false;
+        }
+
+        if (event->mode == MBED_STRESS_TEST_WAIT_SLEEP) {
+            ThisThread::sleep_for(1s);
+        } else {
+            ThisThread::yield();
+        }
+    }
+
+    event->flags.clear(SOCKET_EVENT_FLAG);
+
+    return true;
+}
+
+const char* mbed_stress_test_wait_mode_name(mbed_stress_test_wait_mode_t mode)
+{
+    switch (mode) {
+        case MBED_STRESS_TEST_WAIT_EVENT:
+            return "event";
+        case MBED_STRESS_TEST_WAIT_SLEEP:
+            return "sleep";
+        case MBED_STRESS_TEST_WAIT_YIELD:
+            return "yield";
+    }
+
+    return "unknown";
+}
+
+uint32_t mbed_stress_test_cpu_idle(const mbed_stats_cpu_t* before, const mbed_stats_cpu_t* after)
+{
+    us_timestamp_t uptime = after->uptime - before->uptime;
+
+    if (uptime == 0) {
+        return 0;
+    }
+
+    return ((after->idle_time - before->idle_time) * 100) / uptime;
+}
+
+nsapi_error_t mbed_stress_test_gethostbyname(NetworkInterface* interface, const char* host, SocketAddress* address)
+{
+    Kernel::Clock::time_point now = Kernel::Clock::now();
+
+    if (mbed_stress_test_dns_cache_enabled) {
+        dns_cache_mutex.lock();
+
+        for (size_t index = 0; index < MBED_STRESS_TEST_DNS_CACHE_ENTRIES; index++) {
+            dns_cache_entry_t* entry = &dns_cache[index];
+
+            if ((entry->expires > now) && (strcmp(entry->host, host) == 0)) {
+                *address = entry->address;
+                dns_stats.hits++;
+
+                dns_cache_mutex.unlock();
+                return NSAPI_ERROR_OK;
+            }
+        }
+
+        dns_cache_mutex.unlock();
+    }
+
+    /* resolve unlocked, a slow lookup must not hold up hits on other threads */
+    nsapi_error_t result = interface->gethostbyname(host, address);
+
+    dns_cache_mutex.lock();
+
+    dns_stats.misses++;
+
+    if (mbed_stress_test_dns_cache_enabled && (result == NSAPI_ERROR_OK) && (strlen(host) < DNS_HOST_SIZE)) {
+        /* replace the entry closest to expiry, expired and empty ones first */
+        dns_cache_entry_t* entry = &dns_cache[0];
+
+        for (size_t index = 1; index < MBED_STRESS_TEST_DNS_CACHE_ENTRIES; index++) {
+            if (dns_cache[index].expires < entry->expires) {
+                entry = &dns_cache[index];
+            }
+        }
+
+        strcpy(entry->host, host);
+        entry->address = *address;
+        entry->expires = now + std::chrono::seconds(MBED_CONF_APP_DOWNLOAD_DNS_TTL);
+    }
+
+    dns_cache_mutex.unlock();
+
+    return result;
+}
+
+void mbed_stress_test_dns_cache_stats(mbed_stress_test_dns_stats_t* stats)
+{
+    dns_cache_mutex.lock();
+    *stats = dns_stats;
+    dns_cache_mutex.unlock();
+}
+
+void mbed_stress_test_dns_cache_clear(void)
+{
+    dns_cache_mutex.lock();
+
+    for (size_t index = 0; index < MBED_STRESS_TEST_DNS_CACHE_ENTRIES; index++) {
+        dns_cache[index].host[0] = '\0';
+        dns_cache[index].expires = Kernel::Clock::time_point();
+    }
+
+    memset(&dns_stats, 0, sizeof(dns_stats));
+
+    dns_cache_mutex.unlock();
+}
+
+/* TCPSocket that refuses to send while held */
+class HeldTCPSocket : public TCPSocket {
+public:
+    HeldTCPSocket() : held(false) {}
+
+    nsapi_size_or_error_t send(const void* data, nsapi_size_t size) override
+    {
+        return held ? NSAPI_ERROR_WOULD_BLOCK : TCPSocket::send(data, size);
+    }
+
+    bool held;
+};
+
+/* TLSSocket over a HeldTCPSocket. TLSSocketWrapper runs mbedtls_ssl_setup()
+ * and writes the ClientHello in one connect() call, so a saved session can
+ * only be restored by holding that ClientHello back, resetting the context
+ * and starting the handshake again.
+ */
+class ResumableTLSSocket : public TLSSocketWrapper {
+public:
+    ResumableTLSSocket() : TLSSocketWrapper(&transport, NULL, TRANSPORT_CLOSE) {}
+
+    ~ResumableTLSSocket()
+    {
+        /* transport goes away before the base class destructor runs */
+        close();
+    }
+
+    HeldTCPSocket transport;
+};
+
+/* counts certificate checks, which only a full handshake makes */
+static int mbed_stress_test_tls_verify_count(void* context, mbedtls_x509_crt* crt, int depth, uint32_t* flags)
+{
+    (void) crt;
+    (void) depth;
+    (void) flags;
+
+    (*(uint32_t*) context)++;
+
+    return 0;
+}
+
+/* handshake on the connected transport, resuming session when it has one */
+static nsapi_error_t mbed_stress_test_tls_handshake(ResumableTLSSocket* socket, const SocketAddress& address, mbed_stress_test_tls_session_t* session)
+{
+    if (!session) {
+        return socket->connect(address);
+    }
+
+    socket->set_blocking(false);
+
+    mbed_stress_test_socket_event_t event;
+    mbed_stress_test_socket_event_attach(&event, socket);
+
+    /* runs mbedtls_ssl_setup(), the ClientHello stays unsent */
+    socket->transport.held = true;
+
+    tls_entropy_mutex.lock();
+    nsapi_error_t result = socket->connect(address);
+    tls_entropy_mutex.unlock();
+
+    TEST_ASSERT_EQUAL_INT_MESSAGE(NSAPI_ERROR_IN_PROGRESS, result, "failed to start handshake");
+
+    mbedtls_ssl_config* config = socket->get_ssl_config();
+    mbedtls_ssl_context* context = socket->get_ssl_context();
+
+#if defined(MBEDTLS_SSL_SESSION_TICKETS)
+    mbedtls_ssl_conf_session_tickets(config, session->tickets ? MBEDTLS_SSL_SESSION_TICKETS_ENABLED : MBEDTLS_SSL_SESSION_TICKETS_DISABLED);
+#endif
+
+    uint32_t verified = 0;
+    mbedtls_ssl_conf_verify(config, mbed_stress_test_tls_verify_count, &verified);
+
+    int ret = mbedtls_ssl_session_reset(context);
+    TEST_ASSERT_EQUAL_INT_MESSAGE(0, ret, "failed to reset TLS context");
+
+    if (session->saved) {
+        ret = mbedtls_ssl_set_session(context, &session->session);
+        TEST_ASSERT_EQUAL_INT_MESSAGE(0, ret, "failed to set session");
+    }
+
+    socket->transport.held = false;
+
+    result = socket->connect(address);
+
+    while ((result == NSAPI_ERROR_IN_PROGRESS) || (result == NSAPI_ERROR_ALREADY) || (result == NSAPI_ERROR_WOULD_BLOCK)) {
+        bool event_fired = mbed_stress_test_socket_event_wait(&event, SOCKET_TIMEOUT_MS);
+        TEST_ASSERT_TRUE_MESSAGE(event_fired, "timeout waiting for handshake");
+
+        result = socket->connect(address);
+    }
+
+    mbed_stress_test_socket_event_detach(&event, socket);
+    mbedtls_ssl_conf_verify(config, NULL, NULL);
+    socket->set_blocking(true);
+
+    if (result == NSAPI_ERROR_IS_CONNECTED) {
+        result = NSAPI_ERROR_OK;
+    }
+
+    if (result == NSAPI_ERROR_OK) {
+        if (verified) {
+            session->full++;
+        } else {
+            session->resumed++;
+        }
+
+        /* keep the newest session, the server may have issued a new ticket */
+        ret = mbedtls_ssl_get_session(context, &session->session);
+        TEST_ASSERT_EQUAL_INT_MESSAGE(0, ret, "failed to save session");
+
+        session->saved = true;
+    }
+
+    return result;
+}
+
+/* destination for response bodies, filled in place by the HTTP parser */
+typedef struct {
+    char* data;
+    size_t data_length;
+} body_buffer_t;
+
+static void body_copy(void* context, size_t offset, const char* data, size_t length)
+{
+    body_buffer_t* buffer = (body_buffer_t*) context;
+
+    TEST_ASSERT_MESSAGE(offset + length <= buffer->data_length, "response larger than requested range");
+
+    /* body bytes are received behind their final position, so this is a no-op once past the header */
+    memmove(&buffer->data[offset], data, length);
+}
+
+/* errors that retrying the same connection will not fix */
+static bool mbed_stress_test_out_of_resources(int result)
+{
+    return (result == NSAPI_ERROR_NO_SOCKET) || (result == NSAPI_ERROR_NO_MEMORY);
+}
+
+/* as mbed_stress_test_connect, but NULL when the stack runs out of sockets
+ * or heap, or the per-socket root CA does not fit
+ */
+static Socket* mbed_stress_test_connect_or_null(NetworkInterface* interface, bool tls, mbed_stress_test_phase_timing_t* timing)
 {
     int result = -1;
     Socket* socket = NULL;
@@ -51,27 +371,63 @@ size_t mbed_stress_test_download(NetworkInterface* interface, const char* filena
         printf("use TLSSocket\r\n");
 
         /* setup TLS socket */
-        TLSSocket* tlssocket = new TLSSocket();
+        ResumableTLSSocket* tlssocket = new ResumableTLSSocket();
         TEST_ASSERT_NOT_NULL_MESSAGE(tlssocket, "failed to instantiate tlssocket");
 
-        result = tlssocket->open(interface);
+        result = tlssocket->transport.open(interface);
+
+        if (mbed_stress_test_out_of_resources(result)) {
+            delete tlssocket;
+            return NULL;
+        }
         TEST_ASSERT_EQUAL_INT_MESSAGE(0, result, "failed to open socket");
 
-        result = tlssocket->set_root_ca_cert(SSL_CA_PEM);
-        TEST_ASSERT_EQUAL_INT_MESSAGE(0, result, "failed to set root CA");
+        if (tls_ca_per_socket) {
+            /* a parsed chain per socket may not fit, the caller skips that run */
+            result = tlssocket->set_root_ca_cert(SSL_CA_PEM);
+
+            if (result != 0) {
+                printf("set root CA: %d\r\n", result);
+                delete tlssocket;
+                return NULL;
+            }
+        } else {
+            tlssocket->set_ca_chain(mbed_stress_test_tls_ca_chain());
+        }
+
+        mbed_stress_test_tls_session_t* session = mbed_stress_test_tls_session;
+
+        /* socket setup is not part of any phase */
+        if (timing) {
+            mbed_stress_test_phase_start(timing);
+        }
 
         for (int tries = 0; tries < MAX_RETRIES; tries++) {
             SocketAddress address;
 
-            NetworkInterface::get_default_instance()->gethostbyname("lootbox.s3.dualstack.us-west-2.amazonaws.com", &address);
-            address.set_port(443);
+            mbed_stress_test_gethostbyname(interface, MBED_CONF_APP_DOWNLOAD_HOST, &address);
+            address.set_port(MBED_CONF_APP_DOWNLOAD_HTTPS_PORT);
+            mbed_stress_test_phase_mark(timing, MBED_STRESS_TEST_PHASE_DNS);
+
+            /* connect the transport first to time the handshake on its own */
+            result = tlssocket->transport.connect(address);
+            mbed_stress_test_phase_mark(timing, MBED_STRESS_TEST_PHASE_CONNECT);
+
+            if ((result == NSAPI_ERROR_OK) || (result == NSAPI_ERROR_IS_CONNECTED)) {
+                result = mbed_stress_test_tls_handshake(tlssocket, address, session);
+                mbed_stress_test_phase_mark(timing, MBED_STRESS_TEST_PHASE_HANDSHAKE);
+            }
 
-            result = tlssocket->connect(address);
-            if (result == 0) {
+            if ((result == 0) || mbed_stress_test_out_of_resources(result)) {
                 break;
             }
             printf("connection failed. retry %d of %d\r\n", tries, MAX_RETRIES);
         }
+
+        if (mbed_stress_test_out_of_resources(result)) {
+            delete tlssocket;
+            return NULL;
+        }
         TEST_ASSERT_EQUAL_INT_MESSAGE(0, result, "failed to connect");
 
         socket = static_cast<Socket*>(tlssocket);
@@ -83,100 +439,1157 @@ size_t mbed_stress_test_download(NetworkInterface* interface, const char* filena
         TEST_ASSERT_NOT_NULL_MESSAGE(tcpsocket, "failed to create TCPSocket");
 
         result = tcpsocket->open(interface);
+
+        if (mbed_stress_test_out_of_resources(result)) {
+            delete tcpsocket;
+            return NULL;
+        }
         TEST_ASSERT_EQUAL_INT_MESSAGE(0, result, "failed to open socket");
 
+        if (timing) {
+            mbed_stress_test_phase_start(timing);
+        }
+
         for (int tries = 0; tries < MAX_RETRIES; tries++) {
             SocketAddress address;
 
-            NetworkInterface::get_default_instance()->gethostbyname("lootbox.s3.dualstack.us-west-2.amazonaws.com", &address);
-            address.set_port(80);
+            mbed_stress_test_gethostbyname(interface, MBED_CONF_APP_DOWNLOAD_HOST, &address);
+            address.set_port(MBED_CONF_APP_DOWNLOAD_HTTP_PORT);
+            mbed_stress_test_phase_mark(timing, MBED_STRESS_TEST_PHASE_DNS);
 
             result = tcpsocket->connect(address);
-            if (result == 0) {
+            mbed_stress_test_phase_mark(timing, MBED_STRESS_TEST_PHASE_CONNECT);
+            if ((result == 0) || mbed_stress_test_out_of_resources(result)) {
                 break;
             }
             printf("connection failed. retry %d of %d\r\n", tries, MAX_RETRIES);
         }
+
+        if (mbed_stress_test_out_of_resources(result)) {
+            delete tcpsocket;
+            return NULL;
+        }
         TEST_ASSERT_EQUAL_INT_MESSAGE(0, result, "failed to connect");
 
         socket = static_cast<Socket*>(tcpsocket);
     }
 
-    socket->set_blocking(false);
-    printf("non-blocking mode set\r\n");
+    return socket;
+}
 
-    socket->sigio(socket_event);
-    printf("registered callback function\r\n");
+static Socket* mbed_stress_test_connect(NetworkInterface* interface, bool tls, mbed_stress_test_phase_timing_t* timing)
+{
+    Socket* socket = mbed_stress_test_connect_or_null(interface, tls, timing);
+    TEST_ASSERT_NOT_NULL_MESSAGE(socket, "out of sockets or memory");
 
+    return socket;
+}
 
-    /* setup request */
-    char* request = new char[BUFFER_SIZE];
+void mbed_stress_test_tls_session_init(mbed_stress_test_tls_session_t* session, bool tickets)
+{
+    memset(session, 0, sizeof(mbed_stress_test_tls_session_t));
 
-    size_t request_size = snprintf(request, BUFFER_SIZE, request_template, filename, offset, offset + data_length - 1);
-    TEST_ASSERT_MESSAGE(request_size < BUFFER_SIZE, "request buffer overflow");
+    mbedtls_ssl_session_init(&session->session);
+    session->tickets = tickets;
+}
 
-    printf("request: %s[end]\r\n", request);
+void mbed_stress_test_tls_session_free(mbed_stress_test_tls_session_t* session)
+{
+    mbedtls_ssl_session_free(&session->session);
+    session->saved = false;
+}
 
-    /* send request to server */
-    result = socket->send(request, request_size);
-    TEST_ASSERT_EQUAL_INT_MESSAGE(request_size, result, "failed to send HTTP request");
+/* open and close handshakes TLS connections, returns the elapsed microseconds */
+static uint64_t mbed_stress_test_tls_handshakes(NetworkInterface* interface, mbed_stress_test_tls_session_t* session, uint32_t handshakes)
+{
+    mbed_stress_test_tls_session_t* default_session = mbed_stress_test_tls_session;
+    mbed_stress_test_tls_session = session;
 
-    /* read response */
-    size_t expected_bytes = data_length;
-    size_t received_bytes = 0;
-    uint32_t body_index = 0;
+    if (session) {
+        /* the first handshake is always a full one, it only provides the session */
+        delete mbed_stress_test_connect(interface, true, NULL);
 
+        session->full = 0;
+        session->resumed = 0;
+    }
 
-    /* loop until all expected bytes have been received */
-    while (received_bytes < expected_bytes)
-    {
-        /* wait for async event */
-        while(!event_fired)
-        {
-            ThisThread::sleep_for(1s);
+    Timer timer;
+    timer.start();
+
+    for (uint32_t index = 0; index < handshakes; index++) {
+        delete mbed_stress_test_connect(interface, true, NULL);
+    }
+
+    timer.stop();
+
+    mbed_stress_test_tls_session = default_session;
+
+    return timer.elapsed_time().count();
+}
+
+static void mbed_stress_test_tls_report(const char* name, uint64_t elapsed_us, uint32_t handshakes, uint32_t resumed)
+{
+    printf("handshake: %s average: %" PRIu32 " us resumed: %" PRIu32 " of %" PRIu32 " connections/minute: %" PRIu32 "\r\n",
+           name, (uint32_t) (elapsed_us / handshakes), resumed, handshakes,
+           elapsed_us ? (uint32_t) (((uint64_t) handshakes * 60000000) / elapsed_us) : 0);
+}
+
+void mbed_stress_test_tls_benchmark(NetworkInterface* interface, uint32_t handshakes)
+{
+    TEST_ASSERT_MESSAGE(handshakes > 0, "invalid number of handshakes");
+
+    uint64_t full_us = mbed_stress_test_tls_handshakes(interface, NULL, handshakes);
+    mbed_stress_test_tls_report("full", full_us, handshakes, 0);
+
+    const char* names[] = { "session id", "session ticket" };
+
+    for (int tickets = 0; tickets < 2; tickets++) {
+#if !defined(MBEDTLS_SSL_SESSION_TICKETS)
+        if (tickets) {
+            printf("handshake: %s unsupported\r\n", names[tickets]);
+            continue;
+        }
+#endif
+
+        mbed_stress_test_tls_session_t session;
+        mbed_stress_test_tls_session_init(&session, tickets);
+
+        uint64_t resumed_us = mbed_stress_test_tls_handshakes(interface, &session, handshakes);
+        mbed_stress_test_tls_report(names[tickets], resumed_us, handshakes, session.resumed);
+
+        TEST_ASSERT_EQUAL_INT_MESSAGE(handshakes, session.resumed, "server did not resume the session");
+
+        mbed_stress_test_tls_session_free(&session);
+    }
+}
+
+mbedtls_x509_crt* mbed_stress_test_tls_ca_chain(void)
+{
+    tls_ca_mutex.lock();
+
+    if (tls_ca_chain == NULL) {
+        mbedtls_x509_crt* chain = new mbedtls_x509_crt;
+        TEST_ASSERT_NOT_NULL_MESSAGE(chain, "failed to allocate root CA chain");
+
+        mbedtls_x509_crt_init(chain);
+
+        int result = mbedtls_x509_crt_parse_der(chain, SSL_CA_DER, sizeof(SSL_CA_DER));
+        TEST_ASSERT_EQUAL_INT_MESSAGE(0, result, "failed to parse root CA");
+
+        tls_ca_chain = chain;
+    }
+
+    tls_ca_mutex.unlock();
+
+    return tls_ca_chain;
+}
+
+TLSSocketWrapper* mbed_stress_test_tls_connect(NetworkInterface* interface, TCPSocket* transport)
+{
+    int result = transport->open(interface);
+    TEST_ASSERT_EQUAL_INT_MESSAGE(0, result, "failed to open socket");
+
+    for (int tries = 0; tries < MAX_RETRIES; tries++) {
+        SocketAddress address;
+
+        mbed_stress_test_gethostbyname(interface, MBED_CONF_APP_DOWNLOAD_HOST, &address);
+        address.set_port(MBED_CONF_APP_DOWNLOAD_HTTPS_PORT);
+
+        result = transport->connect(address);
+        TEST_ASSERT_MESSAGE(result != NSAPI_ERROR_NO_SOCKET, "out of sockets");
+
+        if (result == 0) {
+            break;
         }
-        event_fired = false;
+        printf("connection failed. retry %d of %d\r\n", tries, MAX_RETRIES);
+    }
+    TEST_ASSERT_EQUAL_INT_MESSAGE(0, result, "failed to connect");
 
-        /* loop until all data has been read from socket */
-        do
-        {
-            result = socket->recv(&data[received_bytes], data_length - received_bytes);
-            TEST_ASSERT_MESSAGE((result == NSAPI_ERROR_WOULD_BLOCK) || (result >= 0), "failed to read socket");
-//            printf("result: %d\r\n", result);
+    TLSSocketWrapper* socket = new TLSSocketWrapper(transport, NULL, TLSSocketWrapper::TRANSPORT_KEEP);
+    TEST_ASSERT_NOT_NULL_MESSAGE(socket, "failed to instantiate socket");
 
-            if (result > 0)
-            {
-                /* skip HTTP header */
-                if (body_index == 0)
-                {
-                    std::string header(data, result);
-                    body_index = header.find("\r\n\r\n");
-                    TEST_ASSERT_MESSAGE(body_index != std::string::npos, "failed to find body");
+    socket->set_ca_chain(mbed_stress_test_tls_ca_chain());
+    socket->set_blocking(false);
 
-                    /* remove header */
-                    memmove(data, &data[body_index + 4], result - body_index - 4);
+    mbed_stress_test_socket_event_t event;
+    mbed_stress_test_socket_event_attach(&event, socket);
 
-                    received_bytes += (result - body_index - 4);
-                }
-                else
-                {
-                    received_bytes += result;
-                }
+    /* the transport is connected, so this call starts the handshake: seed, then ClientHello */
+    tls_entropy_mutex.lock();
+    result = socket->connect(SocketAddress());
+    tls_entropy_mutex.unlock();
 
-//                data[result] = '\0';
-//                printf("%s", data);
-                printf("received_bytes: %u\r\n", received_bytes);
-            }
+    while ((result == NSAPI_ERROR_IN_PROGRESS) || (result == NSAPI_ERROR_ALREADY) || (result == NSAPI_ERROR_WOULD_BLOCK)) {
+        bool event_fired = mbed_stress_test_socket_event_wait(&event, SOCKET_TIMEOUT_MS);
+        TEST_ASSERT_TRUE_MESSAGE(event_fired, "timeout waiting for handshake");
+
+        result = socket->connect(SocketAddress());
+    }
+
+    mbed_stress_test_socket_event_detach(&event, socket);
+
+    TEST_ASSERT_MESSAGE((result == NSAPI_ERROR_OK) || (result == NSAPI_ERROR_IS_CONNECTED), "TLS handshake failed");
+
+    return socket;
+}
+
+static void mbed_stress_test_tls_ca_run(NetworkInterface* interface, uint32_t connections, bool per_socket)
+{
+    Socket* sockets[MBED_STRESS_TEST_TLS_CA_CONNECTIONS_MAX];
+    mbed_stats_heap_t before;
+    mbed_stats_heap_t after;
+
+    /* the shared chain is parsed once, outside the measurement */
+    mbed_stress_test_tls_ca_chain();
+    tls_ca_per_socket = per_socket;
+
+    mbed_stats_heap_get(&before);
+
+    Timer timer;
+    timer.start();
+
+    uint32_t opened = 0;
+
+    for (; opened < connections; opened++) {
+        sockets[opened] = mbed_stress_test_connect_or_null(interface, true, NULL);
+
+        if (sockets[opened] == NULL) {
+            break;
         }
-        while ((result > 0) && (received_bytes < expected_bytes));
     }
 
-    delete[] request;
-    delete socket;
+    timer.stop();
 
-    printf("done\r\n");
+    mbed_stats_heap_get(&after);
 
-    return received_bytes;
+    for (uint32_t index = 0; index < opened; index++) {
+        delete sockets[index];
+    }
+
+    tls_ca_per_socket = false;
+
+    /* mostly the PEM run, a parsed chain per socket runs out of heap first */
+    if (opened < connections) {
+        printf("root CA: %s skipped, out of sockets or memory after %" PRIu32 " connections\r\n",
+               per_socket ? "PEM per socket" : "shared DER", opened);
+        return;
+    }
+
+#if MBED_HEAP_STATS_ENABLED
+    printf("root CA: %s heap/connection: %" PRIu32 " bytes connect: %" PRIu32 " us\r\n",
+           per_socket ? "PEM per socket" : "shared DER",
+           (after.current_size - before.current_size) / connections,
+           (uint32_t) (timer.elapsed_time().count() / connections));
+#else
+    /* platform.heap-stats-enabled is off by default */
+    printf("root CA: %s heap/connection: n/a connect: %" PRIu32 " us\r\n",
+           per_socket ? "PEM per socket" : "shared DER",
+           (uint32_t) (timer.elapsed_time().count() / connections));
+#endif
+}
+
+void mbed_stress_test_tls_ca_benchmark(NetworkInterface* interface, uint32_t connections)
+{
+    TEST_ASSERT_MESSAGE((connections >= 1) && (connections <= MBED_STRESS_TEST_TLS_CA_CONNECTIONS_MAX), "invalid number of connections");
+
+    mbed_stress_test_tls_ca_run(interface, connections, true);
+    mbed_stress_test_tls_ca_run(interface, connections, false);
+}
+
+void mbed_stress_test_compare_wait_modes(void (*download)(void), size_t bytes, const mbed_stress_test_wait_mode_t* modes, size_t modes_count)
+{
+    mbed_stress_test_wait_mode_t default_mode = mbed_stress_test_wait_mode;
+
+    for (size_t index = 0; index < modes_count; index++) {
+        mbed_stats_cpu_t before;
+        mbed_stats_cpu_t after;
+        Timer timer;
+
+        mbed_stress_test_wait_mode = modes[index];
+
+        mbed_stats_cpu_get(&before);
+        timer.start();
+
+        download();
+
+        timer.stop();
+        mbed_stats_cpu_get(&after);
+
+        uint64_t elapsed_us = timer.elapsed_time().count();
+        uint32_t throughput = elapsed_us ? ((uint64_t) bytes * 1000000) / elapsed_us : 0;
+
+#if MBED_CPU_STATS_ENABLED
+        printf("wait: %s time: %" PRIu32 " ms throughput: %" PRIu32 " bytes/s cpu idle: %" PRIu32 "%%\r\n",
+               mbed_stress_test_wait_mode_name(modes[index]), (uint32_t) (elapsed_us / 1000), throughput,
+               mbed_stress_test_cpu_idle(&before, &after));
+#else
+        /* platform.cpu-stats-enabled is off by default */
+        printf("wait: %s time: %" PRIu32 " ms throughput: %" PRIu32 " bytes/s cpu idle: n/a\r\n",
+               mbed_stress_test_wait_mode_name(modes[index]), (uint32_t) (elapsed_us / 1000), throughput);
+#endif
+    }
+
+    mbed_stress_test_wait_mode = default_mode;
+}
+
+/*****************************************************************************/
+/* phase timing                                                              */
+/*****************************************************************************/
+
+void mbed_stress_test_phase_start(mbed_stress_test_phase_timing_t* timing)
+{
+    memset(timing->us, 0, sizeof(timing->us));
+    timing->mark_us = 0;
+
+    timing->timer.reset();
+    timing->timer.start();
+}
+
+void mbed_stress_test_phase_mark(mbed_stress_test_phase_timing_t* timing, mbed_stress_test_phase_t phase)
+{
+    if (timing) {
+        uint32_t now_us = timing->timer.elapsed_time().count();
+
+        /* retries add up */
+        timing->us[phase] += now_us - timing->mark_us;
+        timing->mark_us = now_us;
+    }
+}
+
+const char* mbed_stress_test_phase_name(mbed_stress_test_phase_t phase)
+{
+    switch (phase) {
+        case MBED_STRESS_TEST_PHASE_DNS:
+            return "dns";
+        case MBED_STRESS_TEST_PHASE_CONNECT:
+            return "connect";
+        case MBED_STRESS_TEST_PHASE_HANDSHAKE:
+            return "handshake";
+        case MBED_STRESS_TEST_PHASE_FIRST_BYTE:
+            return "first_byte";
+        case MBED_STRESS_TEST_PHASE_TRANSFER:
+            return "transfer";
+        default:
+            return "unknown";
+    }
+}
+
+void mbed_stress_test_phase_stats_init(mbed_stress_test_phase_stats_t* stats)
+{
+    memset(stats, 0, sizeof(mbed_stress_test_phase_stats_t));
+}
+
+void mbed_stress_test_phase_stats_add(mbed_stress_test_phase_stats_t* stats, const mbed_stress_test_phase_timing_t* timing)
+{
+    uint32_t slot = stats->runs % MBED_STRESS_TEST_PHASE_RUNS_MAX;
+
+    for (uint32_t phase = 0; phase < MBED_STRESS_TEST_PHASES; phase++) {
+        stats->us[phase][slot] = timing->us[phase];
+    }
+
+    stats->runs++;
+}
+
+static int mbed_stress_test_phase_compare(const void* left, const void* right)
+{
+    uint32_t a = *(const uint32_t*) left;
+    uint32_t b = *(const uint32_t*) right;
+
+    return (a > b) - (a < b);
+}
+
+static uint32_t mbed_stress_test_phase_stats_runs(const mbed_stress_test_phase_stats_t* stats)
+{
+    return (stats->runs < MBED_STRESS_TEST_PHASE_RUNS_MAX) ? stats->runs : MBED_STRESS_TEST_PHASE_RUNS_MAX;
+}
+
+uint32_t mbed_stress_test_phase_stats_percentile(const mbed_stress_test_phase_stats_t* stats, mbed_stress_test_phase_t phase, uint32_t percent)
+{
+    uint32_t runs = mbed_stress_test_phase_stats_runs(stats);
+    uint32_t sorted[MBED_STRESS_TEST_PHASE_RUNS_MAX];
+
+    if (runs == 0) {
+        return 0;
+    }
+
+    memcpy(sorted, stats->us[phase], runs * sizeof(uint32_t));
+    qsort(sorted, runs, sizeof(uint32_t), mbed_stress_test_phase_compare);
+
+    /* nearest rank, 0 percent gives the minimum */
+    uint32_t rank = (runs * percent + 99) / 100;
+
+    return sorted[rank ? rank - 1 : 0];
+}
+
+void mbed_stress_test_phase_stats_report(const mbed_stress_test_phase_stats_t* stats)
+{
+    uint32_t runs = mbed_stress_test_phase_stats_runs(stats);
+
+    if (runs == 0) {
+        return;
+    }
+
+    printf("phase timing over %" PRIu32 " runs\r\n", runs);
+
+    for (uint32_t phase = 0; phase < MBED_STRESS_TEST_PHASES; phase++) {
+        const char* name = mbed_stress_test_phase_name((mbed_stress_test_phase_t) phase);
+        uint32_t min_us = mbed_stress_test_phase_stats_percentile(stats, (mbed_stress_test_phase_t) phase, 0);
+        uint32_t median_us = mbed_stress_test_phase_stats_percentile(stats, (mbed_stress_test_phase_t) phase, 50);
+        uint32_t p99_us = mbed_stress_test_phase_stats_percentile(stats, (mbed_stress_test_phase_t) phase, 99);
+
+        printf("%-10s min: %8" PRIu32 " us median: %8" PRIu32 " us p99: %8" PRIu32 " us\r\n",
+               name, min_us, median_us, p99_us);
+
+        char key[32];
+
+        snprintf(key, sizeof(key), "%s_min_us", name);
+        greentea_send_kv(key, (int) min_us);
+        snprintf(key, sizeof(key), "%s_median_us", name);
+        greentea_send_kv(key, (int) median_us);
+        snprintf(key, sizeof(key), "%s_p99_us", name);
+        greentea_send_kv(key, (int) p99_us);
+    }
+}
+
+size_t mbed_stress_test_download(NetworkInterface* interface, const char* filename, size_t offset, char* data, size_t data_length, bool tls)
+{
+    return mbed_stress_test_download_timed(interface, filename, offset, data, data_length, tls, NULL);
+}
+
+size_t mbed_stress_test_download_timed(NetworkInterface* interface, const char* filename, size_t offset, char* data, size_t data_length, bool tls, mbed_stress_test_phase_timing_t* timing)
+{
+    int result = -1;
+    Socket* socket = mbed_stress_test_connect(interface, tls, timing);
+
+    socket->set_blocking(false);
+    printf("non-blocking mode set\r\n");
+
+    mbed_stress_test_socket_event_t event;
+    mbed_stress_test_socket_event_attach(&event, socket);
+    printf("registered callback function\r\n");
+
+
+    /* setup request */
+    char* request = new char[BUFFER_SIZE];
+
+    size_t request_size = snprintf(request, BUFFER_SIZE, request_template, filename, (uint32_t) offset, (uint32_t) (offset + data_length - 1));
+    TEST_ASSERT_MESSAGE(request_size < BUFFER_SIZE, "request buffer overflow");
+
+    printf("request: %s[end]\r\n", request);
+
+    /* send request to server */
+    result = socket->send(request, request_size);
+    TEST_ASSERT_EQUAL_INT_MESSAGE(request_size, result, "failed to send HTTP request");
+
+    /* read response straight into data, the parser moves the body over the header */
+    body_buffer_t buffer = { data, data_length };
+    mbed_stress_test_http_t http;
+    mbed_stress_test_http_init(&http, body_copy, &buffer);
+
+    char tail[16];
+    bool received_any = false;
+
+    /* loop until the whole response has been parsed */
+    while (!mbed_stress_test_http_done(&http))
+    {
+        /* wait for async event */
+        bool event_fired = mbed_stress_test_socket_event_wait(&event, SOCKET_TIMEOUT_MS);
+        TEST_ASSERT_TRUE_MESSAGE(event_fired, "timeout waiting for socket");
+
+        /* loop until all data has been read from socket */
+        do
+        {
+            /* the chunked encoding trailer can arrive after the body has filled data */
+            size_t space = data_length - http.body_received;
+            char* target = space ? &data[http.body_received] : tail;
+
+            result = socket->recv(target, space ? space : sizeof(tail));
+            TEST_ASSERT_MESSAGE((result == NSAPI_ERROR_WOULD_BLOCK) || (result >= 0), "failed to read socket");
+
+            if (result == 0)
+            {
+                mbed_stress_test_http_finish(&http);
+            }
+            else if (result > 0)
+            {
+                if (!received_any) {
+                    mbed_stress_test_phase_mark(timing, MBED_STRESS_TEST_PHASE_FIRST_BYTE);
+                    received_any = true;
+                }
+
+                mbed_stress_test_http_parse(&http, target, result);
+                TEST_ASSERT_FALSE_MESSAGE(mbed_stress_test_http_failed(&http), "malformed HTTP response");
+
+                printf("received_bytes: %" PRIu32 "\r\n", http.body_received);
+            }
+        }
+        while ((result > 0) && !mbed_stress_test_http_done(&http));
+
+        TEST_ASSERT_FALSE_MESSAGE(mbed_stress_test_http_failed(&http), "connection closed before end of response");
+    }
+
+    TEST_ASSERT_MESSAGE((http.status == 200) || (http.status == 206), "unexpected HTTP status");
+
+    mbed_stress_test_phase_mark(timing, MBED_STRESS_TEST_PHASE_TRANSFER);
+
+    size_t received_bytes = http.body_received;
+
+    mbed_stress_test_socket_event_detach(&event, socket);
+
+    delete[] request;
+    delete socket;
+
+    printf("done\r\n");
+
+    return received_bytes;
+}
+
+size_t mbed_stress_test_download_stream(NetworkInterface* interface, const char* filename, bool tls, mbed_stress_test_http_body_t body, void* context)
+{
+    int result = -1;
+    Socket* socket = mbed_stress_test_connect(interface, tls, NULL);
+
+    socket->set_blocking(false);
+
+    mbed_stress_test_socket_event_t event;
+    mbed_stress_test_socket_event_attach(&event, socket);
+
+    char* buffer = new char[BUFFER_SIZE];
+    TEST_ASSERT_NOT_NULL_MESSAGE(buffer, "failed to allocate receive buffer");
+
+    size_t request_size = snprintf(buffer, BUFFER_SIZE, request_full_template, filename);
+    TEST_ASSERT_MESSAGE(request_size < BUFFER_SIZE, "request buffer overflow");
+
+    result = socket->send(buffer, request_size);
+    TEST_ASSERT_EQUAL_INT_MESSAGE(request_size, result, "failed to send HTTP request");
+
+    /* the body goes straight to the sink, only one buffer is ever held */
+    mbed_stress_test_http_t http;
+    mbed_stress_test_http_init(&http, body, context);
+
+    while (!mbed_stress_test_http_done(&http))
+    {
+        bool event_fired = mbed_stress_test_socket_event_wait(&event, SOCKET_TIMEOUT_MS);
+        TEST_ASSERT_TRUE_MESSAGE(event_fired, "timeout waiting for socket");
+
+        do
+        {
+            result = socket->recv(buffer, BUFFER_SIZE);
+            TEST_ASSERT_MESSAGE((result == NSAPI_ERROR_WOULD_BLOCK) || (result >= 0), "failed to read socket");
+
+            if (result == 0)
+            {
+                mbed_stress_test_http_finish(&http);
+            }
+            else if (result > 0)
+            {
+                mbed_stress_test_http_parse(&http, buffer, result);
+                TEST_ASSERT_FALSE_MESSAGE(mbed_stress_test_http_failed(&http), "malformed HTTP response");
+            }
+        }
+        while ((result > 0) && !mbed_stress_test_http_done(&http));
+
+        TEST_ASSERT_FALSE_MESSAGE(mbed_stress_test_http_failed(&http), "connection closed before end of response");
+    }
+
+    TEST_ASSERT_EQUAL_INT_MESSAGE(200, http.status, "unexpected HTTP status");
+
+    mbed_stress_test_socket_event_detach(&event, socket);
+
+    delete[] buffer;
+    delete socket;
+
+    return http.body_received;
+}
+
+void mbed_stress_test_generated_body(void* context, size_t offset, const char* data, size_t length)
+{
+    uint32_t seed = *(const uint32_t*) context;
+
+    mbed_stress_test_assert_generated(seed, offset, data, length, "character mismatch");
+}
+
+/*****************************************************************************/
+/* keep-alive connection                                                     */
+/*****************************************************************************/
+
+#define CONNECTION_BUFFER_SIZE 1024
+#define CONNECTION_TIMEOUT_MS 30000
+
+void mbed_stress_test_connection_open(mbed_stress_test_connection_t* connection, NetworkInterface* interface, bool tls)
+{
+    memset(connection, 0, sizeof(mbed_stress_test_connection_t));
+
+    connection->interface = interface;
+    connection->tls = tls;
+
+    connection->buffer = new char[CONNECTION_BUFFER_SIZE];
+    TEST_ASSERT_NOT_NULL_MESSAGE(connection->buffer, "failed to allocate connection buffer");
+}
+
+static void mbed_stress_test_connection_disconnect(mbed_stress_test_connection_t* connection)
+{
+    delete connection->socket;
+    connection->socket = NULL;
+    connection->buffer_length = 0;
+}
+
+void mbed_stress_test_connection_close(mbed_stress_test_connection_t* connection)
+{
+    mbed_stress_test_connection_disconnect(connection);
+
+    delete[] connection->buffer;
+    connection->buffer = NULL;
+}
+
+static bool mbed_stress_test_connection_send(mbed_stress_test_connection_t* connection, const char* filename, size_t offset, size_t length)
+{
+    char request[BUFFER_SIZE];
+
+    size_t request_size = snprintf(request, BUFFER_SIZE, request_template, filename, (uint32_t) offset, (uint32_t) (offset + length - 1));
+    TEST_ASSERT_MESSAGE(request_size < BUFFER_SIZE, "request buffer overflow");
+
+    return connection->socket->send(request, request_size) == (int) request_size;
+}
+
+/* parse buffered bytes, keeping whatever belongs to the next pipelined response */
+static void mbed_stress_test_connection_parse_buffer(mbed_stress_test_connection_t* connection, mbed_stress_test_http_t* http)
+{
+    size_t parsed = mbed_stress_test_http_parse(http, connection->buffer, connection->buffer_length);
+
+    connection->buffer_length -= parsed;
+    memmove(connection->buffer, &connection->buffer[parsed], connection->buffer_length);
+}
+
+/* Read one response into data.
+ * Returns -1 if the connection was closed before the response started, 0 if
+ * the server closes the connection after this response, 1 if it stays open.
+ */
+static int mbed_stress_test_connection_response(mbed_stress_test_connection_t* connection, size_t offset, char* data, size_t data_length)
+{
+    body_buffer_t buffer = { data, data_length };
+    mbed_stress_test_http_t http;
+    mbed_stress_test_http_init(&http, body_copy, &buffer);
+
+    bool started = (connection->buffer_length > 0);
+    mbed_stress_test_connection_parse_buffer(connection, &http);
+
+    while (!mbed_stress_test_http_done(&http) && !mbed_stress_test_http_failed(&http)) {
+        size_t space = data_length - http.body_received;
+        int result = 0;
+
+        if ((space > 0) && (connection->buffer_length == 0)) {
+            /* This response is at least space bytes long, so receiving straight
+             * into data never reads into the next one.
+             */
+            result = connection->socket->recv(&data[http.body_received], space);
+
+            if (result > 0) {
+                size_t parsed = mbed_stress_test_http_parse(&http, &data[http.body_received], result);
+                TEST_ASSERT_EQUAL_INT_MESSAGE(result, parsed, "response larger than requested range");
+            }
+        } else {
+            result = connection->socket->recv(&connection->buffer[connection->buffer_length], CONNECTION_BUFFER_SIZE - connection->buffer_length);
+
+            if (result > 0) {
+                connection->buffer_length += result;
+                mbed_stress_test_connection_parse_buffer(connection, &http);
+            }
+        }
+
+        if (result <= 0) {
+            if (!started) {
+                return -1;
+            }
+
+            mbed_stress_test_http_finish(&http);
+        }
+
+        started = true;
+    }
+
+    TEST_ASSERT_FALSE_MESSAGE(mbed_stress_test_http_failed(&http), "malformed HTTP response");
+    TEST_ASSERT_MESSAGE((http.status == 200) || (http.status == 206), "unexpected HTTP status");
+    TEST_ASSERT_EQUAL_INT_MESSAGE(data_length, http.body_received, "response does not match requested range");
+
+    if (http.has_content_range) {
+        TEST_ASSERT_EQUAL_INT_MESSAGE(offset, http.range_first, "response for wrong range");
+    }
+
+    return http.keep_alive ? 1 : 0;
+}
+
+size_t mbed_stress_test_connection_download(mbed_stress_test_connection_t* connection, const char* filename, size_t offset, char* data, size_t data_length)
+{
+    return mbed_stress_test_connection_download_pipelined(connection, filename, offset, data, data_length, data_length, 1);
+}
+
+size_t mbed_stress_test_connection_download_pipelined(mbed_stress_test_connection_t* connection, const char* filename, size_t offset, char* data, size_t data_length, size_t chunk_size, uint32_t depth)
+{
+    TEST_ASSERT_MESSAGE((depth >= 1) && (depth <= MBED_STRESS_TEST_PIPELINE_DEPTH_MAX), "invalid pipeline depth");
+    TEST_ASSERT_MESSAGE(chunk_size > 0, "invalid chunk size");
+
+    Timer timer;
+    timer.start();
+
+    size_t requested_bytes = 0;
+    size_t received_bytes = 0;
+    uint32_t outstanding = 0;
+    int tries = 0;
+
+    while (received_bytes < data_length) {
+        if (connection->socket == NULL) {
+            connection->socket = mbed_stress_test_connect(connection->interface, connection->tls, NULL);
+            connection->socket->set_timeout(CONNECTION_TIMEOUT_MS);
+            connection->connections++;
+            connection->socket_requests = 0;
+        }
+
+        /* keep up to depth requests in flight */
+        while ((outstanding < depth) && (requested_bytes < data_length)) {
+            size_t length = data_length - requested_bytes;
+
+            if (length > chunk_size) {
+                length = chunk_size;
+            }
+
+            if (!mbed_stress_test_connection_send(connection, filename, offset + requested_bytes, length)) {
+                break;
+            }
+
+            requested_bytes += length;
+            outstanding++;
+        }
+
+        size_t length = data_length - received_bytes;
+
+        if (length > chunk_size) {
+            length = chunk_size;
+        }
+
+        int result = -1;
+
+        if (outstanding > 0) {
+            result = mbed_stress_test_connection_response(connection, offset + received_bytes, &data[received_bytes], length);
+        }
+
+        if (result < 0) {
+            /* only an idle connection may be closed under us */
+            TEST_ASSERT_MESSAGE(connection->socket_requests > 0, "failed to read HTTP response");
+            TEST_ASSERT_MESSAGE(++tries < MAX_RETRIES, "failed to reconnect");
+
+            printf("connection closed by server after %" PRIu32 " requests. reconnect\r\n", connection->socket_requests);
+        } else {
+            tries = 0;
+            received_bytes += length;
+            outstanding--;
+
+            connection->socket_requests++;
+            connection->requests++;
+            connection->bytes += length;
+        }
+
+        if (result <= 0) {
+            /* requests still in flight are lost with the connection */
+            mbed_stress_test_connection_disconnect(connection);
+            requested_bytes = received_bytes;
+            outstanding = 0;
+        }
+    }
+
+    timer.stop();
+    connection->elapsed_us += timer.elapsed_time().count();
+
+    return received_bytes;
+}
+
+void mbed_stress_test_connection_report(const mbed_stress_test_connection_t* connection)
+{
+    uint32_t connections = connection->connections ? connection->connections : 1;
+    uint32_t elapsed_ms = connection->elapsed_us / 1000;
+    uint32_t throughput = connection->elapsed_us ? (uint64_t) connection->bytes * 1000000 / connection->elapsed_us : 0;
+
+    printf("connections: %" PRIu32 " requests: %" PRIu32 " requests/connection: %" PRIu32 "\r\n",
+           connection->connections, connection->requests, connection->requests / connections);
+    printf("bytes: %" PRIu32 " time: %" PRIu32 " ms throughput: %" PRIu32 " bytes/s\r\n",
+           connection->bytes, elapsed_ms, throughput);
+}
+
+/*****************************************************************************/
+/* event queue multiplexer                                                   */
+/*****************************************************************************/
+
+#define MULTIPLEXER_TIMEOUT_MS 120000
+
+struct multiplexer;
+
+/* state of one download, all of them driven from the multiplexer's queue */
+typedef struct {
+    struct multiplexer* multiplexer;
+    Socket* socket;
+    mbed_stress_test_http_t http;
+    char request[BUFFER_SIZE];
+    size_t request_size;
+    size_t request_sent;
+    volatile uint32_t pending;
+    bool done;
+    uint64_t start_us;
+    uint64_t end_us;
+} multiplexer_connection_t;
+
+typedef struct multiplexer {
+    EventQueue* queue;
+    Timer timer;
+    char* buffer;
+    uint32_t remaining;
+} multiplexer_t;
+
+static void mbed_stress_test_multiplexer_process(multiplexer_connection_t* connection)
+{
+    multiplexer_t* multiplexer = connection->multiplexer;
+
+    /* clear first, so activity from here on schedules another run */
+    core_util_atomic_store_u32(&connection->pending, 0);
+
+    if (connection->done) {
+        return;
+    }
+
+    while (connection->request_sent < connection->request_size) {
+        int result = connection->socket->send(&connection->request[connection->request_sent],
+                                              connection->request_size - connection->request_sent);
+
+        if (result == NSAPI_ERROR_WOULD_BLOCK) {
+            return;
+        }
+
+        TEST_ASSERT_MESSAGE(result > 0, "failed to send HTTP request");
+        connection->request_sent += result;
+    }
+
+    /* the receive buffer is shared, only this thread touches it */
+    for (;;) {
+        int result = connection->socket->recv(multiplexer->buffer, BUFFER_SIZE);
+
+        if (result == NSAPI_ERROR_WOULD_BLOCK) {
+            return;
+        }
+
+        TEST_ASSERT_MESSAGE(result >= 0, "failed to read socket");
+
+        if (result == 0) {
+            mbed_stress_test_http_finish(&connection->http);
+        } else {
+            mbed_stress_test_http_parse(&connection->http, multiplexer->buffer, result);
+        }
+
+        TEST_ASSERT_FALSE_MESSAGE(mbed_stress_test_http_failed(&connection->http), "malformed HTTP response");
+
+        if (mbed_stress_test_http_done(&connection->http)) {
+            TEST_ASSERT_EQUAL_INT_MESSAGE(200, connection->http.status, "unexpected HTTP status");
+
+            connection->end_us = multiplexer->timer.elapsed_time().count();
+            connection->done = true;
+
+            connection->socket->sigio(nullptr);
+            delete connection->socket;
+            connection->socket = NULL;
+
+            if (--multiplexer->remaining == 0) {
+                multiplexer->queue->break_dispatch();
+            }
+            return;
+        }
+    }
+}
+
+/* called from the network stack, defers the work to the queue */
+static void mbed_stress_test_multiplexer_signal(multiplexer_connection_t* connection)
+{
+    uint32_t expected = 0;
+
+    if (core_util_atomic_cas_u32(&connection->pending, &expected, 1)) {
+        int id = connection->multiplexer->queue->call(mbed_stress_test_multiplexer_process, connection);
+        TEST_ASSERT_NOT_EQUAL_MESSAGE(0, id, "event queue full");
+    }
+}
+
+bool mbed_stress_test_multiplexer_download(NetworkInterface* interface, const char* filename, uint32_t connections, bool tls, mbed_stress_test_http_body_t body, void* context)
+{
+    TEST_ASSERT_MESSAGE((connections >= 1) && (connections <= MBED_STRESS_TEST_MULTIPLEXER_CONNECTIONS_MAX), "invalid number of connections");
+    TEST_ASSERT_MESSAGE(!tls || (connections <= MBED_STRESS_TEST_MULTIPLEXER_TLS_CONNECTIONS_MAX), "too many TLS connections");
+
+    /* at most one pending event per connection */
+    EventQueue queue(connections * EVENTS_EVENT_SIZE);
+
+    multiplexer_t multiplexer;
+    multiplexer.queue = &queue;
+    multiplexer.remaining = connections;
+    multiplexer.buffer = new char[BUFFER_SIZE];
+    TEST_ASSERT_NOT_NULL_MESSAGE(multiplexer.buffer, "failed to allocate receive buffer");
+
+    multiplexer_connection_t* state = new multiplexer_connection_t[connections];
+    TEST_ASSERT_NOT_NULL_MESSAGE(state, "failed to allocate connection state");
+
+    /* connect everything up front; from here on nothing blocks */
+    for (uint32_t index = 0; index < connections; index++) {
+        multiplexer_connection_t* connection = &state[index];
+
+        memset(connection, 0, sizeof(multiplexer_connection_t));
+        connection->multiplexer = &multiplexer;
+        connection->socket = mbed_stress_test_connect_or_null(interface, tls, NULL);
+
+        if (connection->socket == NULL) {
+            printf("connections: %" PRIu32 " skipped, out of sockets or memory after %" PRIu32 "\r\n", connections, index);
+
+            for (uint32_t opened = 0; opened < index; opened++) {
+                delete state[opened].socket;
+            }
+
+            delete[] state;
+            delete[] multiplexer.buffer;
+
+            return false;
+        }
+
+        connection->socket->set_blocking(false);
+
+        mbed_stress_test_http_init(&connection->http, body, context);
+
+        connection->request_size = snprintf(connection->request, BUFFER_SIZE, request_full_template, filename);
+        TEST_ASSERT_MESSAGE(connection->request_size < BUFFER_SIZE, "request buffer overflow");
+    }
+
+    multiplexer.timer.start();
+
+    for (uint32_t index = 0; index < connections; index++) {
+        multiplexer_connection_t* connection = &state[index];
+
+        connection->start_us = multiplexer.timer.elapsed_time().count();
+        connection->socket->sigio(callback(mbed_stress_test_multiplexer_signal, connection));
+
+        /* the first run sends the request */
+        mbed_stress_test_multiplexer_signal(connection);
+    }
+
+    queue.dispatch(MULTIPLEXER_TIMEOUT_MS);
+
+    multiplexer.timer.stop();
+    TEST_ASSERT_EQUAL_INT_MESSAGE(0, multiplexer.remaining, "downloads did not finish in time");
+
+    uint64_t total_bytes = 0;
+
+    for (uint32_t index = 0; index < connections; index++) {
+        multiplexer_connection_t* connection = &state[index];
+        uint64_t elapsed_us = connection->end_us - connection->start_us;
+
+        printf("connection %" PRIu32 ": bytes: %" PRIu32 " time: %" PRIu32 " ms throughput: %" PRIu32 " bytes/s\r\n",
+               index, connection->http.body_received, (uint32_t) (elapsed_us / 1000),
+               elapsed_us ? (uint32_t) (((uint64_t) connection->http.body_received * 1000000) / elapsed_us) : 0);
+
+        total_bytes += connection->http.body_received;
+    }
+
+    uint64_t elapsed_us = multiplexer.timer.elapsed_time().count();
+
+    printf("connections: %" PRIu32 " bytes: %" PRIu32 " time: %" PRIu32 " ms aggregate throughput: %" PRIu32 " bytes/s\r\n",
+           connections, (uint32_t) total_bytes, (uint32_t) (elapsed_us / 1000),
+           elapsed_us ? (uint32_t) ((total_bytes * 1000000) / elapsed_us) : 0);
+
+    delete[] state;
+    delete[] multiplexer.buffer;
+
+    return true;
+}
+
+/*****************************************************************************/
+/* segmented download                                                        */
+/*****************************************************************************/
+
+#define SEGMENTED_THREAD_STACK_SIZE (4 * 1024)
+
+/* the TLS handshake needs what the TLS thread tests give their threads */
+#ifdef MBED_CONF_APP_MAIN_STACK_SIZE
+#define SEGMENTED_TLS_THREAD_STACK_SIZE MBED_CONF_APP_MAIN_STACK_SIZE
+#else
+#define SEGMENTED_TLS_THREAD_STACK_SIZE (5 * 1024)
+#endif
+
+/* remaining part of one connection's share, [next, end) */
+typedef struct {
+    size_t next;
+    size_t end;
+    uint32_t bytes;
+    uint32_t steals;
+} segment_range_t;
+
+typedef struct {
+    Mutex mutex;
+    NetworkInterface* interface;
+    const char* filename;
+    bool tls;
+    size_t chunk_size;
+    mbed_stress_test_segment_sink_t sink;
+    void* context;
+    volatile uint32_t workers;
+    uint32_t connections;
+    segment_range_t ranges[MBED_STRESS_TEST_SEGMENTED_CONNECTIONS_MAX];
+} segmented_t;
+
+void mbed_stress_test_segment_buffer_sink(void* context, size_t offset, const char* data, size_t length)
+{
+    memcpy(&((char*) context)[offset], data, length);
+}
+
+/* Take the next chunk of this worker's range. Once the range is used up,
+ * split whichever range has the most left on a chunk boundary and take its
+ * back half. The owner keeps the front half and the chunk it is fetching,
+ * so a stalled connection still holds those until it recovers.
+ */
+static bool mbed_stress_test_segment_next(segmented_t* segmented, uint32_t id, size_t* offset, size_t* length)
+{
+    segmented->mutex.lock();
+
+    segment_range_t* range = &segmented->ranges[id];
+
+    if (range->next >= range->end) {
+        segment_range_t* victim = NULL;
+
+        for (uint32_t index = 0; index < segmented->connections; index++) {
+            segment_range_t* candidate = &segmented->ranges[index];
+
+            if ((victim == NULL) || ((candidate->end - candidate->next) > (victim->end - victim->next))) {
+                victim = candidate;
+            }
+        }
+
+        size_t remaining = victim->end - victim->next;
+
+        if (remaining > segmented->chunk_size) {
+            /* split on a chunk boundary, the victim keeps the front half */
+            size_t chunks = (remaining + segmented->chunk_size - 1) / segmented->chunk_size;
+            size_t middle = victim->next + ((chunks + 1) / 2) * segmented->chunk_size;
+
+            range->next = middle;
+            range->end = victim->end;
+            victim->end = middle;
+            range->steals++;
+        }
+    }
+
+    bool found = (range->next < range->end);
+
+    if (found) {
+        *offset = range->next;
+        *length = range->end - range->next;
+
+        if (*length > segmented->chunk_size) {
+            *length = segmented->chunk_size;
+        }
+
+        range->next += *length;
+    }
+
+    segmented->mutex.unlock();
+
+    return found;
+}
+
+static void mbed_stress_test_segment_worker(segmented_t* segmented)
+{
+    uint32_t id = core_util_atomic_incr_u32(&segmented->workers, 1) - 1;
+
+    char* buffer = new char[segmented->chunk_size];
+    TEST_ASSERT_NOT_NULL_MESSAGE(buffer, "failed to allocate chunk buffer");
+
+    mbed_stress_test_connection_t connection;
+    mbed_stress_test_connection_open(&connection, segmented->interface, segmented->tls);
+
+    size_t offset = 0;
+    size_t length = 0;
+
+    while (mbed_stress_test_segment_next(segmented, id, &offset, &length)) {
+        size_t received_bytes = mbed_stress_test_connection_download(&connection, segmented->filename, offset, buffer, length);
+        TEST_ASSERT_EQUAL_INT_MESSAGE(length, received_bytes, "received incorrect number of bytes");
+
+        segmented->sink(segmented->context, offset, buffer, length);
+        segmented->ranges[id].bytes += length;
+    }
+
+    printf("segment connection %" PRIu32 ": bytes: %" PRIu32 " requests: %" PRIu32 " steals: %" PRIu32 "\r\n",
+           id, segmented->ranges[id].bytes, connection.requests, segmented->ranges[id].steals);
+
+    mbed_stress_test_connection_close(&connection);
+    delete[] buffer;
+}
+
+uint32_t mbed_stress_test_segmented_download(NetworkInterface* interface, const char* filename, size_t file_length, uint32_t connections, bool tls, size_t chunk_size, mbed_stress_test_segment_sink_t sink, void* context)
+{
+    TEST_ASSERT_MESSAGE((connections >= 1) && (connections <= MBED_STRESS_TEST_SEGMENTED_CONNECTIONS_MAX), "invalid number of connections");
+    TEST_ASSERT_MESSAGE(chunk_size > 0, "invalid chunk size");
+
+    segmented_t* segmented = new segmented_t;
+    TEST_ASSERT_NOT_NULL_MESSAGE(segmented, "failed to allocate segmented download");
+
+    segmented->interface = interface;
+    segmented->filename = filename;
+    segmented->tls = tls;
+    segmented->chunk_size = chunk_size;
+    segmented->sink = sink;
+    segmented->context = context;
+    segmented->workers = 0;
+    segmented->connections = connections;
+
+    /* start with one contiguous, chunk aligned share per connection */
+    size_t chunks = (file_length + chunk_size - 1) / chunk_size;
+
+    for (uint32_t index = 0; index < connections; index++) {
+        segment_range_t* range = &segmented->ranges[index];
+
+        range->next = ((chunks * index) / connections) * chunk_size;
+        range->end = ((chunks * (index + 1)) / connections) * chunk_size;
+        range->bytes = 0;
+        range->steals = 0;
+
+        if (range->end > file_length) {
+            range->end = file_length;
+        }
+    }
+
+    Thread* threads[MBED_STRESS_TEST_SEGMENTED_CONNECTIONS_MAX];
+
+    Timer timer;
+    timer.start();
+
+    for (uint32_t index = 0; index < connections; index++) {
+        threads[index] = new Thread(osPriorityNormal, tls ? SEGMENTED_TLS_THREAD_STACK_SIZE : SEGMENTED_THREAD_STACK_SIZE);
+        TEST_ASSERT_NOT_NULL_MESSAGE(threads[index], "failed to allocate thread");
+
+        threads[index]->start(callback(mbed_stress_test_segment_worker, segmented));
+    }
+
+    uint32_t total_bytes = 0;
+
+    for (uint32_t index = 0; index < connections; index++) {
+        threads[index]->join();
+        delete threads[index];
+
+        total_bytes += segmented->ranges[index].bytes;
+    }
+
+    timer.stop();
+
+    uint32_t elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(timer.elapsed_time()).count();
+    uint64_t elapsed_us = timer.elapsed_time().count();
+
+    printf("segmented: connections: %" PRIu32 " bytes: %" PRIu32 " time: %" PRIu32 " ms throughput: %" PRIu32 " bytes/s\r\n",
+           connections, total_bytes, elapsed_ms, elapsed_us ? (uint32_t) (((uint64_t) total_bytes * 1000000) / elapsed_us) : 0);
+
+    TEST_ASSERT_EQUAL_INT_MESSAGE(file_length, total_bytes, "segments do not cover the file");
+
+    delete segmented;
+
+    return elapsed_ms;
 }
 
 #endif
@@ -14,4 +14,225 @@
  * limitations under the License.
  */
 
+#include "mbedtls/ssl.h"
+#include "mbedtls/x509_crt.h"
+#include "mbed_stress_test_http.h"
+
+/* how threads wait for socket activity */
+typedef enum {
+    MBED_STRESS_TEST_WAIT_EVENT,    /* block on EventFlags set from sigio */
+    MBED_STRESS_TEST_WAIT_SLEEP,    /* poll once per second */
+    MBED_STRESS_TEST_WAIT_YIELD     /* spin on ThisThread::yield */
+} mbed_stress_test_wait_mode_t;
+
+/* mode for sockets attached from now on, MBED_STRESS_TEST_WAIT_EVENT by default */
+extern mbed_stress_test_wait_mode_t mbed_stress_test_wait_mode;
+
+/* wakeup for one socket, signalled from its sigio callback */
+typedef struct {
+    EventFlags flags;
+    mbed_stress_test_wait_mode_t mode;
+    uint32_t wakeups;
+} mbed_stress_test_socket_event_t;
+
+void mbed_stress_test_socket_event_attach(mbed_stress_test_socket_event_t* event, Socket* socket);
+
+/* wait for socket activity since the last wait; returns false on timeout */
+bool mbed_stress_test_socket_event_wait(mbed_stress_test_socket_event_t* event, uint32_t timeout_ms);
+
+void mbed_stress_test_socket_event_detach(mbed_stress_test_socket_event_t* event, Socket* socket);
+
+const char* mbed_stress_test_wait_mode_name(mbed_stress_test_wait_mode_t mode);
+
+/* idle percentage between two mbed_stats_cpu_get samples, 0 without CPU stats */
+uint32_t mbed_stress_test_cpu_idle(const mbed_stats_cpu_t* before, const mbed_stats_cpu_t* after);
+
+/* run download once per mode; print time, throughput and CPU idle for each */
+void mbed_stress_test_compare_wait_modes(void (*download)(void), size_t bytes, const mbed_stress_test_wait_mode_t* modes, size_t modes_count);
+
+/* TLS session carried from one connection to the next */
+typedef struct {
+    mbedtls_ssl_session session;    /* last saved session, valid once saved is set */
+    bool saved;
+    bool tickets;                   /* resume with a session ticket, else by session ID */
+    uint32_t full;                  /* full handshakes */
+    uint32_t resumed;               /* abbreviated handshakes */
+} mbed_stress_test_tls_session_t;
+
+/* TLS connections made by the helpers resume this session when set, NULL for full handshakes */
+extern mbed_stress_test_tls_session_t* mbed_stress_test_tls_session;
+
+void mbed_stress_test_tls_session_init(mbed_stress_test_tls_session_t* session, bool tickets);
+void mbed_stress_test_tls_session_free(mbed_stress_test_tls_session_t* session);
+
+/* time handshakes full, resumed by session ID and by ticket; print latency
+ * and connections per minute. The ticket row prints as unsupported when
+ * Mbed TLS is built without MBEDTLS_SSL_SESSION_TICKETS.
+ */
+void mbed_stress_test_tls_benchmark(NetworkInterface* interface, uint32_t handshakes);
+
+/* Connect a TLS socket on transport, which the caller deletes after the
+ * returned socket. Handshakes on several threads overlap: only the first
+ * handshake step, where the socket seeds its own CTR_DRBG from the entropy
+ * pool, is serialized. mbedtls_hardware_poll is not thread safe on all targets.
+ */
+TLSSocketWrapper* mbed_stress_test_tls_connect(NetworkInterface* interface, TCPSocket* transport);
+
+#define MBED_STRESS_TEST_TLS_CA_CONNECTIONS_MAX 5
+
+/* root CA chain parsed once from SSL_CA_DER, shared read-only by every TLS socket */
+mbedtls_x509_crt* mbed_stress_test_tls_ca_chain(void);
+
+/* hold connections TLS sockets open with a PEM chain each, then with the
+ * shared chain; print heap and connect time per connection for both. The
+ * PEM row is skipped when the heap cannot hold that many chains.
+ */
+void mbed_stress_test_tls_ca_benchmark(NetworkInterface* interface, uint32_t connections);
+
+#ifndef MBED_CONF_APP_DOWNLOAD_DNS_TTL
+#define MBED_CONF_APP_DOWNLOAD_DNS_TTL 60
+#endif
+
+#define MBED_STRESS_TEST_DNS_CACHE_ENTRIES 4
+
+typedef struct {
+    uint32_t hits;      /* lookups answered from the cache */
+    uint32_t misses;    /* lookups that went to the network */
+} mbed_stress_test_dns_stats_t;
+
+/* on by default; when off every lookup goes to the network and counts as a miss */
+extern bool mbed_stress_test_dns_cache_enabled;
+
+/* gethostbyname through a cache shared by all threads. NetworkInterface
+ * does not expose the record TTL, so entries live for
+ * MBED_CONF_APP_DOWNLOAD_DNS_TTL seconds.
+ */
+nsapi_error_t mbed_stress_test_gethostbyname(NetworkInterface* interface, const char* host, SocketAddress* address);
+
+void mbed_stress_test_dns_cache_stats(mbed_stress_test_dns_stats_t* stats);
+
+/* drop all entries and zero the counters */
+void mbed_stress_test_dns_cache_clear(void);
+
+/* phases of one download, back to back */
+typedef enum {
+    MBED_STRESS_TEST_PHASE_DNS,
+    MBED_STRESS_TEST_PHASE_CONNECT,     /* TCP connect */
+    MBED_STRESS_TEST_PHASE_HANDSHAKE,   /* TLS handshake, 0 without TLS */
+    MBED_STRESS_TEST_PHASE_FIRST_BYTE,  /* until the first response byte */
+    MBED_STRESS_TEST_PHASE_TRANSFER,    /* from the first to the last response byte */
+    MBED_STRESS_TEST_PHASES
+} mbed_stress_test_phase_t;
+
+typedef struct {
+    Timer timer;
+    uint32_t mark_us;
+    uint32_t us[MBED_STRESS_TEST_PHASES];
+} mbed_stress_test_phase_timing_t;
+
+void mbed_stress_test_phase_start(mbed_stress_test_phase_timing_t* timing);
+
+/* add the time since the previous mark to phase; no-op when timing is NULL */
+void mbed_stress_test_phase_mark(mbed_stress_test_phase_timing_t* timing, mbed_stress_test_phase_t phase);
+
+const char* mbed_stress_test_phase_name(mbed_stress_test_phase_t phase);
+
+#define MBED_STRESS_TEST_PHASE_RUNS_MAX 32
+
+/* phase timings of repeated runs, the oldest are dropped past MBED_STRESS_TEST_PHASE_RUNS_MAX */
+typedef struct {
+    uint32_t runs;
+    uint32_t us[MBED_STRESS_TEST_PHASES][MBED_STRESS_TEST_PHASE_RUNS_MAX];
+} mbed_stress_test_phase_stats_t;
+
+void mbed_stress_test_phase_stats_init(mbed_stress_test_phase_stats_t* stats);
+void mbed_stress_test_phase_stats_add(mbed_stress_test_phase_stats_t* stats, const mbed_stress_test_phase_timing_t* timing);
+
+/* time of phase that percent of the runs stay within, 0 without runs */
+uint32_t mbed_stress_test_phase_stats_percentile(const mbed_stress_test_phase_stats_t* stats, mbed_stress_test_phase_t phase, uint32_t percent);
+
+/* print min, median and p99 per phase and send them as greentea key-value
+ * records, e.g. {{handshake_median_us;51230}}
+ */
+void mbed_stress_test_phase_stats_report(const mbed_stress_test_phase_stats_t* stats);
+
 size_t mbed_stress_test_download(NetworkInterface* interface, const char* filename, size_t offset, char* data, size_t data_length, bool tls);
+
+/* mbed_stress_test_download, also filling in the time spent in each phase */
+size_t mbed_stress_test_download_timed(NetworkInterface* interface, const char* filename, size_t offset, char* data, size_t data_length, bool tls, mbed_stress_test_phase_timing_t* timing);
+
+/* GET the whole file and hand the body to body in order, without buffering
+ * it, so the file may be larger than RAM and flash. Returns the body length.
+ */
+size_t mbed_stress_test_download_stream(NetworkInterface* interface, const char* filename, bool tls, mbed_stress_test_http_body_t body, void* context);
+
+/* mbed_stress_test_http_body_t that checks the body against the generated
+ * stream; context points to the uint32_t seed
+ */
+void mbed_stress_test_generated_body(void* context, size_t offset, const char* data, size_t length);
+
+#define MBED_STRESS_TEST_PIPELINE_DEPTH_MAX 8
+
+/* keep-alive connection, reused for successive range requests */
+typedef struct {
+    NetworkInterface* interface;
+    Socket* socket;
+    bool tls;
+    char* buffer;               /* bytes received but not yet parsed */
+    size_t buffer_length;
+    uint32_t connections;       /* connections opened */
+    uint32_t socket_requests;   /* requests on the current connection */
+    uint32_t requests;          /* requests in total */
+    uint32_t bytes;             /* body bytes in total */
+    uint64_t elapsed_us;        /* time spent in mbed_stress_test_connection_download */
+} mbed_stress_test_connection_t;
+
+void mbed_stress_test_connection_open(mbed_stress_test_connection_t* connection, NetworkInterface* interface, bool tls);
+
+size_t mbed_stress_test_connection_download(mbed_stress_test_connection_t* connection, const char* filename, size_t offset, char* data, size_t data_length);
+
+/* download data_length bytes as chunk_size range requests, with up to depth of them in flight */
+size_t mbed_stress_test_connection_download_pipelined(mbed_stress_test_connection_t* connection, const char* filename, size_t offset, char* data, size_t data_length, size_t chunk_size, uint32_t depth);
+
+void mbed_stress_test_connection_report(const mbed_stress_test_connection_t* connection);
+
+void mbed_stress_test_connection_close(mbed_stress_test_connection_t* connection);
+
+/* as many connections as lwIP has TCP sockets, unless mbed_app.json sets a limit */
+#ifndef MBED_CONF_APP_DOWNLOAD_CONNECTIONS_MAX
+#if defined(MBED_CONF_LWIP_TCP_SOCKET_MAX)
+#define MBED_CONF_APP_DOWNLOAD_CONNECTIONS_MAX MBED_CONF_LWIP_TCP_SOCKET_MAX
+#else
+#define MBED_CONF_APP_DOWNLOAD_CONNECTIONS_MAX 8
+#endif
+#endif
+
+#define MBED_STRESS_TEST_MULTIPLEXER_CONNECTIONS_MAX MBED_CONF_APP_DOWNLOAD_CONNECTIONS_MAX
+
+/* each TLS connection holds its own mbedTLS context, tens of KB of heap */
+#ifndef MBED_CONF_APP_DOWNLOAD_TLS_CONNECTIONS_MAX
+#define MBED_CONF_APP_DOWNLOAD_TLS_CONNECTIONS_MAX 2
+#endif
+
+#define MBED_STRESS_TEST_MULTIPLEXER_TLS_CONNECTIONS_MAX MBED_CONF_APP_DOWNLOAD_TLS_CONNECTIONS_MAX
+
+/* download the whole file over several sockets at once, all driven by one
+ * EventQueue on the calling thread. Returns false, after printing how many
+ * connections opened, when the stack runs out of sockets or heap first.
+ */
+bool mbed_stress_test_multiplexer_download(NetworkInterface* interface, const char* filename, uint32_t connections, bool tls, mbed_stress_test_http_body_t body, void* context);
+
+#define MBED_STRESS_TEST_SEGMENTED_CONNECTIONS_MAX 8
+
+/* receives every byte range of a segmented download exactly once, from the download threads */
+typedef void (*mbed_stress_test_segment_sink_t)(void* context, size_t offset, const char* data, size_t length);
+
+/* sink that reassembles into the buffer passed as context */
+void mbed_stress_test_segment_buffer_sink(void* context, size_t offset, const char* data, size_t length);
+
+/* Download file_length bytes as chunk_size ranges over parallel keep-alive
+ * connections, one thread each. An idle connection splits the largest
+ * remaining share and takes its back half; the owner keeps the front half.
+ * Returns the wall clock time in milliseconds.
+ */
+uint32_t mbed_stress_test_segmented_download(NetworkInterface* interface, const char* filename, size_t file_length, uint32_t connections, bool tls, size_t chunk_size, mbed_stress_test_segment_sink_t sink, void* context);
@@ -0,0 +1,111 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2016 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "mbed.h"
+#include "unity/unity.h"
+#include "mbed_stress_test_verify.h"
+
+/* CRC-32 (IEEE 802.3, reflected), half a byte at a time to keep the table small */
+static const uint32_t crc32_table[16] = {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+};
+
+static uint32_t crc32_update(uint32_t crc, const unsigned char* data, size_t length)
+{
+    for (size_t index = 0; index < length; index++) {
+        crc ^= data[index];
+        crc = (crc >> 4) ^ crc32_table[crc & 0x0F];
+        crc = (crc >> 4) ^ crc32_table[crc & 0x0F];
+    }
+
+    return crc;
+}
+
+void mbed_stress_test_verify_init(mbed_stress_test_verify_t* verify, mbed_stress_test_verify_mode_t mode)
+{
+    verify->mode = mode;
+    verify->crc32 = 0xFFFFFFFF;
+    verify->length = 0;
+
+    mbedtls_sha256_init(&verify->sha256);
+
+    if (mode == MBED_STRESS_TEST_VERIFY_SHA256) {
+        int result = mbedtls_sha256_starts_ret(&verify->sha256, 0);
+        TEST_ASSERT_EQUAL_INT_MESSAGE(0, result, "failed to start SHA-256");
+    }
+}
+
+void mbed_stress_test_verify_update(mbed_stress_test_verify_t* verify, const void* data, size_t length)
+{
+    if (verify->mode == MBED_STRESS_TEST_VERIFY_SHA256) {
+        int result = mbedtls_sha256_update_ret(&verify->sha256, (const unsigned char*) data, length);
+        TEST_ASSERT_EQUAL_INT_MESSAGE(0, result, "failed to update SHA-256");
+    } else {
+        verify->crc32 = crc32_update(verify->crc32, (const unsigned char*) data, length);
+    }
+
+    verify->length += length;
+}
+
+void mbed_stress_test_verify_finish(mbed_stress_test_verify_t* verify, const mbed_stress_test_digest_t* expected)
+{
+    TEST_ASSERT_EQUAL_INT_MESSAGE(expected->length, verify->length, "received incorrect number of bytes");
+
+    if (verify->mode == MBED_STRESS_TEST_VERIFY_SHA256) {
+        unsigned char sha256[MBED_STRESS_TEST_SHA256_SIZE];
+
+        int result = mbedtls_sha256_finish_ret(&verify->sha256, sha256);
+        TEST_ASSERT_EQUAL_INT_MESSAGE(0, result, "failed to finish SHA-256");
+
+        if (memcmp(expected->sha256, sha256, MBED_STRESS_TEST_SHA256_SIZE) != 0) {
+            printf("SHA-256 of %s: ", expected->name);
+
+            for (size_t index = 0; index < MBED_STRESS_TEST_SHA256_SIZE; index++) {
+                printf("%02x", sha256[index]);
+            }
+
+            printf("\r\n");
+            TEST_FAIL_MESSAGE("SHA-256 mismatch");
+        }
+    } else {
+        TEST_ASSERT_EQUAL_UINT32_MESSAGE(expected->crc32, verify->crc32 ^ 0xFFFFFFFF, "CRC-32 mismatch");
+    }
+
+    mbedtls_sha256_free(&verify->sha256);
+}
+
+void mbed_stress_test_verify_body(void* context, size_t offset, const char* data, size_t length)
+{
+    mbed_stress_test_verify_t* verify = (mbed_stress_test_verify_t*) context;
+
+    /* a running digest only works on bytes in order */
+    TEST_ASSERT_EQUAL_INT_MESSAGE(verify->length, offset, "body out of order");
+
+    mbed_stress_test_verify_update(verify, data, length);
+}
+
+const char* mbed_stress_test_verify_mode_name(mbed_stress_test_verify_mode_t mode)
+{
+    switch (mode) {
+        case MBED_STRESS_TEST_VERIFY_SHA256:
+            return "SHA-256";
+        case MBED_STRESS_TEST_VERIFY_CRC32:
+            return "CRC-32";
+        default:
+            return "unknown";
+    }
+}
@@ -0,0 +1,57 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2016 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MBED_STRESS_TEST_VERIFY_H
+#define MBED_STRESS_TEST_VERIFY_H
+
+#include "mbedtls/sha256.h"
+
+#define MBED_STRESS_TEST_SHA256_SIZE 32
+
+/* expected length and digests of a dataset, see elizabeth_digest.h */
+typedef struct {
+    const char* name;
+    size_t length;
+    unsigned char sha256[MBED_STRESS_TEST_SHA256_SIZE];
+    uint32_t crc32;
+} mbed_stress_test_digest_t;
+
+typedef enum {
+    MBED_STRESS_TEST_VERIFY_SHA256,
+    MBED_STRESS_TEST_VERIFY_CRC32   /* cheaper, catches corruption but not tampering */
+} mbed_stress_test_verify_mode_t;
+
+/* running digest of bytes that arrive in order */
+typedef struct {
+    mbed_stress_test_verify_mode_t mode;
+    mbedtls_sha256_context sha256;
+    uint32_t crc32;
+    size_t length;
+} mbed_stress_test_verify_t;
+
+void mbed_stress_test_verify_init(mbed_stress_test_verify_t* verify, mbed_stress_test_verify_mode_t mode);
+
+void mbed_stress_test_verify_update(mbed_stress_test_verify_t* verify, const void* data, size_t length);
+
+/* assert length and digest match expected, then release the context */
+void mbed_stress_test_verify_finish(mbed_stress_test_verify_t* verify, const mbed_stress_test_digest_t* expected);
+
+/* mbed_stress_test_http_body_t that feeds a mbed_stress_test_verify_t passed as context */
+void mbed_stress_test_verify_body(void* context, size_t offset, const char* data, size_t length);
+
+const char* mbed_stress_test_verify_mode_name(mbed_stress_test_verify_mode_t mode);
+
+#endif